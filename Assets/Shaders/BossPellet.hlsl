@@ -1,3 +1,11 @@
+// Provided by the framework.
+cbuffer FrameConstantData : register(b0)
+{
+	float4x4 viewMtx;
+	float4x4 projectionMtx;
+	float4x4 viewProjectionMtx;
+};
+
 // Provided by the framework.
 cbuffer DrawConstantData : register(b1)
 {
@@ -6,6 +14,14 @@ cbuffer DrawConstantData : register(b1)
 	float4x4 normalMtx;
 };
 
+// Provided by the framework for instanced draws, one entry per instance.
+struct InstanceData
+{
+	float4x4 worldMtx;
+	float4x4 normalMtx;
+};
+StructuredBuffer<InstanceData> g_instances : register(t4);
+
 struct VSInput
 {
 	float3 position : POSITION;
@@ -31,6 +47,17 @@ PSInput VS_Main(VSInput input)
 	return output;
 }
 
+PSInput VS_MainInstanced(VSInput input, uint instanceId : SV_InstanceID)
+{
+	PSInput output;
+
+	InstanceData instance = g_instances[instanceId];
+	output.position = mul(viewProjectionMtx, mul(instance.worldMtx, float4(input.position.xyz, 1.0f)));
+	output.normal = mul(instance.normalMtx, float4(input.normal.xyz, 0.0f));
+
+	return output;
+}
+
 float4 PS_Main(PSInput input) : SV_TARGET
 {
 	return float4(1.0, 0.2, 0.2, input.position.z);
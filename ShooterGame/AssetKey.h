@@ -0,0 +1,77 @@
+#pragma once
+#include "Play3d.h"
+
+// What a GameObjectManager registry entry holds. It is part of the key, so one file can back several kinds of entry.
+enum AssetKind : Play3d::u8
+{
+	ASSET_MESH,
+	ASSET_SOUND,
+	ASSET_MATERIAL,
+	ASSET_MATERIAL_HLSL,
+};
+
+// A path to an asset and its 64-bit FNV-1a hash, taken after normalising the path the way Play3d::Resources names are:
+// case is folded and '\' reads as '/', so every spelling of a file hashes the same. Declaring one constexpr hashes the literal at compile time, otherwise
+// the path is hashed once where the AssetPath is made.
+struct AssetPath
+{
+	constexpr AssetPath(const char* pPath) : path(pPath), hash(Hash(FNV_OFFSET, pPath)) {}
+
+	bool IsEmpty() const { return path[0] == '\0'; }
+
+	static constexpr Play3d::u64 FNV_OFFSET{ 0xCBF29CE484222325ull };
+	static constexpr Play3d::u64 FNV_PRIME{ 0x100000001B3ull };
+
+	static constexpr char Normalise(char c)
+	{
+		return Play3d::Resources::NormaliseNameChar(c);
+	}
+
+	static constexpr Play3d::u64 Hash(Play3d::u64 hash, const char* s)
+	{
+		for (; *s != '\0'; s++)
+		{
+			hash = (hash ^ (Play3d::u8)Normalise(*s)) * FNV_PRIME;
+		}
+		return hash;
+	}
+
+	static constexpr bool IsSamePath(const char* a, const char* b)
+	{
+		for (; *a != '\0' && Normalise(*a) == Normalise(*b); a++, b++)
+		{
+		}
+		return Normalise(*a) == Normalise(*b);
+	}
+
+	const char* path;
+	Play3d::u64 hash;
+};
+
+// Registry key for one kind of entry made from a path, plus an optional variant path such as a material's texture
+class AssetKey
+{
+public:
+	constexpr AssetKey(AssetKind kind, const AssetPath& path, const AssetPath& variant = AssetPath(""))
+		: m_value(Mix(Mix(path.hash, kind), variant.hash))
+	{
+	}
+
+	constexpr Play3d::u64 GetValue() const { return m_value; }
+
+private:
+	// Carries on the FNV-1a hash one byte at a time
+	static constexpr Play3d::u64 Mix(Play3d::u64 hash, Play3d::u64 value)
+	{
+		for (int i = 0; i < 8; i++, value >>= 8)
+		{
+			hash = (hash ^ (value & 0xFF)) * AssetPath::FNV_PRIME;
+		}
+		return hash;
+	}
+
+	Play3d::u64 m_value;
+};
+
+static_assert(AssetPath("..\\Assets\\Models\\Pellet.obj").hash == AssetPath("../assets/models/pellet.obj").hash,
+	"AssetPath must hash every spelling of a path the same");
@@ -1,5 +1,6 @@
 #include "AttackPatternBase.h"
 #include "Play3d.h"
+#include "UtilityFunctions.h"
 
 void AttackPatternBase::Update(ObjectBoss* pBoss)
 {
@@ -30,7 +31,7 @@ void AttackPatternBase::Update(ObjectBoss* pBoss)
 		}
 	}
 
-	m_timer += Play3d::System::GetDeltaTime();
+	m_timer += GetSimDeltaTime();
 }
 
 void AttackPatternBase::RegisterAttack(AttackPointer attack, float delaySincePrev)
@@ -0,0 +1,100 @@
+#include "CollisionGrid.h"
+#include <cmath>
+
+using namespace Play3d;
+
+void CollisionGrid::Build(const std::vector<CollisionBounds>& bounds, float halfWidth, float halfHeight, float cellSize)
+{
+	PLAY_ASSERT(cellSize > 0.f);
+	m_originX = -halfWidth;
+	m_originY = -halfHeight;
+	m_invCellSize = 1.f / cellSize;
+	m_cellsX = std::max(1, (int)std::ceil((halfWidth * 2.f) * m_invCellSize));
+	m_cellsY = std::max(1, (int)std::ceil((halfHeight * 2.f) * m_invCellSize));
+
+	// Pass 1: count how many items land in each cell (objects can span several cells)
+	m_cellStart.assign((size_t)(m_cellsX * m_cellsY) + 1, 0);
+	for (size_t i = 0; i < bounds.size(); i++)
+	{
+		if (bounds[i].IsEmpty())
+			continue;
+
+		int x0, y0, x1, y1;
+		GetCellRange(bounds[i], x0, y0, x1, y1);
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
+			{
+				m_cellStart[(y * m_cellsX) + x + 1]++;
+			}
+		}
+	}
+
+	// Pass 2: prefix sum turns counts into each cell's first slot
+	for (size_t c = 1; c < m_cellStart.size(); c++)
+	{
+		m_cellStart[c] += m_cellStart[c - 1];
+	}
+	m_cellItems.resize(m_cellStart.back());
+
+	// Pass 3: scatter indices, using the cell start as a moving cursor then shifting it back afterwards
+	for (size_t i = 0; i < bounds.size(); i++)
+	{
+		if (bounds[i].IsEmpty())
+			continue;
+
+		int x0, y0, x1, y1;
+		GetCellRange(bounds[i], x0, y0, x1, y1);
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
+			{
+				m_cellItems[m_cellStart[(y * m_cellsX) + x]++] = (u32)i;
+			}
+		}
+	}
+	for (size_t c = m_cellStart.size() - 1; c > 0; c--)
+	{
+		m_cellStart[c] = m_cellStart[c - 1];
+	}
+	m_cellStart[0] = 0;
+
+	m_queryStamp.assign(bounds.size(), 0);
+	m_queryId = 0;
+}
+
+void CollisionGrid::Query(const CollisionBounds& bounds, std::vector<u32>& results)
+{
+	if (bounds.IsEmpty() || m_cellStart.empty())
+		return;
+
+	m_queryId++;
+
+	int x0, y0, x1, y1;
+	GetCellRange(bounds, x0, y0, x1, y1);
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			int cell = (y * m_cellsX) + x;
+			for (u32 c = m_cellStart[cell]; c < m_cellStart[cell + 1]; c++)
+			{
+				u32 item = m_cellItems[c];
+				if (m_queryStamp[item] != m_queryId)
+				{
+					m_queryStamp[item] = m_queryId;
+					results.push_back(item);
+				}
+			}
+		}
+	}
+}
+
+void CollisionGrid::GetCellRange(const CollisionBounds& bounds, int& x0, int& y0, int& x1, int& y1) const
+{
+	// Clamping is monotonic, so two overlapping boxes always share at least one cell even when off-screen
+	x0 = std::clamp((int)std::floor((bounds.minX - m_originX) * m_invCellSize), 0, m_cellsX - 1);
+	y0 = std::clamp((int)std::floor((bounds.minY - m_originY) * m_invCellSize), 0, m_cellsY - 1);
+	x1 = std::clamp((int)std::floor((bounds.maxX - m_originX) * m_invCellSize), 0, m_cellsX - 1);
+	y1 = std::clamp((int)std::floor((bounds.maxY - m_originY) * m_invCellSize), 0, m_cellsY - 1);
+}
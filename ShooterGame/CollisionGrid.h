@@ -0,0 +1,39 @@
+#pragma once
+#include "Play3d.h"
+
+// World-space axis aligned box enclosing all of an object's colliders
+struct CollisionBounds
+{
+	float minX{0.f};
+	float minY{0.f};
+	float maxX{-1.f}; // default is inverted (empty) so unset bounds never land in the grid
+	float maxY{-1.f};
+
+	bool IsEmpty() const { return minX > maxX || minY > maxY; }
+};
+
+// Uniform grid broadphase covering the orthographic play area. Rebuilt from scratch every frame with a counting
+// sort, so there is no per-object bookkeeping and no allocation once the buffers have grown to the working set.
+// Anything outside the play area is clamped into the border cells rather than dropped.
+class CollisionGrid
+{
+public:
+	void Build(const std::vector<CollisionBounds>& bounds, float halfWidth, float halfHeight, float cellSize);
+
+	// Appends the index of every built object whose cells overlap the given bounds, each index only once
+	void Query(const CollisionBounds& bounds, std::vector<Play3d::u32>& results);
+
+private:
+	void GetCellRange(const CollisionBounds& bounds, int& x0, int& y0, int& x1, int& y1) const;
+
+	std::vector<Play3d::u32> m_cellStart; // prefix sum of item counts, one entry per cell plus a terminator
+	std::vector<Play3d::u32> m_cellItems; // object indices ordered by cell
+	std::vector<Play3d::u32> m_queryStamp; // per object, id of the last query which reported it
+	Play3d::u32 m_queryId{0};
+
+	float m_originX{0.f};
+	float m_originY{0.f};
+	float m_invCellSize{1.f};
+	int m_cellsX{0};
+	int m_cellsY{0};
+};
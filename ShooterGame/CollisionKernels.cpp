@@ -0,0 +1,258 @@
+#include "CollisionKernels.h"
+#include <cmath>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace Play3d;
+
+// MSVC accepts AVX intrinsics in any function, GCC/Clang need the target enabled per function
+#if defined(_MSC_VER)
+#define KERNEL_TARGET_AVX2
+#else
+#define KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace CollisionKernels
+{
+	static Isa DetectIsa()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			bool avx2 = (info[1] & (1 << 5)) != 0;
+			__cpuid(info, 1);
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			// The OS must also save the upper halves of the ymm registers
+			if (avx2 && osxsave && (_xgetbv(0) & 0x6) == 0x6)
+				return Isa::AVX2;
+		}
+		return Isa::SSE; // baseline on x64
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return Isa::AVX2;
+		return __builtin_cpu_supports("sse2") ? Isa::SSE : Isa::SCALAR;
+#endif
+	}
+
+	static Isa s_bestIsa{ DetectIsa() };
+	static Isa s_isa{ s_bestIsa };
+
+	Isa GetBestIsa()
+	{
+		return s_bestIsa;
+	}
+
+	Isa GetIsa()
+	{
+		return s_isa;
+	}
+
+	void SetIsa(Isa isa)
+	{
+		s_isa = (isa > s_bestIsa) ? s_bestIsa : isa;
+	}
+
+	const char* GetIsaName(Isa isa)
+	{
+		switch (isa)
+		{
+		case Isa::SCALAR: return "Scalar";
+		case Isa::SSE: return "SSE";
+		case Isa::AVX2: return "AVX2";
+		default: return "Unknown";
+		}
+	}
+
+	// Scalar versions, used directly and for the tails of the vector loops
+	static void CircleVsCirclesScalar(float centreX, float centreY, float radii, const float* posX, const float* posY, size_t begin, size_t end, u64* pHitMask)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			float xDiff = posX[i] - centreX;
+			float yDiff = posY[i] - centreY;
+			if ((xDiff * xDiff) + (yDiff * yDiff) < radii * radii)
+			{
+				pHitMask[i / 64] |= 1ull << (i % 64);
+			}
+		}
+	}
+
+	static void RectVsCirclesScalar(float centreX, float centreY, float centreZ, float extentX, float extentY, const float* posX, const float* posY, float radius, size_t begin, size_t end, u64* pHitMask)
+	{
+		const float maxX = centreX + extentX;
+		const float minX = centreX - extentX;
+		const float maxY = centreY + extentY;
+		const float minY = centreY - extentY;
+		for (size_t i = begin; i < end; i++)
+		{
+			float vecX = centreX - posX[i];
+			float vecY = centreY - posY[i];
+			float distance = std::sqrt((vecX * vecX) + (vecY * vecY) + (centreZ * centreZ));
+
+			bool hit = distance < radius;
+			if (!hit)
+			{
+				float invDistance = 1.f / distance;
+				float testX = posX[i] + ((vecX * invDistance) * radius);
+				float testY = posY[i] + ((vecY * invDistance) * radius);
+				hit = testX < maxX && testX > minX && testY < maxY && testY > minY;
+			}
+
+			if (hit)
+			{
+				pHitMask[i / 64] |= 1ull << (i % 64);
+			}
+		}
+	}
+
+	static size_t CircleVsCirclesSSE(float centreX, float centreY, float radii, const float* posX, const float* posY, size_t count, u64* pHitMask)
+	{
+		const __m128 cx = _mm_set1_ps(centreX);
+		const __m128 cy = _mm_set1_ps(centreY);
+		const __m128 radiiSq = _mm_set1_ps(radii * radii);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 xDiff = _mm_sub_ps(_mm_loadu_ps(posX + i), cx);
+			__m128 yDiff = _mm_sub_ps(_mm_loadu_ps(posY + i), cy);
+			__m128 distSq = _mm_add_ps(_mm_mul_ps(xDiff, xDiff), _mm_mul_ps(yDiff, yDiff));
+			u64 bits = (u64)_mm_movemask_ps(_mm_cmplt_ps(distSq, radiiSq));
+			pHitMask[i / 64] |= bits << (i % 64);
+		}
+		return i;
+	}
+
+	static size_t RectVsCirclesSSE(float centreX, float centreY, float centreZ, float extentX, float extentY, const float* posX, const float* posY, float radius, size_t count, u64* pHitMask)
+	{
+		const __m128 cx = _mm_set1_ps(centreX);
+		const __m128 cy = _mm_set1_ps(centreY);
+		const __m128 czSq = _mm_set1_ps(centreZ * centreZ);
+		const __m128 maxX = _mm_set1_ps(centreX + extentX);
+		const __m128 minX = _mm_set1_ps(centreX - extentX);
+		const __m128 maxY = _mm_set1_ps(centreY + extentY);
+		const __m128 minY = _mm_set1_ps(centreY - extentY);
+		const __m128 r = _mm_set1_ps(radius);
+		const __m128 one = _mm_set1_ps(1.f);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 px = _mm_loadu_ps(posX + i);
+			__m128 py = _mm_loadu_ps(posY + i);
+			__m128 vecX = _mm_sub_ps(cx, px);
+			__m128 vecY = _mm_sub_ps(cy, py);
+			__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vecX, vecX), _mm_mul_ps(vecY, vecY)), czSq));
+
+			// Lanes where distance is zero divide by zero here, but those are already hits from the first test
+			__m128 invDistance = _mm_div_ps(one, distance);
+			__m128 testX = _mm_add_ps(px, _mm_mul_ps(_mm_mul_ps(vecX, invDistance), r));
+			__m128 testY = _mm_add_ps(py, _mm_mul_ps(_mm_mul_ps(vecY, invDistance), r));
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(testX, maxX), _mm_cmpgt_ps(testX, minX)),
+									   _mm_and_ps(_mm_cmplt_ps(testY, maxY), _mm_cmpgt_ps(testY, minY)));
+			__m128 hit = _mm_or_ps(_mm_cmplt_ps(distance, r), inside);
+
+			u64 bits = (u64)_mm_movemask_ps(hit);
+			pHitMask[i / 64] |= bits << (i % 64);
+		}
+		return i;
+	}
+
+	KERNEL_TARGET_AVX2 static size_t CircleVsCirclesAVX2(float centreX, float centreY, float radii, const float* posX, const float* posY, size_t count, u64* pHitMask)
+	{
+		const __m256 cx = _mm256_set1_ps(centreX);
+		const __m256 cy = _mm256_set1_ps(centreY);
+		const __m256 radiiSq = _mm256_set1_ps(radii * radii);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 xDiff = _mm256_sub_ps(_mm256_loadu_ps(posX + i), cx);
+			__m256 yDiff = _mm256_sub_ps(_mm256_loadu_ps(posY + i), cy);
+			__m256 distSq = _mm256_add_ps(_mm256_mul_ps(xDiff, xDiff), _mm256_mul_ps(yDiff, yDiff));
+			u64 bits = (u64)_mm256_movemask_ps(_mm256_cmp_ps(distSq, radiiSq, _CMP_LT_OQ));
+			pHitMask[i / 64] |= bits << (i % 64);
+		}
+		return i;
+	}
+
+	KERNEL_TARGET_AVX2 static size_t RectVsCirclesAVX2(float centreX, float centreY, float centreZ, float extentX, float extentY, const float* posX, const float* posY, float radius, size_t count, u64* pHitMask)
+	{
+		const __m256 cx = _mm256_set1_ps(centreX);
+		const __m256 cy = _mm256_set1_ps(centreY);
+		const __m256 czSq = _mm256_set1_ps(centreZ * centreZ);
+		const __m256 maxX = _mm256_set1_ps(centreX + extentX);
+		const __m256 minX = _mm256_set1_ps(centreX - extentX);
+		const __m256 maxY = _mm256_set1_ps(centreY + extentY);
+		const __m256 minY = _mm256_set1_ps(centreY - extentY);
+		const __m256 r = _mm256_set1_ps(radius);
+		const __m256 one = _mm256_set1_ps(1.f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 px = _mm256_loadu_ps(posX + i);
+			__m256 py = _mm256_loadu_ps(posY + i);
+			__m256 vecX = _mm256_sub_ps(cx, px);
+			__m256 vecY = _mm256_sub_ps(cy, py);
+			__m256 distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vecX, vecX), _mm256_mul_ps(vecY, vecY)), czSq));
+
+			__m256 invDistance = _mm256_div_ps(one, distance);
+			__m256 testX = _mm256_add_ps(px, _mm256_mul_ps(_mm256_mul_ps(vecX, invDistance), r));
+			__m256 testY = _mm256_add_ps(py, _mm256_mul_ps(_mm256_mul_ps(vecY, invDistance), r));
+			__m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(testX, maxX, _CMP_LT_OQ), _mm256_cmp_ps(testX, minX, _CMP_GT_OQ)),
+										  _mm256_and_ps(_mm256_cmp_ps(testY, maxY, _CMP_LT_OQ), _mm256_cmp_ps(testY, minY, _CMP_GT_OQ)));
+			__m256 hit = _mm256_or_ps(_mm256_cmp_ps(distance, r, _CMP_LT_OQ), inside);
+
+			u64 bits = (u64)_mm256_movemask_ps(hit);
+			pHitMask[i / 64] |= bits << (i % 64);
+		}
+		return i;
+	}
+
+	void CircleVsCircles(float centreX, float centreY, float radius, const float* posX, const float* posY, float candidateRadius, size_t count, u64* pHitMask)
+	{
+		std::fill(pHitMask, pHitMask + GetHitMaskWords(count), 0ull);
+
+		// Summed once up front rather than per pair, the result is the same
+		const float radii = candidateRadius + radius;
+		size_t done = 0;
+		switch (s_isa)
+		{
+		case Isa::AVX2:
+			done = CircleVsCirclesAVX2(centreX, centreY, radii, posX, posY, count, pHitMask);
+			break;
+		case Isa::SSE:
+			done = CircleVsCirclesSSE(centreX, centreY, radii, posX, posY, count, pHitMask);
+			break;
+		default:
+			break;
+		}
+		CircleVsCirclesScalar(centreX, centreY, radii, posX, posY, done, count, pHitMask);
+	}
+
+	void RectVsCircles(float centreX, float centreY, float centreZ, float extentX, float extentY, const float* posX, const float* posY, float candidateRadius, size_t count, u64* pHitMask)
+	{
+		std::fill(pHitMask, pHitMask + GetHitMaskWords(count), 0ull);
+
+		size_t done = 0;
+		switch (s_isa)
+		{
+		case Isa::AVX2:
+			done = RectVsCirclesAVX2(centreX, centreY, centreZ, extentX, extentY, posX, posY, candidateRadius, count, pHitMask);
+			break;
+		case Isa::SSE:
+			done = RectVsCirclesSSE(centreX, centreY, centreZ, extentX, extentY, posX, posY, candidateRadius, count, pHitMask);
+			break;
+		default:
+			break;
+		}
+		RectVsCirclesScalar(centreX, centreY, centreZ, extentX, extentY, posX, posY, candidateRadius, done, count, pHitMask);
+	}
+}
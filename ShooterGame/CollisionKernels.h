@@ -0,0 +1,35 @@
+#pragma once
+#include "Play3d.h"
+
+// Batched narrowphase: one collider tested against N circles packed as separate x/y arrays, all sharing one radius.
+// Results are written as a bitmask (bit i of word i/64 set when candidate i overlaps), which must hold at least
+// GetHitMaskWords(count) words. Every path performs the same float operations in the same order as
+// GameObject::IsColliding(), with the circle as the radial collider, so results are bit-identical to it. Run the
+// game with --check-collision-kernels to check that on every ISA, and with --bench-collision-kernels for throughput.
+namespace CollisionKernels
+{
+	enum class Isa
+	{
+		SCALAR,
+		SSE,	// 4-wide
+		AVX2,	// 8-wide
+
+		TOTAL
+	};
+
+	// Widest ISA supported by this CPU; used unless overridden with SetIsa(), which also selects the ParticleKernels path
+	Isa GetBestIsa();
+	Isa GetIsa();
+	void SetIsa(Isa isa); // clamped to GetBestIsa()
+	const char* GetIsaName(Isa isa);
+
+	inline size_t GetHitMaskWords(size_t count) { return (count + 63) / 64; }
+
+	// Collider centre and radius are in world space, i.e. offset and scale already applied
+	void CircleVsCircles(float centreX, float centreY, float radius,
+		const float* posX, const float* posY, float candidateRadius, size_t count, Play3d::u64* pHitMask);
+
+	// Rect centre is in world space; extents are half sizes. centreZ is the rect's depth, candidates are at z = 0
+	void RectVsCircles(float centreX, float centreY, float centreZ, float extentX, float extentY,
+		const float* posX, const float* posY, float candidateRadius, size_t count, Play3d::u64* pHitMask);
+}
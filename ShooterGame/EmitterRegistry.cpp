@@ -0,0 +1,63 @@
+#include "EmitterRegistry.h"
+#include "ParticleEmitter.h"
+#include "Profiler.h"
+
+using namespace Play3d;
+
+// Not heap allocated like the other singletons: emitters owned by the flowstates unregister as those are destroyed,
+// which is after the game loop has returned
+static EmitterRegistry s_registry;
+
+EmitterRegistry* EmitterRegistry::Get()
+{
+	return &s_registry;
+}
+
+u32 EmitterRegistry::Register(ParticleEmitter* pEmitter)
+{
+	WaitTicks();
+	m_emitters.push_back(pEmitter);
+	return NextSeed();
+}
+
+void EmitterRegistry::Unregister(ParticleEmitter* pEmitter)
+{
+	WaitTicks();
+	auto it = std::find(m_emitters.begin(), m_emitters.end(), pEmitter);
+	PLAY_ASSERT(it != m_emitters.end());
+	*it = m_emitters.back();
+	m_emitters.pop_back();
+}
+
+void EmitterRegistry::SetSeed(u32 seed)
+{
+	m_seed = seed;
+	m_nextEmitterId = 0;
+}
+
+u32 EmitterRegistry::NextSeed()
+{
+	// Random::Seed() scrambles the seed, so consecutive ones still give unrelated sequences
+	return m_seed + m_nextEmitterId++;
+}
+
+void EmitterRegistry::KickTicks()
+{
+	WaitTicks();
+	Jobs::Dispatch(m_tickJobs, (u32)m_emitters.size(), EMITTERS_PER_JOB, [this](u32 begin, u32 end)
+	{
+		for (u32 i = begin; i < end; i++)
+		{
+			m_emitters[i]->RunQueuedTicks();
+		}
+	});
+}
+
+void EmitterRegistry::WaitTicks()
+{
+	if (m_tickJobs.IsBusy())
+	{
+		PROFILE_SCOPE(PROFILE_PARTICLES);
+		Jobs::Wait(m_tickJobs);
+	}
+}
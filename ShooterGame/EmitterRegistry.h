@@ -0,0 +1,37 @@
+#pragma once
+#include "Play3d.h"
+
+class ParticleEmitter;
+
+// Every live ParticleEmitter registers itself here. Owners queue ticks on their emitters during the update, then
+// KickTicks() runs all of them on the Play3d::Jobs workers while the main thread carries on. WaitTicks() is the join
+// point and must be called before any emitter is drawn or modified.
+//
+// Each emitter has its own random sequence, seeded from the registry seed and the order emitters were created in,
+// so the result is the same however the work is split between threads.
+class EmitterRegistry
+{
+public:
+	static EmitterRegistry* Get();
+
+	Play3d::u32 Register(ParticleEmitter* pEmitter); // returns the emitter's random seed
+	void Unregister(ParticleEmitter* pEmitter);
+
+	// Applies to emitters created or reseeded afterwards
+	void SetSeed(Play3d::u32 seed);
+	Play3d::u32 NextSeed();
+
+	void KickTicks();
+	void WaitTicks();
+
+	size_t GetEmitterCount() const { return m_emitters.size(); }
+
+private:
+	static constexpr Play3d::u32 EMITTERS_PER_JOB{ 8 };
+	static constexpr Play3d::u32 DEFAULT_SEED{ 0x5EED1234 };
+
+	std::vector<ParticleEmitter*> m_emitters;
+	Play3d::Jobs::JobGroup m_tickJobs;
+	Play3d::u32 m_seed{ DEFAULT_SEED };
+	Play3d::u32 m_nextEmitterId{ 0 };
+};
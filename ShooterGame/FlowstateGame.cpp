@@ -3,12 +3,17 @@
 #include "ObjectManager.h"
 #include "UtilityFunctions.h"
 #include "GameHud.h"
+#include "Profiler.h"
+#include "EmitterRegistry.h"
 
 #include "ObjectBoss.h"
 #include "ObjectPlayer.h"
 
 using namespace Play3d;
 
+// Upper bound on simulation ticks per rendered frame, so a long hitch can't snowball into ever longer frames
+static constexpr int MAX_SIM_TICKS_PER_FRAME{ 4 };
+
 void FlowstateGame::EnterState()
 {
 	// The lighting interface allows us to set some light properties.
@@ -21,8 +26,17 @@ void FlowstateGame::EnterState()
 	Graphics::SetLightColour(2, ColourValue(0xFFFFFF));
 	Graphics::SetLightDirection(2, Vector3f(-1, 1, -1));
 
-	// Setup player
+	// Start the simulation from tick 0, with the sim and every emitter created from here on seeded the same way each game.
+	// The star emitter lives as long as the state does, so it takes its seed again too
+	ResetSimClock();
+	EmitterRegistry::Get()->SetSeed(GetSimSeed());
+	m_starEmitter.Reseed();
+
+	// Finishes whatever the menu's prefetch hasn't, so the constructors below find their resources already loaded
 	GameObjectManager* pObjs{ GetObjectManager() };
+	pObjs->PreloadAssets(ASSET_PACK);
+
+	// Setup player
 	GameObject* pPlayer = pObjs->CreateObject(GameObjectType::TYPE_PLAYER, Vector3f(0.f, -GetGameHalfHeight() / 1.25f, 0.f));
 	pObjs->SetPlayer(pPlayer);
 
@@ -47,6 +61,10 @@ void FlowstateGame::EnterState()
 
 	// Set timer for quitting after gameover/victory
 	m_endgameTimer = 5.f;
+
+	// No stale input carried into the first tick
+	ConsumeSimInput();
+	m_simAccumulator = 0.f;
 }
 
 void FlowstateGame::SetGameCamera()
@@ -73,15 +91,58 @@ eFlowstates FlowstateGame::Update()
 	{
 		m_debugCollision = !m_debugCollision;
 	}
+	if (Input::IsKeyPressed(VK_F3))
+	{
+		m_debugProfile = !m_debugProfile;
+	}
+	if (Input::IsKeyPressed(VK_F4))
+	{
+		Profiler::Get()->WriteChromeTrace("profile_trace.json");
+	}
+
+	// Run as many fixed simulation ticks as real time has accrued, carrying the remainder into the next frame
+	LatchSimInput();
+	m_simAccumulator += System::GetDeltaTime();
+
+	eFlowstates nextState{ eFlowstates::STATE_NULL };
+	int ticks{ 0 };
+	while (m_simAccumulator >= SIM_TIMESTEP && nextState == eFlowstates::STATE_NULL)
+	{
+		if (ticks == MAX_SIM_TICKS_PER_FRAME)
+		{
+			// Too far behind (e.g. after a hitch), so drop the backlog and slow down rather than spiral
+			m_simAccumulator = 0.f;
+			break;
+		}
+
+		nextState = SimulateTick();
+		m_simAccumulator -= SIM_TIMESTEP;
+		ticks++;
+	}
+	SetSimInterpolation(m_simAccumulator / SIM_TIMESTEP);
 
+	// Background stars are purely cosmetic so they tick at the render rate
+	m_starEmitter.QueueTick(System::GetDeltaTime());
+
+	// Particles run on the job workers until Draw()
+	EmitterRegistry::Get()->KickTicks();
+
+	return nextState;
+}
+
+eFlowstates FlowstateGame::SimulateTick()
+{
+	PROFILE_SCOPE(PROFILE_SIM_TICK);
 	GameObjectManager* pObjs{ GetObjectManager() };
 	pObjs->UpdateAll();
-	m_starEmitter.Tick();
+	AdvanceSimClock();
+	ConsumeSimInput();
 
+	ObjectBoss* pBoss = static_cast<ObjectBoss*>(pObjs->GetBoss());
 	if (static_cast<ObjectPlayer*>(pObjs->GetPlayer())->IsGameOver()
-		|| static_cast<ObjectBoss*>(pObjs->GetPlayer())->IsAlive() == false)
+		|| pBoss == nullptr || pBoss->IsAlive() == false)
 	{
-		m_endgameTimer -= System::GetDeltaTime();
+		m_endgameTimer -= GetSimDeltaTime();
 		if (m_endgameTimer < 0.f)
 		{
 			return eFlowstates::STATE_MENU;
@@ -94,6 +155,8 @@ eFlowstates FlowstateGame::Update()
 
 void FlowstateGame::Draw()
 {
+	EmitterRegistry::Get()->WaitTicks();
+
 	// Set Camera Mode
 	if(m_debugCam)
 	{
@@ -103,7 +166,7 @@ void FlowstateGame::Draw()
 		UI::FontId fontId = UI::GetDebugFont();
 		static u32 frameCounter = 0;
 		UI::DrawString(fontId, Vector2f(20, 20), Colour::White, "Play3d, Single Header DX11");
-		UI::DrawPrintf(fontId, Vector2f(20, 50), Colour::Lightblue, "[frame %d, delta=%.2fms elapsed=%.2fs]", frameCounter++, System::GetDeltaTime() * 1000.f, System::GetElapsedTime());
+		UI::DrawPrintf(fontId, Vector2f(20, 50), Colour::Lightblue, "[frame %d, delta=%.2fms elapsed=%.2fs, sim tick %u]", frameCounter++, System::GetDeltaTime() * 1000.f, System::GetElapsedTime(), GetSimTickCount());
 	}
 	else
 	{
@@ -116,10 +179,27 @@ void FlowstateGame::Draw()
 	{
 		GetObjectManager()->DrawCollisionAll();
 	}
-	GetObjectManager()->DrawAll();
+	{
+		PROFILE_SCOPE(PROFILE_DRAW_OBJECTS);
+		GetObjectManager()->DrawAll();
+	}
 	m_starEmitter.Draw();
 	GameHud::Get()->Draw();
-	Graphics::EndPrimitiveBatch();
+	{
+		PROFILE_SCOPE(PROFILE_END_PRIMITIVE_BATCH);
+		Graphics::EndPrimitiveBatch();
+	}
+
+	if (m_debugCollision)
+	{
+		const CollisionStats& stats = GetObjectManager()->GetCollisionStats();
+		UI::DrawPrintf(UI::GetDebugFont(), Vector2f(20, 80), Colour::Lightblue, "[collision: objects=%d tested=%d colliding=%d]", stats.objectsInGrid, stats.pairsTested, stats.pairsColliding);
+	}
+
+	if (m_debugProfile)
+	{
+		Profiler::Get()->DrawOverlay(Vector2f(20, 110));
+	}
 }
 
 void FlowstateGame::ExitState()
@@ -11,11 +11,19 @@ public:
 	eFlowstates Update() override;
 	void Draw() override;
 
+	// Advances the game by exactly one fixed timestep; Update() calls this as often as real time requires
+	eFlowstates SimulateTick();
+
+	// Preloaded before the fight starts, and prefetched by the menu
+	static constexpr const char* ASSET_PACK{ "..\\Assets\\Game.pack" };
+
 private:
 	void SetGameCamera();
 
 	ParticleEmitter m_starEmitter;
 	float m_endgameTimer{0.f};
+	float m_simAccumulator{0.f};
 	bool m_debugCam{false};
 	bool m_debugCollision{false};
+	bool m_debugProfile{false};
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "FlowstateMachine.h"
 #include "Play3d.h"
+#include "Profiler.h"
 
 void FlowstateMachine::RegisterState(Flowstate* pState, eFlowstates stateId)
 {
@@ -21,8 +22,15 @@ void FlowstateMachine::Update()
 {
 	PLAY_ASSERT(m_curState != eFlowstates::STATE_NULL);
 
-	eFlowstates nextState = m_states[m_curState]->Update();
-	m_states[m_curState]->Draw();
+	eFlowstates nextState;
+	{
+		PROFILE_SCOPE(PROFILE_STATE_UPDATE);
+		nextState = m_states[m_curState]->Update();
+	}
+	{
+		PROFILE_SCOPE(PROFILE_STATE_DRAW);
+		m_states[m_curState]->Draw();
+	}
 
 	if (nextState != eFlowstates::STATE_NULL)
 	{
@@ -1,9 +1,16 @@
 #include "FlowstateMenu.h"
+#include "FlowstateGame.h"
 #include "ObjectManager.h"
+#include "EmitterRegistry.h"
 using namespace Play3d;
 
+static constexpr AssetPath START_SFX_PATH{ "..\\Assets\\Audio\\GameStart.wav" };
+
 void FlowstateMenu::EnterState()
 {
+	GetObjectManager()->PreloadAssets(ASSET_PACK);
+	m_menuShip.LoadAssets();
+
 	// Setup play button
 	m_buttonPlay.SetImages("..\\Assets\\Images\\ButtonPlay-Up.png", "..\\Assets\\Images\\ButtonPlay-Down.png");
 	m_buttonPlay.m_pos.y = 2.5f;
@@ -31,6 +38,9 @@ void FlowstateMenu::EnterState()
 	Graphics::SetLightDirection(1, Vector3f(1, 1, -1));
 	Graphics::SetLightColour(2, ColourValue(0xFFFFFF));
 	Graphics::SetLightDirection(2, Vector3f(-1, 1, -1));
+
+	// Read the game's assets while the menu is up
+	m_gameAssets = Resources::AsyncLoadAssets(FlowstateGame::ASSET_PACK);
 }
 
 void FlowstateMenu::SetMenuSceneCamera()
@@ -69,9 +79,11 @@ void FlowstateMenu::SetMenuOrthoCamera()
 
 eFlowstates FlowstateMenu::Update()
 {
-	m_starEmitter.Tick();
+	m_starEmitter.QueueTick(System::GetDeltaTime());
+	EmitterRegistry::Get()->KickTicks();
 	m_menuShip.Update();
 	m_buttonPlay.Update();
+	Resources::AssetsLoaded(m_gameAssets);
 
 	if (Input::IsKeyPressed(VK_F1))
 	{
@@ -80,7 +92,7 @@ eFlowstates FlowstateMenu::Update()
 
 	if (m_buttonPlay.IsClicked())
 	{
-		Audio::PlaySound(GetObjectManager()->GetAudioId("..\\Assets\\Audio\\GameStart.wav"), 1.f);
+		Audio::PlaySound(GetObjectManager()->GetAudioId(START_SFX_PATH), 1.f);
 		return eFlowstates::STATE_PLAY;
 	}
 
@@ -89,6 +101,8 @@ eFlowstates FlowstateMenu::Update()
 
 void FlowstateMenu::Draw()
 {
+	EmitterRegistry::Get()->WaitTicks();
+
 	// Draw '3d world'
 	if (m_debugCam)
 	{
@@ -13,6 +13,8 @@ public:
 	eFlowstates Update() override;
 	void Draw() override;
 
+	static constexpr const char* ASSET_PACK{ "..\\Assets\\Menu.pack" };
+
 private:
 	void SetMenuSceneCamera();
 	void SetMenuOrthoCamera();
@@ -20,6 +22,7 @@ private:
 	ParticleEmitter m_starEmitter;
 	MenuShip m_menuShip;
 	MenuButton m_buttonPlay;
+	Play3d::IdKey<Play3d::Resources::AsyncLoadingTask> m_gameAssets;
 
 	bool m_debugCam{false};
 };
\ No newline at end of file
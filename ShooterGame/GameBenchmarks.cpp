@@ -0,0 +1,584 @@
+#include "GameBenchmarks.h"
+#include "ObjectManager.h"
+#include "ObjectBossBomb.h"
+#include "CollisionGrid.h"
+#include "CollisionKernels.h"
+#include "ProjectileStore.h"
+#include "Random.h"
+
+#include <chrono>
+#include <cstring>
+
+using namespace Play3d;
+
+// Churns CHURN_PER_TICK objects a tick for the given ticks, destroying the oldest as pellets leaving the screen would,
+// through the pool or through new and delete when there's no pool. Returns ns per create and destroy.
+template<typename T>
+static f64 TimeObjectChurn(ObjectPool<T>* pPool, std::vector<T*>& rLive, u32& rOldest, u32 churnPerTick, u32 ticks)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	for (u32 tick = 0; tick < ticks; tick++)
+	{
+		for (u32 i = 0; i < churnPerTick; i++)
+		{
+			T*& rObj = rLive[rOldest];
+			Vector3f pos((f32)(rOldest % 100), 0.f, 0.f);
+			if (pPool && pPool->Owns(rObj))
+			{
+				pPool->Release(rObj);
+			}
+			else
+			{
+				delete rObj;
+			}
+			rObj = pPool ? pPool->Acquire(pos) : new T(pos);
+			rOldest = (rOldest + 1) % (u32)rLive.size();
+		}
+	}
+	return std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - startTime).count() / ((f64)churnPerTick * ticks);
+}
+
+// 100k objects created and destroyed per second of game time with a steady 2000 alive, through plain new and delete,
+// through an object pool sized for them and through one at the capacity the game gives bombs (which overflows to
+// the heap). Bombs are the pooled type, but constructing one costs more than allocating it, so the allocator alone is
+// timed with a trivial object of the same size, then whole bombs. The variants take turns and each time is the best.
+static bool RunPoolBenchmark()
+{
+	static constexpr u32 LIVE_OBJECTS{ 2000 };
+	static constexpr u32 CHURN_PER_TICK{ 100000 / 60 };
+	static constexpr u32 BENCH_TICKS{ 120 };
+	static constexpr int BENCH_REPEATS{ 15 };
+
+	struct BombSized
+	{
+		BombSized(Vector3f pos) : m_pos(pos) {}
+		Vector3f m_pos;
+		u8 m_padding[sizeof(ObjectBossBomb) - sizeof(Vector3f)];
+	};
+
+	size_t gameCapacity = GetObjectManager()->GetPoolStats(TYPE_BOSS_BOMB).capacity;
+
+	auto run = [&](auto* pType, const char* pTypeName)
+	{
+		using T = std::remove_pointer_t<decltype(pType)>;
+		static constexpr int VARIANTS{ 3 };
+		const char* variantNames[VARIANTS] = { "new/delete", "pool, capacity 2000", "pool, game capacity" };
+		std::unique_ptr<ObjectPool<T>> pools[VARIANTS] = { nullptr, std::make_unique<ObjectPool<T>>(LIVE_OBJECTS),
+			std::make_unique<ObjectPool<T>>(gameCapacity) };
+		std::vector<T*> live[VARIANTS];
+		u32 oldest[VARIANTS] = {};
+		f64 bestNs[VARIANTS] = {};
+		for (int variant = 0; variant < VARIANTS; variant++)
+		{
+			live[variant].resize(LIVE_OBJECTS, nullptr);
+			TimeObjectChurn(pools[variant].get(), live[variant], oldest[variant], LIVE_OBJECTS, 1);
+		}
+		for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+		{
+			for (int variant = 0; variant < VARIANTS; variant++)
+			{
+				f64 ns = TimeObjectChurn(pools[variant].get(), live[variant], oldest[variant], CHURN_PER_TICK, BENCH_TICKS);
+				bestNs[variant] = repeat == 0 ? ns : std::min(bestNs[variant], ns);
+			}
+		}
+		for (int variant = 0; variant < VARIANTS; variant++)
+		{
+			ObjectPool<T>* pPool = pools[variant].get();
+			for (T* pObj : live[variant])
+			{
+				if (pPool && pPool->Owns(pObj))
+				{
+					pPool->Release(pObj);
+				}
+				else
+				{
+					delete pObj;
+				}
+			}
+			// One second of game time churns 60 ticks' worth
+			size_t overflow = pPool ? pPool->GetStats().overflow : 0;
+			Debug::Printf("%-12s %-20s %7.2f ns per create and destroy, %6.3f ms per second of game time, %8zu overflowed to new\n",
+				pTypeName, variantNames[variant], bestNs[variant], bestNs[variant] * CHURN_PER_TICK * 60 * 1e-6, overflow);
+		}
+	};
+	run((BombSized*)nullptr, "Allocator");
+	run((ObjectBossBomb*)nullptr, "Bombs");
+	Debug::Printf("Each pool served %u warm up creations and %u timed ones; the game gives bombs a capacity of %zu\n", LIVE_OBJECTS,
+		CHURN_PER_TICK * BENCH_TICKS * BENCH_REPEATS, gameCapacity);
+	DestroyObjectManager();
+	return true;
+}
+
+// A pellet as it was before the projectile store: a GameObject with one radial collider
+class BenchPellet : public GameObject
+{
+public:
+	BenchPellet(GameObjectType type, Vector3f pos, float radius) : GameObject(type, pos) { m_colliders[0].radius = radius; }
+	void Update() override {}
+};
+
+// Pair tests and broadphase plus narrowphase time for a screen of player and boss pellets, through the uniform grid
+// and through the loop it replaced, which compared every object with every other one. Both must find the same hits.
+// The grid time is the best of several frames; the old loop runs once, as it takes seconds at the larger counts.
+static bool RunBroadphaseBenchmark()
+{
+	static constexpr float CELL_SIZE{ 1.f }; // as CollideAll() uses
+	static constexpr int GRID_FRAMES{ 10 };
+
+	bool bPassed = true;
+	float halfWidth = GetGameHalfWidth();
+	float halfHeight = GetGameHalfHeight();
+	for (u32 count : { 100u, 1000u, 10000u, 50000u })
+	{
+		// Alternating player and boss pellets, as the pellets of both owners are mixed across the screen
+		Random random(count);
+		std::vector<std::unique_ptr<BenchPellet>> pellets;
+		std::vector<GameObject*> objects;
+		for (u32 i = 0; i < count; i++)
+		{
+			Vector3f pos(random.NextInRange(-halfWidth, halfWidth), random.NextInRange(-halfHeight, halfHeight), 0.f);
+			bool bBoss = i % 2 == 1;
+			pellets.push_back(std::make_unique<BenchPellet>(bBoss ? TYPE_BOSS_PELLET : TYPE_PLAYER_PELLET, pos, bBoss ? 0.18f : 0.1f));
+			objects.push_back(pellets.back().get());
+		}
+
+		u64 allPairsTests = 0;
+		u64 allPairsHits = 0;
+		auto startTime = std::chrono::steady_clock::now();
+		for (u32 i = 0; i < count; i++)
+		{
+			for (u32 j = i + 1; j < count; j++)
+			{
+				if (objects[i]->GetObjectType() != objects[j]->GetObjectType())
+				{
+					allPairsTests++;
+					allPairsHits += objects[i]->IsColliding(objects[j]) ? 1 : 0;
+				}
+			}
+		}
+		f64 allPairsMs = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		CollisionGrid grid;
+		std::vector<CollisionBounds> bounds(count);
+		std::vector<u32> candidates;
+		u64 gridTests = 0;
+		u64 gridHits = 0;
+		f64 gridMs = 0.0;
+		for (int frame = 0; frame < GRID_FRAMES; frame++)
+		{
+			gridTests = 0;
+			gridHits = 0;
+			startTime = std::chrono::steady_clock::now();
+			for (u32 i = 0; i < count; i++)
+			{
+				bounds[i] = objects[i]->GetCollisionBounds();
+			}
+			grid.Build(bounds, halfWidth, halfHeight, CELL_SIZE);
+			for (u32 i = 0; i < count; i++)
+			{
+				candidates.clear();
+				grid.Query(bounds[i], candidates);
+				for (u32 j : candidates)
+				{
+					if (j > i && objects[i]->GetObjectType() != objects[j]->GetObjectType())
+					{
+						gridTests++;
+						gridHits += objects[i]->IsColliding(objects[j]) ? 1 : 0;
+					}
+				}
+			}
+			f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			gridMs = frame == 0 ? ms : std::min(gridMs, ms);
+		}
+
+		Debug::Printf("%5u objects: all pairs %11llu tests %10.3f ms, grid %8llu tests %7.3f ms (%.0fx), %llu hits %s\n", count,
+			(unsigned long long)allPairsTests, allPairsMs, (unsigned long long)gridTests, gridMs, allPairsMs / gridMs,
+			(unsigned long long)gridHits, gridHits == allPairsHits ? "match" : "DIFFER");
+		bPassed &= gridHits == allPairsHits;
+	}
+	return bPassed;
+}
+
+// One tick of 50k live pellets on one core: 45k boss pellets and 5k player pellets drifting slowly across the play
+// area, collided against a player-sized circle and a boss with a circle and a rect collider, and drawn through the
+// mesh queue as DrawAll() does. Pellets lost to the edges or to hits are topped back up between timed ticks.
+static bool RunProjectileBenchmark()
+{
+	static constexpr size_t LIVE_PROJECTILES[OWNER_TOTAL]{ 5000, 45000 };
+	static constexpr int BENCH_TICKS{ 120 };
+
+	class BenchTarget : public GameObject
+	{
+	public:
+		BenchTarget(GameObjectType type, Vector3f pos) : GameObject(type, pos) {}
+		void Update() override {}
+		std::vector<CollisionData>& Colliders() { return m_colliders; }
+	};
+
+	float halfWidth = GetGameHalfWidth();
+	float halfHeight = GetGameHalfHeight();
+
+	BenchTarget player(TYPE_PLAYER, Vector3f(0.f, -halfHeight / 1.25f, 0.f));
+	player.Colliders()[0].radius = 0.5f;
+	BenchTarget boss(TYPE_BOSS, Vector3f(0.f, halfHeight / 1.25f, 0.f));
+	boss.Colliders()[0].radius = 1.f;
+	CollisionData rect;
+	rect.type = CollisionMode::COLL_RECT;
+	rect.extents = Vector2f(3.f, 0.5f);
+	boss.Colliders().push_back(rect);
+	GameObject* targets[OWNER_TOTAL] = { &boss, &player };
+
+	ProjectileStore store;
+	Random random(4);
+	auto topUp = [&]()
+	{
+		for (int owner = 0; owner < OWNER_TOTAL; owner++)
+		{
+			while (store.GetCount((ProjectileOwner)owner) < LIVE_PROJECTILES[owner])
+			{
+				Vector2f pos(random.NextInRange(-halfWidth, halfWidth), random.NextInRange(-halfHeight, halfHeight));
+				Vector2f vel(random.NextInRange(-0.01f, 0.01f), random.NextInRange(-0.01f, 0.01f));
+				store.Spawn((ProjectileOwner)owner, pos, vel);
+			}
+		}
+	};
+
+	f64 bestMs[3] = {};
+	u64 hits = 0;
+	u64 removed = 0;
+	for (int tick = 0; tick < BENCH_TICKS; tick++)
+	{
+		topUp();
+		System::BeginFrame();
+		CollisionStats stats;
+
+		auto startTime = std::chrono::steady_clock::now();
+		store.UpdateAll();
+		auto updatedTime = std::chrono::steady_clock::now();
+		for (int owner = 0; owner < OWNER_TOTAL; owner++)
+		{
+			store.Collide((ProjectileOwner)owner, targets[owner], stats);
+		}
+		auto collidedTime = std::chrono::steady_clock::now();
+		Graphics::BeginMeshQueue();
+		store.DrawAll();
+		Graphics::EndMeshQueue();
+		auto drawnTime = std::chrono::steady_clock::now();
+		System::EndFrame();
+
+		f64 ms[3] = { std::chrono::duration<f64, std::milli>(updatedTime - startTime).count(),
+			std::chrono::duration<f64, std::milli>(collidedTime - updatedTime).count(),
+			std::chrono::duration<f64, std::milli>(drawnTime - collidedTime).count() };
+		for (int phase = 0; phase < 3; phase++)
+		{
+			bestMs[phase] = tick == 0 ? ms[phase] : std::min(bestMs[phase], ms[phase]);
+		}
+		hits += stats.pairsColliding;
+		removed += LIVE_PROJECTILES[OWNER_PLAYER] + LIVE_PROJECTILES[OWNER_BOSS] - store.GetCount(OWNER_PLAYER) - store.GetCount(OWNER_BOSS);
+	}
+
+	f64 totalMs = bestMs[0] + bestMs[1] + bestMs[2];
+	Debug::Printf("%zu projectiles, best of %d ticks: UpdateAll %.3f ms, Collide %.3f ms, DrawAll %.3f ms, total %.3f ms (%.0f%% of a 60Hz tick)\n",
+		LIVE_PROJECTILES[OWNER_PLAYER] + LIVE_PROJECTILES[OWNER_BOSS], BENCH_TICKS, bestMs[0], bestMs[1], bestMs[2], totalMs, totalMs * 100.0 * 60.0 / 1000.0);
+	Debug::Printf("%.1f hits and %.1f projectiles removed per tick, topped back up between ticks\n", (f64)hits / BENCH_TICKS, (f64)removed / BENCH_TICKS);
+	return true;
+}
+
+// A GameObject whose single collider and scale can be set freely, to compare the batched kernels with IsColliding()
+class KernelCheckObject : public GameObject
+{
+public:
+	KernelCheckObject(GameObjectType type) : GameObject(type, Vector3f(0.f, 0.f, 0.f)) {}
+	void Update() override {}
+	void Set(Vector3f pos, float scale, const CollisionData& coll)
+	{
+		m_pos = pos;
+		m_scale = scale;
+		m_colliders[0] = coll;
+	}
+};
+
+// Random colliders and candidates on every ISA, checked bit for bit against GameObject::IsColliding(): circles and
+// rects with offsets, scales and depth, against every candidate count from 1 to 64 and then larger random counts
+static bool RunCollisionKernelCheck()
+{
+	static constexpr int TRIALS{ 2000 };
+	static constexpr size_t MAX_CANDIDATES{ 300 };
+
+	bool bPassed = true;
+	Random random(7);
+	std::vector<float> posX(MAX_CANDIDATES);
+	std::vector<float> posY(MAX_CANDIDATES);
+	std::vector<u64> hitMask(CollisionKernels::GetHitMaskWords(MAX_CANDIDATES));
+	KernelCheckObject target(TYPE_BOSS);
+	KernelCheckObject candidate(TYPE_BOSS_PELLET);
+	for (int isa = 0; isa <= (int)CollisionKernels::GetBestIsa(); isa++)
+	{
+		CollisionKernels::SetIsa((CollisionKernels::Isa)isa);
+		u64 tests[2] = {};
+		u64 hits[2] = {};
+		u64 mismatches[2] = {};
+		for (int trial = 0; trial < TRIALS; trial++)
+		{
+			bool bRect = trial % 2 == 1;
+			size_t count = trial < 128 ? (size_t)(trial / 2) + 1 : (size_t)random.NextInRange(1.f, (float)MAX_CANDIDATES);
+
+			CollisionData targetColl;
+			targetColl.type = bRect ? CollisionMode::COLL_RECT : CollisionMode::COLL_RADIAL;
+			targetColl.offset = Vector2f(random.NextInRange(-1.f, 1.f), random.NextInRange(-1.f, 1.f));
+			targetColl.radius = random.NextInRange(0.05f, 2.f);
+			targetColl.extents = Vector2f(random.NextInRange(0.05f, 3.f), random.NextInRange(0.05f, 3.f));
+			float targetZ = random.NextInRange(0.05f, 2.f) * (random.NextInRange(-1.f, 1.f) < 0.f ? -1.f : 1.f);
+			Vector3f targetPos(random.NextInRange(-5.f, 5.f), random.NextInRange(-5.f, 5.f), targetZ);
+			target.Set(targetPos, random.NextInRange(0.5f, 3.f), targetColl);
+
+			CollisionData candidateColl;
+			candidateColl.radius = random.NextInRange(0.05f, 1.f);
+			float candidateScale = random.NextInRange(0.5f, 2.f);
+			for (size_t i = 0; i < count; i++)
+			{
+				posX[i] = targetPos.x + random.NextInRange(-5.f, 5.f);
+				posY[i] = targetPos.y + random.NextInRange(-5.f, 5.f);
+			}
+
+			Vector2f centre(targetPos.x + targetColl.offset.x, targetPos.y + targetColl.offset.y);
+			float candidateRadius = candidateColl.radius * candidateScale;
+			if (bRect)
+			{
+				CollisionKernels::RectVsCircles(centre.x, centre.y, targetZ, targetColl.extents.x, targetColl.extents.y, posX.data(), posY.data(),
+					candidateRadius, count, hitMask.data());
+			}
+			else
+			{
+				CollisionKernels::CircleVsCircles(centre.x, centre.y, targetColl.radius * target.GetScale(), posX.data(), posY.data(),
+					candidateRadius, count, hitMask.data());
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				candidate.Set(Vector3f(posX[i], posY[i], 0.f), candidateScale, candidateColl);
+				bool bExpected = target.IsColliding(&candidate);
+				bool bHit = (hitMask[i / 64] & (1ull << (i % 64))) != 0;
+				tests[bRect]++;
+				hits[bRect] += bExpected ? 1 : 0;
+				mismatches[bRect] += bHit != bExpected ? 1 : 0;
+			}
+			// Nothing may be set past the last candidate
+			for (size_t i = count; i < CollisionKernels::GetHitMaskWords(count) * 64; i++)
+			{
+				mismatches[bRect] += (hitMask[i / 64] & (1ull << (i % 64))) != 0 ? 1 : 0;
+			}
+		}
+
+		for (int bRect = 0; bRect < 2; bRect++)
+		{
+			Debug::Printf("%-6s %-14s %7llu tests, %6llu hits, %llu differ from IsColliding(): %s\n", CollisionKernels::GetIsaName((CollisionKernels::Isa)isa),
+				bRect ? "RectVsCircles" : "CircleVsCircles", (unsigned long long)tests[bRect], (unsigned long long)hits[bRect],
+				(unsigned long long)mismatches[bRect], mismatches[bRect] == 0 ? "ok" : "FAILED");
+			bPassed &= mismatches[bRect] == 0;
+		}
+	}
+	CollisionKernels::SetIsa(CollisionKernels::GetBestIsa());
+
+	Debug::Printf("Collision kernel check %s\n", bPassed ? "passed" : "FAILED");
+	return bPassed;
+}
+
+// Narrowphase throughput on each ISA: one collider against 10k candidates spread around it, with one call to
+// IsColliding() per pair as the baseline. Each rate is the best of several passes.
+static bool RunCollisionKernelBenchmark()
+{
+	static constexpr size_t CANDIDATES{ 10000 };
+	static constexpr int PASSES{ 200 };
+	static constexpr int REPEATS{ 5 };
+
+	Random random(8);
+	std::vector<float> posX(CANDIDATES);
+	std::vector<float> posY(CANDIDATES);
+	for (size_t i = 0; i < CANDIDATES; i++)
+	{
+		posX[i] = random.NextInRange(-8.f, 8.f);
+		posY[i] = random.NextInRange(-8.f, 8.f);
+	}
+	std::vector<u64> hitMask(CollisionKernels::GetHitMaskWords(CANDIDATES));
+
+	CollisionData circle;
+	circle.radius = 1.f;
+	CollisionData rect;
+	rect.type = CollisionMode::COLL_RECT;
+	rect.extents = Vector2f(3.f, 0.5f);
+	CollisionData pellet;
+	pellet.radius = 0.15f;
+
+	auto rate = [](auto&& test)
+	{
+		f64 bestSeconds = 0.0;
+		for (int repeat = 0; repeat < REPEATS; repeat++)
+		{
+			auto startTime = std::chrono::steady_clock::now();
+			for (int pass = 0; pass < PASSES; pass++)
+			{
+				test();
+			}
+			f64 seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - startTime).count();
+			bestSeconds = repeat == 0 ? seconds : std::min(bestSeconds, seconds);
+		}
+		return (f64)CANDIDATES * PASSES / bestSeconds / 1e6;
+	};
+
+	for (int bRect = 0; bRect < 2; bRect++)
+	{
+		const char* pName = bRect ? "RectVsCircles" : "CircleVsCircles";
+		KernelCheckObject target(TYPE_BOSS);
+		target.Set(Vector3f(0.f, 0.f, 0.5f), 1.f, bRect ? rect : circle);
+		KernelCheckObject candidate(TYPE_BOSS_PELLET);
+		u64 checksum = 0;
+		f64 baseline = rate([&]()
+		{
+			for (size_t i = 0; i < CANDIDATES; i++)
+			{
+				candidate.Set(Vector3f(posX[i], posY[i], 0.f), 1.f, pellet);
+				checksum += target.IsColliding(&candidate) ? 1 : 0;
+			}
+		});
+		Debug::Printf("%-15s %-14s %8.1f M tests/s (%llu hits per pass)\n", pName, "IsColliding()", baseline,
+			(unsigned long long)(checksum / (PASSES * REPEATS)));
+
+		for (int isa = 0; isa <= (int)CollisionKernels::GetBestIsa(); isa++)
+		{
+			CollisionKernels::SetIsa((CollisionKernels::Isa)isa);
+			f64 kernelRate = rate([&]()
+			{
+				if (bRect)
+				{
+					CollisionKernels::RectVsCircles(0.f, 0.f, 0.5f, rect.extents.x, rect.extents.y, posX.data(), posY.data(), pellet.radius, CANDIDATES, hitMask.data());
+				}
+				else
+				{
+					CollisionKernels::CircleVsCircles(0.f, 0.f, circle.radius, posX.data(), posY.data(), pellet.radius, CANDIDATES, hitMask.data());
+				}
+			});
+			Debug::Printf("%-15s %-14s %8.1f M tests/s (%.1fx)\n", pName, CollisionKernels::GetIsaName((CollisionKernels::Isa)isa), kernelRate, kernelRate / baseline);
+		}
+	}
+	CollisionKernels::SetIsa(CollisionKernels::GetBestIsa());
+	return true;
+}
+
+// The player's bomb destroying every boss pellet at once: 10k and 50k pellets with one survivor after every ten, all
+// cleared by a single CleanUpAll() in each mode. The erase(find()) per object which CleanUpAll() used to do is timed on
+// a copy of the same list for comparison. The stable mode must leave the survivors in their original order.
+static bool RunCleanUpBenchmark()
+{
+	static constexpr u32 SURVIVOR_INTERVAL{ 11 };
+
+	bool bPassed = true;
+	for (u32 pellets : { 10000u, 50000u })
+	{
+		// The list removal alone, without unregistering or freeing anything
+		std::vector<u32> oldList;
+		for (u32 i = 0; i < pellets + pellets / (SURVIVOR_INTERVAL - 1); i++)
+		{
+			oldList.push_back(i);
+		}
+		std::vector<u32> destroyed;
+		for (u32 i : oldList)
+		{
+			if (i % SURVIVOR_INTERVAL != 0)
+			{
+				destroyed.push_back(i);
+			}
+		}
+		auto startTime = std::chrono::steady_clock::now();
+		for (u32 i : destroyed)
+		{
+			oldList.erase(std::find(oldList.begin(), oldList.end(), i));
+		}
+		f64 oldMs = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		Debug::Printf("%5u pellets: %-28s %9.3f ms\n", pellets, "erase(find()), list only", oldMs);
+
+		for (CleanUpMode mode : { CLEANUP_STABLE, CLEANUP_UNORDERED })
+		{
+			GameObjectManager* pObjs = GetObjectManager();
+			pObjs->SetCleanUpMode(mode);
+			std::vector<GameObject*> survivors;
+			for (u32 i = 0; i < (u32)oldList.size() + (u32)destroyed.size(); i++)
+			{
+				bool bSurvivor = i % SURVIVOR_INTERVAL == 0;
+				GameObject* pObj = new BenchPellet(bSurvivor ? TYPE_ASTEROID : TYPE_BOSS_PELLET, Vector3f((f32)i, 0.f, 0.f), 0.15f);
+				pObjs->RegisterGameObject(pObj);
+				if (bSurvivor)
+				{
+					survivors.push_back(pObj);
+				}
+				else
+				{
+					pObj->Destroy();
+				}
+			}
+
+			startTime = std::chrono::steady_clock::now();
+			pObjs->CleanUpAll();
+			f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+			ObjectRange objects = pObjs->GetAllObjects();
+			bool bSameSet = objects.size() == survivors.size() && pObjs->GetObjectsOfType(TYPE_BOSS_PELLET).empty();
+			bool bSameOrder = bSameSet && std::equal(objects.begin(), objects.end(), survivors.begin());
+			const char* pResult = "";
+			if (mode == CLEANUP_STABLE)
+			{
+				pResult = bSameOrder ? "survivors in order" : "FAILED, survivors out of order";
+				bPassed &= bSameOrder;
+			}
+			else
+			{
+				pResult = bSameSet ? (bSameOrder ? "survivors in order" : "survivors reordered") : "FAILED, wrong survivors";
+				bPassed &= bSameSet;
+			}
+			Debug::Printf("%5u pellets: %-28s %9.3f ms, %zu survivors, %s\n", pellets,
+				mode == CLEANUP_STABLE ? "CleanUpAll(), stable" : "CleanUpAll(), unordered", ms, survivors.size(), pResult);
+			DestroyObjectManager();
+		}
+	}
+	return bPassed;
+}
+
+struct GameBenchmark
+{
+	const char* pFlag;
+	bool (*pRun)();
+};
+
+static constexpr GameBenchmark s_benchmarks[]
+{
+	{ "--bench-pool", RunPoolBenchmark },
+	{ "--bench-broadphase", RunBroadphaseBenchmark },
+	{ "--bench-projectiles", RunProjectileBenchmark },
+	{ "--check-collision-kernels", RunCollisionKernelCheck },
+	{ "--bench-collision-kernels", RunCollisionKernelBenchmark },
+	{ "--bench-cleanup", RunCleanUpBenchmark },
+};
+
+bool IsGameBenchmark(const char* pFlag)
+{
+	for (const GameBenchmark& rBenchmark : s_benchmarks)
+	{
+		if (strcmp(rBenchmark.pFlag, pFlag) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool RunGameBenchmark(const char* pFlag)
+{
+	for (const GameBenchmark& rBenchmark : s_benchmarks)
+	{
+		if (strcmp(rBenchmark.pFlag, pFlag) == 0)
+		{
+			return rBenchmark.pRun();
+		}
+	}
+	return false;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Benchmarks and correctness checks of the game's systems. Each is run by its command line flag, e.g. "--bench-pool",
+// from Main.cpp or HeadlessMain.cpp in place of the game, after Play3d is initialised. Results are printed with
+// Debug::Printf.
+bool IsGameBenchmark(const char* pFlag);
+bool RunGameBenchmark(const char* pFlag); // false if a check failed
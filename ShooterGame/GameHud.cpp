@@ -4,6 +4,12 @@
 
 using namespace Play3d;
 
+static constexpr AssetPath HUD_SHADER_PATH{ "..\\Assets\\Shaders\\HUD.hlsl" };
+static constexpr AssetPath HUD_TEXTURE_PATH{ "..\\Assets\\Images\\HUD.png" };
+static constexpr AssetPath BACKGROUND_TEXTURE_PATH{ "..\\Assets\\Images\\background.png" };
+static constexpr AssetPath LIFE_TEXTURE_PATH{ "..\\Assets\\Images\\life.png" };
+static constexpr AssetPath BOMB_TEXTURE_PATH{ "..\\Assets\\Images\\bomb.png" };
+
 static GameHud* s_pHud{nullptr};
 
 GameHud* GameHud::Get()
@@ -26,10 +32,10 @@ GameHud::GameHud()
 	m_meshFullscreen = Graphics::CreatePlane(GetGameHalfWidth(), GetGameHalfHeight());
 	m_meshIcon = Graphics::CreatePlane(.5f, .5f);
 
-	m_matHud = GetObjectManager()->GetMaterialHLSL("..\\Assets\\Shaders\\HUD.hlsl", "..\\Assets\\Images\\HUD.png");
-	m_matBackground = GetObjectManager()->GetMaterial("..\\Assets\\Images\\background.png");
-	m_matLife = GetObjectManager()->GetMaterial("..\\Assets\\Images\\life.png");
-	m_matBomb = GetObjectManager()->GetMaterial("..\\Assets\\Images\\bomb.png");
+	m_matHud = GetObjectManager()->GetMaterialHLSL(HUD_SHADER_PATH, HUD_TEXTURE_PATH);
+	m_matBackground = GetObjectManager()->GetMaterial(BACKGROUND_TEXTURE_PATH);
+	m_matLife = GetObjectManager()->GetMaterial(LIFE_TEXTURE_PATH);
+	m_matBomb = GetObjectManager()->GetMaterial(BOMB_TEXTURE_PATH);
 }
 
 void GameHud::Draw()
@@ -1,16 +1,42 @@
 #include "GameObject.h"
 #include "ObjectManager.h"
 #include <fstream>
+#include <cfloat>
 
 using namespace Play3d;
 
+// Collision layer of each GameObjectType, in enum order
+static constexpr CollisionLayer s_typeLayers[TYPE_TOTAL]
+{
+	LAYER_PLAYER,				// TYPE_PLAYER
+	LAYER_PLAYER_PROJECTILE,	// TYPE_PLAYER_PELLET
+	LAYER_DEBRIS,				// TYPE_PLAYER_CHUNK_CORE
+	LAYER_DEBRIS,				// TYPE_PLAYER_CHUNK_WING_L
+	LAYER_DEBRIS,				// TYPE_PLAYER_CHUNK_WING_R
+	LAYER_ENEMY,				// TYPE_BOSS
+	LAYER_ENEMY_PROJECTILE,		// TYPE_BOSS_PELLET
+	LAYER_ENEMY_PROJECTILE,		// TYPE_BOSS_BOMB
+	LAYER_DEBRIS,				// TYPE_BOSS_CHUNK_CORE
+	LAYER_DEBRIS,				// TYPE_BOSS_CHUNK_LEFT
+	LAYER_DEBRIS,				// TYPE_BOSS_CHUNK_RIGHT
+	LAYER_DEBRIS,				// TYPE_BOSS_CHUNK_LOWER
+	LAYER_ENEMY,				// TYPE_ASTEROID
+};
+static_assert(TYPE_TOTAL == 13, "New GameObjectType added, give it a collision layer in s_typeLayers");
+
 GameObject::GameObject( GameObjectType objType, Vector3f position)
 {
 	m_type = objType;
 	m_pos = position;
+	m_oldPos = position;
 	m_colliders.push_back(CollisionData());
 }
 
+CollisionLayer GameObject::GetCollisionLayer() const
+{
+	return (m_type == TYPE_NULL) ? LAYER_NONE : s_typeLayers[m_type];
+}
+
 bool GameObject::IsColliding( GameObject* obj )
 {
 	//Don't test between null/non-collide objects
@@ -93,6 +119,26 @@ bool GameObject::IsColliding( GameObject* obj )
 	return false;
 }
 
+CollisionBounds GameObject::GetCollisionBounds() const
+{
+	CollisionBounds bounds;
+	if (!CanCollide())
+		return bounds;
+
+	// Must enclose everything IsColliding() can hit: radial colliders scale with the object, rect colliders don't
+	bounds.minX = bounds.minY = FLT_MAX;
+	bounds.maxX = bounds.maxY = -FLT_MAX;
+	for (const CollisionData& coll : m_colliders)
+	{
+		Vector2f halfSize = (coll.type == CollisionMode::COLL_RADIAL) ? Vector2f(coll.radius * m_scale, coll.radius * m_scale) : coll.extents;
+		bounds.minX = std::min(bounds.minX, m_pos.x + coll.offset.x - halfSize.x);
+		bounds.minY = std::min(bounds.minY, m_pos.y + coll.offset.y - halfSize.y);
+		bounds.maxX = std::max(bounds.maxX, m_pos.x + coll.offset.x + halfSize.x);
+		bounds.maxY = std::max(bounds.maxY, m_pos.y + coll.offset.y + halfSize.y);
+	}
+	return bounds;
+}
+
 bool GameObject::IsOutsideOrthoView()
 {
 	return (m_pos.x < -GetGameHalfWidth() || m_pos.x > GetGameHalfWidth() || m_pos.y < -GetGameHalfHeight() || m_pos.y > GetGameHalfHeight());
@@ -100,11 +146,16 @@ bool GameObject::IsOutsideOrthoView()
 
 void GameObject::Draw() const
 {
+	// Blend between the last two simulation ticks so motion stays smooth at any render rate
+	float alpha = GetSimInterpolation();
+	Vector3f pos = m_oldPos + ((m_pos - m_oldPos) * alpha);
+	Vector3f rotation = m_oldRotation + ((m_rotation - m_oldRotation) * alpha);
+
 	Matrix4x4f transform = 
-		  MatrixTranslate<f32>(m_pos.x, m_pos.y, m_pos.z)
-		* MatrixRotationX<f32>(m_rotation.x)
-		* MatrixRotationY<f32>(m_rotation.y)
-		* MatrixRotationZ<f32>(m_rotation.z)
+		  MatrixTranslate<f32>(pos.x, pos.y, pos.z)
+		* MatrixRotationX<f32>(rotation.x)
+		* MatrixRotationY<f32>(rotation.y)
+		* MatrixRotationZ<f32>(rotation.z)
 		* MatrixScale<f32>(m_scale, m_scale, m_scale);
 
 	Graphics::SetMaterial(m_materialId);
@@ -140,12 +191,19 @@ void GameObject::DrawCollision() const
 
 void GameObject::StandardMovementUpdate()
 {
+	m_oldRotation = m_rotation;
 	m_rotation += m_rotSpeed;
 	m_oldPos = m_pos;
 	m_velocity += m_acceleration;
 	m_pos += m_velocity;
 }
 
+void GameObject::SnapInterpolation()
+{
+	m_oldPos = m_pos;
+	m_oldRotation = m_rotation;
+}
+
 void GameObject::Destroy( )
 {
 	m_destroy = true;
@@ -1,6 +1,7 @@
 #pragma once
-#include "Play3D.h"
+#include "Play3d.h"
 #include "UtilityFunctions.h"
+#include "CollisionGrid.h"
 
 // The GameObject type is the only representation of type which is visible to code externally
 enum GameObjectType
@@ -35,6 +36,20 @@ enum CollisionMode
 	COLL_RECT,
 };
 
+// Broad collision categories; which layers can hit each other is declared in ObjectManager.cpp
+enum CollisionLayer
+{
+	LAYER_NONE = -1,
+
+	LAYER_PLAYER,
+	LAYER_PLAYER_PROJECTILE,
+	LAYER_ENEMY,
+	LAYER_ENEMY_PROJECTILE,
+	LAYER_DEBRIS,
+
+	LAYER_TOTAL
+};
+
 struct CollisionData
 {
 	Play3d::Vector2f extents{0.f, 0.f};
@@ -57,17 +72,21 @@ public:
 	virtual void DrawCollision() const;
 	// These virtuals have implementations and so are optional overrides
 	virtual void OnCollision( GameObject* ) {};
+	// Projectiles aren't GameObjects, so hits from the ProjectileStore arrive here instead of OnCollision
+	virtual void OnProjectileHit( GameObjectType ) {};
 
 	// Various tests on game objects
 	bool IsDestroyed() { return m_destroy; }
 	bool IsHidden() { return m_hidden; }
 	bool IsColliding(GameObject* obj);
 	bool IsOutsideOrthoView();
+	CollisionBounds GetCollisionBounds() const; // empty when the object can't currently collide
 
 	// Standard updates and destruction flagging
 	void StandardMovementUpdate();
 	void UpdateAnimation();
 	void Destroy();
+	void SnapInterpolation(); // call after teleporting so the next draw doesn't blend from the old transform
 
 	// Setters
 	void SetVelocity(Play3d::Vector3f velocity) { m_velocity = velocity; }
@@ -85,6 +104,10 @@ public:
 	Play3d::Vector3f GetVelocity() { return m_velocity; }
 	Play3d::Vector3f GetAcceleration() { return m_acceleration; }
 	Play3d::Vector3f GetRotation() { return m_rotation; }
+	float GetScale() const { return m_scale; }
+	const std::vector<CollisionData>& GetColliders() const { return m_colliders; }
+	bool CanCollide() const { return m_canCollide && m_type != TYPE_NULL; }
+	CollisionLayer GetCollisionLayer() const;
 
 protected:
 	// Mostly just adapted from Play::GameObject
@@ -99,6 +122,7 @@ protected:
 	Play3d::Vector3f m_acceleration{ 0.f, 0.f, 0.f };
 
 	Play3d::Vector3f m_rotation{ 0.f, 0.f, 0.f };
+	Play3d::Vector3f m_oldRotation{ 0.f, 0.f, 0.f };
 	Play3d::Vector3f m_rotSpeed{ 0.f, 0.f, 0.f };
 	float m_scale{1.f};
 	
@@ -112,4 +136,9 @@ protected:
 	bool m_destroy{ false };
 	bool m_hidden{ false };
 	bool m_canCollide{ true };
+
+private:
+	// Position in the manager's per-type list, maintained by GameObjectManager only
+	friend class GameObjectManager;
+	size_t m_typeListIndex{ 0 };
 };
\ No newline at end of file
@@ -0,0 +1,1237 @@
+///////////////////////////////////////////////////////////////////////////
+//	Headless boss fight: runs the game state with scripted input and no window, GPU or audio device,
+//	as fast as the CPU allows. Built by CMake with PLAY_HEADLESS defined, in place of Main.cpp.
+///////////////////////////////////////////////////////////////////////////
+
+#define PLAY_IMPLEMENTATION
+#define PLAY_USE_CLIENT_MAIN
+#include "Play3d.h"
+
+#include "FlowstateGame.h"
+#include "GameBenchmarks.h"
+#include "ObjectManager.h"
+#include "ObjectBoss.h"
+#include "ObjectPlayer.h"
+#include "ParticleEmitter.h"
+#include "ParticleKernels.h"
+#include "EmitterRegistry.h"
+#include "Random.h"
+#include "CollisionKernels.h"
+#include "Profiler.h"
+#include "ProjectileStore.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <thread>
+
+using namespace Play3d;
+
+// Long enough for any fight to finish; the run stops as soon as the game state wants to return to the menu
+static constexpr u32 DEFAULT_MAX_FRAMES{ 60 * 60 * 30 };
+
+// Script timings, in frames
+static constexpr u32 STRAFE_FRAMES{ 90 };
+static constexpr u32 BOMB_INTERVAL_FRAMES{ 60 * 20 };
+
+// The script depends only on the frame number, not on what happens in the fight
+static void ApplyScriptedInput(u32 frame)
+{
+	// Hold fire throughout, weaving left and right across the starting position
+	Input::SetKeyState(VK_SPACE, true);
+
+	u32 phase = (frame / STRAFE_FRAMES) % 4;
+	Input::SetKeyState('A', phase == 0);
+	Input::SetKeyState('D', phase == 2);
+
+	// Tap the bomb now and then to clear the screen
+	Input::SetKeyState(VK_SHIFT, frame > 0 && (frame % BOMB_INTERVAL_FRAMES) == 0);
+}
+
+// Steady-state emitter cost: each emitter bursts every tick and keeps roughly its full capacity alive, with the oldest
+// particles expiring every tick
+static void RunParticleBenchmark()
+{
+	static constexpr int BENCH_TICKS{ 600 };
+	static constexpr float BENCH_TIMESTEP{ 1.f / 60.f };
+
+	for (int capacity : { 1000, 10000, 100000, 1000000 })
+	{
+		ParticleEmitterSettings s;
+		s.particleMinVelocity = Vector3f(-1.f, -1.f, -1.f);
+		s.particleMaxVelocity = Vector3f(1.f, 1.f, 1.f);
+		s.particleLifetime = 1.f;
+		s.emitWaitMax = 0.f;
+		s.particlesPerEmit = capacity / 60;
+		s.capacity = capacity;
+
+		ParticleEmitter emitter;
+		emitter.ApplySettings(s);
+		for (int i = 0; i < 60; i++)
+		{
+			emitter.Tick(BENCH_TIMESTEP);
+		}
+
+		auto startTime = std::chrono::steady_clock::now();
+		for (int i = 0; i < BENCH_TICKS; i++)
+		{
+			emitter.Tick(BENCH_TIMESTEP);
+		}
+		f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count() / BENCH_TICKS;
+		Debug::Printf("Particles %8d: %9.4f ms/tick, %6.2f ns/particle\n", capacity, ms, ms * 1e6 / capacity);
+	}
+
+	// Integration alone on each ISA, checked bit for bit against the scalar path
+	static constexpr size_t KERNEL_COUNT{ 1000000 };
+	static constexpr int KERNEL_TICKS{ 100 };
+	std::vector<float> initial[7];
+	for (std::vector<float>& stream : initial)
+	{
+		stream.resize(KERNEL_COUNT);
+		for (float& value : stream)
+		{
+			value = RandValueInRange(-1.f, 1.f);
+		}
+	}
+
+	std::vector<float> scalarResult[7];
+	size_t scalarExpired = 0;
+	for (int isa = 0; isa <= (int)CollisionKernels::GetBestIsa(); isa++)
+	{
+		std::vector<float> streams[7];
+		std::copy(std::begin(initial), std::end(initial), std::begin(streams));
+		ParticleKernels::Streams s{ streams[0].data(), streams[1].data(), streams[2].data(), streams[3].data(), streams[4].data(), streams[5].data(), streams[6].data() };
+
+		CollisionKernels::SetIsa((CollisionKernels::Isa)isa);
+		size_t expired = 0;
+		auto startTime = std::chrono::steady_clock::now();
+		for (int i = 0; i < KERNEL_TICKS; i++)
+		{
+			expired = ParticleKernels::Integrate(s, 0, KERNEL_COUNT, BENCH_TIMESTEP, 1.f);
+		}
+		f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count() / KERNEL_TICKS;
+
+		if (isa == (int)CollisionKernels::Isa::SCALAR)
+		{
+			std::copy(std::begin(streams), std::end(streams), std::begin(scalarResult));
+			scalarExpired = expired;
+		}
+		bool bMatch = expired == scalarExpired;
+		for (int stream = 0; stream < 7; stream++)
+		{
+			bMatch = bMatch && memcmp(streams[stream].data(), scalarResult[stream].data(), KERNEL_COUNT * sizeof(float)) == 0;
+		}
+		Debug::Printf("Integrate %zu (%s): %7.4f ms, %zu expired, %s scalar\n", KERNEL_COUNT, CollisionKernels::GetIsaName((CollisionKernels::Isa)isa),
+			ms, expired, bMatch ? "matches" : "DIFFERS FROM");
+	}
+	CollisionKernels::SetIsa(CollisionKernels::GetBestIsa());
+
+	// Random values for a 10k particle burst (six per particle), one at a time and batched
+	static constexpr size_t SPAWN_VALUES{ 10000 * 6 };
+	static constexpr int SPAWN_REPEATS{ 1000 };
+	std::vector<float> values(SPAWN_VALUES);
+	Random random(1);
+	auto startTime = std::chrono::steady_clock::now();
+	for (int repeat = 0; repeat < SPAWN_REPEATS; repeat++)
+	{
+		for (float& value : values)
+		{
+			value = random.NextInRange(-1.f, 1.f);
+		}
+	}
+	f64 singleUs = std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - startTime).count() / SPAWN_REPEATS;
+	startTime = std::chrono::steady_clock::now();
+	for (int repeat = 0; repeat < SPAWN_REPEATS; repeat++)
+	{
+		random.FillInRange(values.data(), SPAWN_VALUES, -1.f, 1.f);
+	}
+	f64 batchUs = std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - startTime).count() / SPAWN_REPEATS;
+	Debug::Printf("Random values for 10k particles: %.1f us one at a time, %.1f us batched (%.2f)\n", singleUs, batchUs, values[SPAWN_VALUES / 2]);
+}
+
+// Registry throughput with many small emitters on 1 to N threads. Every thread count must produce the same particles.
+static void RunEmitterBenchmark()
+{
+	static constexpr int EMITTER_COUNT{ 1000 };
+	static constexpr int BENCH_FRAMES{ 120 };
+	static constexpr float BENCH_TIMESTEP{ 1.f / 60.f };
+
+	ParticleEmitterSettings s;
+	s.particleMinVelocity = Vector3f(-1.f, -1.f, -1.f);
+	s.particleMaxVelocity = Vector3f(1.f, 1.f, 1.f);
+	s.particleLifetime = 1.f;
+	s.emitWaitMax = 0.f;
+	s.particlesPerEmit = 17;
+	s.capacity = 1000;
+
+	u32 maxThreads = std::max(4u, std::thread::hardware_concurrency());
+	f64 singleThreadMs = 0.0;
+	f64 singleThreadChecksum = 0.0;
+	for (u32 threads = 1; threads <= maxThreads; threads++)
+	{
+		Jobs::Initialise(threads - 1);
+		EmitterRegistry::Get()->SetSeed(1);
+
+		ParticleEmitter* pEmitters = new ParticleEmitter[EMITTER_COUNT];
+		for (int i = 0; i < EMITTER_COUNT; i++)
+		{
+			pEmitters[i].ApplySettings(s);
+			pEmitters[i].m_position = Vector3f((f32)i, 0.f, 0.f);
+		}
+
+		// Half the frames fill the emitters up to a steady state, the rest are timed
+		std::chrono::steady_clock::time_point startTime;
+		for (int frame = 0; frame < BENCH_FRAMES; frame++)
+		{
+			if (frame == BENCH_FRAMES / 2)
+			{
+				startTime = std::chrono::steady_clock::now();
+			}
+			for (int i = 0; i < EMITTER_COUNT; i++)
+			{
+				pEmitters[i].QueueTick(BENCH_TIMESTEP);
+			}
+			EmitterRegistry::Get()->KickTicks();
+			EmitterRegistry::Get()->WaitTicks();
+		}
+		f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count() / (BENCH_FRAMES / 2);
+
+		size_t particles = 0;
+		f64 checksum = 0.0;
+		for (int i = 0; i < EMITTER_COUNT; i++)
+		{
+			particles += pEmitters[i].GetParticleCount();
+			for (size_t p = 0; p < pEmitters[i].GetParticleCount(); p++)
+			{
+				Vector3f pos = pEmitters[i].GetParticlePosition(p);
+				checksum += pos.x + pos.y * 3.0 + pos.z * 7.0;
+			}
+		}
+		PLAY_SAFE_DELETE_ARRAY(pEmitters);
+
+		if (threads == 1)
+		{
+			singleThreadMs = ms;
+			singleThreadChecksum = checksum;
+		}
+		Debug::Printf("Emitters %d (%zu particles), %u threads: %7.3f ms/frame, %.2fx, checksum %s\n", EMITTER_COUNT, particles, threads, ms,
+			singleThreadMs / ms, checksum == singleThreadChecksum ? "matches" : "DIFFERS");
+	}
+	Jobs::Shutdown();
+}
+
+// Submits the points in one primitive batch, by DrawPoint or written in place after ReservePoints, and returns what the
+// flush left in the vertex buffer. Each point gets its own colour so a misplaced vertex shows.
+static std::vector<Graphics::PrimitiveVertex> FlushPoints(const std::vector<Vector3f>& positions, bool bReserve)
+{
+	System::BeginFrame();
+	Graphics::BeginPrimitiveBatch();
+	if (bReserve)
+	{
+		u32 reserved = 0;
+		Graphics::PrimitiveVertex* pVertices = Graphics::ReservePoints((u32)positions.size(), reserved);
+		for (u32 i = 0; i < reserved; i++)
+		{
+			pVertices[i].position = positions[i];
+			pVertices[i].colour = ColourValue(i);
+		}
+	}
+	else
+	{
+		for (u32 i = 0; i < (u32)positions.size(); i++)
+		{
+			Graphics::DrawPoint(positions[i], ColourValue(i));
+		}
+	}
+	Graphics::EndPrimitiveBatch();
+	u32 count = 0;
+	const Graphics::PrimitiveVertex* pFlushed = Graphics::GetHeadlessPrimitiveVertices(count);
+	std::vector<Graphics::PrimitiveVertex> flushed(pFlushed, pFlushed + count);
+	System::EndFrame();
+	return flushed;
+}
+
+// Whether the flushed vertices are exactly the first count points as FlushPoints() submits them
+static bool SamePoints(const std::vector<Graphics::PrimitiveVertex>& flushed, const std::vector<Vector3f>& positions, size_t count)
+{
+	if (flushed.size() != count)
+	{
+		return false;
+	}
+	for (u32 i = 0; i < (u32)count; i++)
+	{
+		Graphics::PrimitiveVertex expected{ positions[i], ColourValue(i) };
+		if (memcmp(&flushed[i], &expected, sizeof(expected)) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// 100k points through the primitive batch, one DrawPoint call each and written in place after ReservePoints. A batch
+// holds under 64k vertices, so each frame submits two of 50k. First checks both ways flush the same vertices, also when
+// more points are asked for than the batch has room for.
+static bool RunPointBenchmark()
+{
+	static constexpr u32 POINTS_PER_BATCH{ 50000 };
+	static constexpr int BENCH_FRAMES{ 200 };
+
+	std::vector<Vector3f> positions(POINTS_PER_BATCH);
+	for (Vector3f& pos : positions)
+	{
+		pos = Vector3f(RandValueInRange(-1.f, 1.f), RandValueInRange(-1.f, 1.f), RandValueInRange(-1.f, 1.f));
+	}
+
+	System::Initialise();
+	std::vector<Vector3f> overflowPositions(positions);
+	overflowPositions.insert(overflowPositions.end(), positions.begin(), positions.end());
+	bool bPassed = SamePoints(FlushPoints(positions, false), positions, positions.size())
+		&& SamePoints(FlushPoints(positions, true), positions, positions.size());
+	Debug::Printf("%-64s %s\n", "ReservePoints flushes the same vertices as DrawPoint", bPassed ? "ok" : "FAILED");
+	std::vector<Graphics::PrimitiveVertex> drawn = FlushPoints(overflowPositions, false);
+	bool bClamped = drawn.size() < overflowPositions.size() && SamePoints(FlushPoints(overflowPositions, true), overflowPositions, drawn.size())
+		&& SamePoints(drawn, overflowPositions, drawn.size());
+	Debug::Printf("%-64s %s\n", "Clamped to the batch size: the same vertices as DrawPoint", bClamped ? "ok" : "FAILED");
+	bPassed &= bClamped;
+
+	for (int useReserve = 0; useReserve < 2; useReserve++)
+	{
+		u64 verticesBefore = Graphics::GetHeadlessStats().m_primitiveVertexCount;
+		auto startTime = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < BENCH_FRAMES; frame++)
+		{
+			System::BeginFrame();
+			for (int batch = 0; batch < 2; batch++)
+			{
+				Graphics::BeginPrimitiveBatch();
+				if (useReserve)
+				{
+					u32 reserved = 0;
+					Graphics::PrimitiveVertex* pVertices = Graphics::ReservePoints(POINTS_PER_BATCH, reserved);
+					for (u32 i = 0; i < reserved; i++)
+					{
+						pVertices[i].position = positions[i];
+						pVertices[i].colour = Colour::White;
+					}
+				}
+				else
+				{
+					for (const Vector3f& pos : positions)
+					{
+						Graphics::DrawPoint(pos, Colour::White);
+					}
+				}
+				Graphics::EndPrimitiveBatch();
+			}
+			System::EndFrame();
+		}
+		f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count() / BENCH_FRAMES;
+		u64 vertices = (Graphics::GetHeadlessStats().m_primitiveVertexCount - verticesBefore) / BENCH_FRAMES;
+		Debug::Printf("%-13s %llu points: %.3f ms/frame including flush\n", useReserve ? "ReservePoints" : "DrawPoint", (unsigned long long)vertices, ms);
+	}
+	System::Shutdown();
+	return bPassed;
+}
+
+// Every model in the assets folder, parsed from OBJ with no cache (which writes one) and then loaded from that cache
+static void RunMeshCacheBenchmark()
+{
+	static constexpr int BENCH_REPEATS{ 20 };
+
+	System::Initialise();
+	f64 totalColdMs = 0.0;
+	f64 totalWarmMs = 0.0;
+	for (const auto& entry : std::filesystem::directory_iterator("../Assets/Models"))
+	{
+		if (entry.path().extension() != ".obj")
+		{
+			continue;
+		}
+		std::string objPath = entry.path().string();
+		std::string cachePath = objPath + ".p3m";
+
+		f64 timeMs[2] = {};
+		for (int warm = 0; warm < 2; warm++)
+		{
+			for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+			{
+				if (!warm)
+				{
+					std::filesystem::remove(cachePath);
+				}
+				auto startTime = std::chrono::steady_clock::now();
+				Graphics::MeshId meshId = Graphics::CreateMeshFromObjFile(objPath.c_str(), Colour::White, 0.25f);
+				timeMs[warm] += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+				Resources::ResourceManager<Graphics::Mesh>::Instance().Release(meshId);
+			}
+			timeMs[warm] /= BENCH_REPEATS;
+		}
+		totalColdMs += timeMs[0];
+		totalWarmMs += timeMs[1];
+		Debug::Printf("%-32s %8.3f ms parse+save  %8.3f ms cached  %6.1fx\n", entry.path().filename().string().c_str(), timeMs[0], timeMs[1],
+			timeMs[0] / timeMs[1]);
+	}
+	Debug::Printf("%-32s %8.3f ms parse+save  %8.3f ms cached  %6.1fx\n", "Total", totalColdMs, totalWarmMs, totalColdMs / totalWarmMs);
+	System::Shutdown();
+}
+
+// Average cache misses per triangle for a FIFO post-transform cache; 0.5 is the floor for a regular grid, 3 is no reuse
+static f64 GetAcmr(const std::vector<u32>& indices, u32 cacheSize)
+{
+	std::deque<u32> cache;
+	u32 misses = 0;
+	for (u32 index : indices)
+	{
+		if (std::find(cache.begin(), cache.end(), index) == cache.end())
+		{
+			++misses;
+			cache.push_back(index);
+			if (cache.size() > cacheSize)
+			{
+				cache.pop_front();
+			}
+		}
+	}
+	return indices.empty() ? 0.0 : (f64)misses / (indices.size() / 3);
+}
+
+// Vertex and index memory for every model in the assets folder, as parsed and after welding and reordering, and the
+// time each step takes
+static void RunMeshWeldBenchmark()
+{
+	static constexpr int BENCH_REPEATS{ 20 };
+	static constexpr u32 ACMR_CACHE_SIZE{ 16 };
+	static constexpr size_t VERTEX_BYTES{ sizeof(Vector3f) * 2 + sizeof(Vector2f) + sizeof(u32) };
+
+	Debug::Printf("%-26s %17s %17s %11s %10s %10s\n", "Model", "vertex bytes", "index bytes", "ACMR", "parse ms", "weld+opt ms");
+	size_t totalBefore = 0;
+	size_t totalAfter = 0;
+	for (const auto& entry : std::filesystem::directory_iterator("../Assets/Models"))
+	{
+		if (entry.path().extension() != ".obj")
+		{
+			continue;
+		}
+		size_t fileSize = 0;
+		char* pObj = (char*)System::LoadFileData(entry.path().string().c_str(), fileSize);
+		std::string_view obj(pObj, fileSize);
+
+		f64 parseMs = 0.0;
+		f64 optimiseMs = 0.0;
+		Graphics::MeshBuilder builder;
+		size_t vertexBytes[2] = {};
+		size_t indexBytes[2] = {};
+		f64 acmr[2] = {};
+		for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+		{
+			builder.Reset();
+			auto startTime = std::chrono::steady_clock::now();
+			builder.ParseObjFormat(obj, Colour::White, 0.25f);
+			auto parsedTime = std::chrono::steady_clock::now();
+			vertexBytes[0] = builder.GetVertexCount() * VERTEX_BYTES;
+			indexBytes[0] = builder.GetIndices().size() * sizeof(u32);
+			acmr[0] = GetAcmr(builder.GetIndices(), ACMR_CACHE_SIZE);
+
+			auto optimiseStartTime = std::chrono::steady_clock::now();
+			builder.WeldVertices();
+			builder.OptimiseVertexCache();
+			auto endTime = std::chrono::steady_clock::now();
+			parseMs += std::chrono::duration<f64, std::milli>(parsedTime - startTime).count();
+			optimiseMs += std::chrono::duration<f64, std::milli>(endTime - optimiseStartTime).count();
+			vertexBytes[1] = builder.GetVertexCount() * VERTEX_BYTES;
+			indexBytes[1] = builder.GetIndices().size() * builder.GetIndexStride();
+			acmr[1] = GetAcmr(builder.GetIndices(), ACMR_CACHE_SIZE);
+		}
+		System::ReleaseFileData(pObj);
+
+		totalBefore += vertexBytes[0] + indexBytes[0];
+		totalAfter += vertexBytes[1] + indexBytes[1];
+		Debug::Printf("%-26s %8zu -> %6zu %8zu -> %6zu %4.2f->%4.2f %10.3f %10.3f\n", entry.path().filename().string().c_str(),
+			vertexBytes[0], vertexBytes[1], indexBytes[0], indexBytes[1], acmr[0], acmr[1], parseMs / BENCH_REPEATS, optimiseMs / BENCH_REPEATS);
+	}
+	Debug::Printf("Total %zu -> %zu bytes (%.1f%% of the original)\n", totalBefore, totalAfter, 100.0 * totalAfter / totalBefore);
+}
+
+// The line-at-a-time parser MeshBuilder::ParseObjFormat() replaced, kept to check the chunked one against
+static void ParseObjReference(Graphics::MeshBuilder& rBuilder, std::string_view objString, ColourValue colour, f32 fScale)
+{
+	std::vector<Vector3f> positions;
+	std::vector<Vector2f> texCoords;
+	std::vector<Vector3f> normals;
+
+	static constexpr u32 kMaxFaceVerts = 4;
+	Vector3f facePositions[kMaxFaceVerts];
+	Vector3f faceNormals[kMaxFaceVerts];
+	Vector2f faceUVs[kMaxFaceVerts];
+	ColourValue faceColours[kMaxFaceVerts];
+	for (u32 i = 0; i < kMaxFaceVerts; ++i)
+	{
+		faceColours[i] = colour;
+	}
+
+	std::vector<std::string_view> args;
+	size_t pos = 0;
+	size_t offset = objString.find_first_of('\n', pos);
+	while (offset != std::string_view::npos)
+	{
+		args.clear();
+		std::string_view line = objString.substr(pos, offset - pos);
+		size_t argLen = line.find_first_of(' ', 0);
+		while (argLen != std::string_view::npos)
+		{
+			args.push_back(line.substr(0, argLen));
+			line.remove_prefix(argLen + 1);
+			argLen = line.find_first_of(' ', 0);
+		}
+		if (!line.empty())
+		{
+			args.push_back(line);
+		}
+
+		if (args.size() > 3 && "v" == args[0])
+		{
+			Vector3f v(0.f, 0.f, 0.f);
+			std::from_chars(args[1].data(), args[1].data() + args[1].size(), v.x);
+			std::from_chars(args[2].data(), args[2].data() + args[2].size(), v.y);
+			std::from_chars(args[3].data(), args[3].data() + args[3].size(), v.z);
+			positions.push_back(v);
+		}
+		else if (args.size() > 3 && "vn" == args[0])
+		{
+			Vector3f v(0.f, 0.f, 0.f);
+			std::from_chars(args[1].data(), args[1].data() + args[1].size(), v.x);
+			std::from_chars(args[2].data(), args[2].data() + args[2].size(), v.y);
+			std::from_chars(args[3].data(), args[3].data() + args[3].size(), v.z);
+			normals.push_back(v);
+		}
+		else if (args.size() > 2 && "vt" == args[0])
+		{
+			Vector2f v(0.f, 0.f);
+			std::from_chars(args[1].data(), args[1].data() + args[1].size(), v.x);
+			std::from_chars(args[2].data(), args[2].data() + args[2].size(), v.y);
+			texCoords.push_back(v);
+		}
+		else if (args.size() > 3 && "f" == args[0])
+		{
+			u32 nFaceVerts = (u32)args.size() - 1;
+			PLAY_ASSERT(nFaceVerts <= kMaxFaceVerts);
+			for (u32 i = 0; i < nFaceVerts; ++i)
+			{
+				const std::string_view& rArg(args[i + 1]);
+				std::string_view indexArg[3];
+				size_t t0 = rArg.find_first_of('/', 0);
+				if (t0 != std::string_view::npos)
+				{
+					size_t t1 = rArg.find_first_of('/', t0 + 1);
+					indexArg[0] = rArg.substr(0, t0);
+					if (t1 != std::string_view::npos)
+					{
+						indexArg[1] = rArg.substr(t0 + 1, t1);
+						indexArg[2] = rArg.substr(t1 + 1);
+					}
+					else
+					{
+						indexArg[1] = rArg.substr(t0 + 1);
+					}
+				}
+				else
+				{
+					indexArg[0] = rArg;
+				}
+
+				u32 indices[3] = { 0, 0, 0 };
+				for (u32 j = 0; j < 3 && !indexArg[0].empty(); ++j)
+				{
+					std::from_chars(indexArg[j].data(), indexArg[j].data() + indexArg[j].size(), indices[j]);
+				}
+				facePositions[i] = indices[0] ? positions.at(indices[0] - 1) * fScale : Vector3f(0, 0, 0);
+				faceUVs[i] = indices[1] ? texCoords.at(indices[1] - 1) : Vector2f(0, 0);
+				faceNormals[i] = indices[2] ? normals.at(indices[2] - 1) : Vector3f(0, 0, 0);
+			}
+			rBuilder.AddFace(nFaceVerts, facePositions, faceColours, faceNormals, faceUVs);
+		}
+
+		pos = offset + 1;
+		offset = objString.find_first_of('\n', pos);
+	}
+}
+
+template<typename T>
+static bool SameBits(const std::vector<T>& a, const std::vector<T>& b)
+{
+	return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+// Parses every model in the assets folder with the reference parser and the chunked one at several worker counts,
+// checks the builders match bit for bit and reports the throughput of each
+static void RunObjParserBenchmark()
+{
+	static constexpr int BENCH_REPEATS{ 20 };
+	static constexpr u32 WORKER_COUNTS[] = { 0, 3, 7 };
+
+	std::vector<std::pair<std::string, std::string>> files;
+	size_t totalBytes = 0;
+	for (const auto& entry : std::filesystem::directory_iterator("../Assets/Models"))
+	{
+		if (entry.path().extension() == ".obj")
+		{
+			size_t fileSize = 0;
+			void* pData = System::LoadFileData(entry.path().string().c_str(), fileSize);
+			files.emplace_back(entry.path().filename().string(), std::string((const char*)pData, fileSize));
+			System::ReleaseFileData(pData);
+			totalBytes += fileSize;
+		}
+	}
+
+	// Debug::Printf reports every parse, so the results are gathered and printed at the end
+	std::vector<std::string> report;
+	char line[256];
+	bool bAllMatch = true;
+	for (int variant = -1; variant < (int)std::size(WORKER_COUNTS); variant++)
+	{
+		if (variant >= 0)
+		{
+			Jobs::Initialise(WORKER_COUNTS[variant]);
+		}
+
+		f64 totalMs = 0.0;
+		for (const auto& file : files)
+		{
+			Graphics::MeshBuilder reference;
+			ParseObjReference(reference, file.second, Colour::White, 0.25f);
+
+			Graphics::MeshBuilder builder;
+			auto startTime = std::chrono::steady_clock::now();
+			for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+			{
+				builder.Reset();
+				if (variant < 0)
+				{
+					ParseObjReference(builder, file.second, Colour::White, 0.25f);
+				}
+				else
+				{
+					builder.ParseObjFormat(file.second, Colour::White, 0.25f);
+				}
+			}
+			totalMs += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count() / BENCH_REPEATS;
+
+			bool bMatch = SameBits(builder.GetPositions(), reference.GetPositions()) && SameBits(builder.GetNormals(), reference.GetNormals())
+				&& SameBits(builder.GetUVs(), reference.GetUVs()) && SameBits(builder.GetColours(), reference.GetColours())
+				&& SameBits(builder.GetIndices(), reference.GetIndices());
+			if (!bMatch)
+			{
+				snprintf(line, sizeof(line), "  %s DIFFERS from the reference parser\n", file.first.c_str());
+				report.push_back(line);
+				bAllMatch = false;
+			}
+		}
+
+		if (variant < 0)
+		{
+			snprintf(line, sizeof(line), "Reference parser:      %7.2f MB/s\n", totalBytes / (totalMs * 1000.0));
+		}
+		else
+		{
+			snprintf(line, sizeof(line), "Chunked, %u workers:    %7.2f MB/s\n", WORKER_COUNTS[variant], totalBytes / (totalMs * 1000.0));
+		}
+		report.push_back(line);
+	}
+	Jobs::Shutdown();
+
+	for (const std::string& rLine : report)
+	{
+		Debug::Printf("%s", rLine.c_str());
+	}
+	Debug::Printf("%zu models, %.2f MB: %s\n", files.size(), totalBytes / 1e6, bAllMatch ? "all match the reference parser" : "MISMATCH");
+}
+
+// Main thread time spent entering the game state, with its asset pack loaded from scratch or prefetched the way the
+// menu does it: started up front and finished off a little each frame
+static void RunEnterStateBenchmark(bool bPrefetch)
+{
+	static constexpr auto MENU_FRAME_TIME{ std::chrono::milliseconds(16) };
+
+	System::Initialise();
+
+	u32 menuFrames = 0;
+	f64 worstMenuFrameMs = 0.0;
+	f64 prefetchMs = 0.0;
+	if (bPrefetch)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+		IdKey<Resources::AsyncLoadingTask> assets = Resources::AsyncLoadAssets(FlowstateGame::ASSET_PACK);
+		for (;;)
+		{
+			auto frameStartTime = std::chrono::steady_clock::now();
+			bool bLoaded = Resources::AssetsLoaded(assets);
+			worstMenuFrameMs = std::max(worstMenuFrameMs, std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - frameStartTime).count());
+			++menuFrames;
+			if (bLoaded)
+			{
+				break;
+			}
+			std::this_thread::sleep_until(frameStartTime + MENU_FRAME_TIME);
+		}
+		prefetchMs = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+	FlowstateGame stateGame;
+	stateGame.EnterState();
+	f64 enterMs = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	if (bPrefetch)
+	{
+		Debug::Printf("Prefetch: %.3f ms over %u menu frames, worst frame %.3f ms on the main thread\n", prefetchMs, menuFrames, worstMenuFrameMs);
+	}
+	Debug::Printf("EnterState %s: %.3f ms\n", bPrefetch ? "after prefetch" : "from scratch", enterMs);
+	stateGame.ExitState();
+}
+
+// Checks the shader cache key changes with every compile input, then times each game shader's compile with an empty
+// cache and again once it is filled. There is no HLSL compiler here, so the cold numbers are only the cache's overhead.
+static void RunShaderCacheBenchmark()
+{
+	static const char* SHADER_PATHS[] = { "..\\Assets\\Shaders\\PlayerPellet.hlsl", "..\\Assets\\Shaders\\BossPellet.hlsl", "..\\Assets\\Shaders\\HUD.hlsl" };
+
+	std::vector<Graphics::ShaderCompilerDesc> descs;
+	for (const char* pPath : SHADER_PATHS)
+	{
+		size_t size = 0;
+		const char* pHlsl = (const char*)System::LoadFileData(pPath, size);
+		if (!pHlsl)
+		{
+			Debug::Printf("%s not found\n", pPath);
+			return;
+		}
+
+		Graphics::ShaderCompilerDesc desc;
+		desc.m_name = pPath;
+		desc.m_flags = (u32)Graphics::ShaderCompilationFlags::DEBUG;
+		desc.m_hlslCode = std::string(pHlsl, size);
+		desc.m_sourcePath = pPath;
+		desc.m_defines.push_back({ "MAX_LIGHTS", "4" });
+		System::ReleaseFileData(const_cast<char*>(pHlsl));
+
+		desc.m_type = Graphics::ShaderType::VERTEX_SHADER;
+		desc.m_entryPoint = "VS_Main";
+		descs.push_back(desc);
+		desc.m_type = Graphics::ShaderType::PIXEL_SHADER;
+		desc.m_entryPoint = "PS_Main";
+		descs.push_back(desc);
+	}
+
+	// Each input on its own must give a new key
+	const Graphics::ShaderCompilerDesc& rBase = descs[0];
+	std::vector<Graphics::ShaderCompilerDesc> variants(7, rBase);
+	variants[1].m_hlslCode += " ";
+	variants[2].m_defines[0].Definition = "3";
+	variants[3].m_entryPoint = "PS_Main";
+	variants[4].m_flags = 0;
+	variants[5].m_type = Graphics::ShaderType::PIXEL_SHADER;
+	variants[6].m_sourcePath = "..\\Elsewhere\\PlayerPellet.hlsl";
+	bool bKeysOk = Graphics::GetShaderCacheKey(variants[0]) == Graphics::GetShaderCacheKey(rBase);
+	for (size_t i = 1; i < variants.size(); i++)
+	{
+		bKeysOk = bKeysOk && Graphics::GetShaderCacheKey(variants[i]) != Graphics::GetShaderCacheKey(rBase);
+	}
+	Debug::Printf("Cache key: %s\n", bKeysOk ? "changes with source, source path, defines, entry point, flags and stage" : "MISSED AN INPUT");
+
+	std::filesystem::remove_all(Graphics::kShaderCacheDirectory);
+	f64 totalMs[2] = {};
+	bool bRoundTripOk = true;
+	for (const Graphics::ShaderCompilerDesc& rDesc : descs)
+	{
+		std::vector<u8> byteCode[2];
+		f64 ms[2];
+		for (int run = 0; run < 2; run++)
+		{
+			auto startTime = std::chrono::steady_clock::now();
+			Graphics::CompileShaderByteCode(rDesc, byteCode[run]);
+			ms[run] = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			totalMs[run] += ms[run];
+		}
+		bRoundTripOk = bRoundTripOk && !byteCode[0].empty() && byteCode[0] == byteCode[1];
+		Debug::Printf("%-40s %s %8.3f ms cold %8.3f ms warm\n", rDesc.m_name.c_str(), rDesc.m_entryPoint.c_str(), ms[0], ms[1]);
+	}
+	Debug::Printf("%-48s %8.3f ms cold %8.3f ms warm, cached bytecode %s\n", "Total", totalMs[0], totalMs[1], bRoundTripOk ? "matches" : "DIFFERS");
+
+	// Editing an included file leaves the shader's own source, and so its key, as it was; the cache must still miss
+	std::filesystem::path includeDir = std::filesystem::temp_directory_path() / "Play3dShaderInclude";
+	std::filesystem::create_directories(includeDir);
+	std::string includePath = (includeDir / "Common.hlsli").string();
+	Graphics::ShaderCompilerDesc includer = rBase;
+	includer.m_hlslCode = "#include \"Common.hlsli\"\n" + includer.m_hlslCode;
+	includer.m_sourcePath = (includeDir / "Includer.hlsl").string();
+	static const char* INCLUDE_VERSIONS[] = { "static const float kScale = 1.0;\n", "static const float kScale = 1.0;\n", "static const float kScale = 2.0;\n" };
+	std::vector<u8> includerByteCode[3];
+	for (int run = 0; run < 3; run++)
+	{
+		System::SaveFileData(includePath.c_str(), INCLUDE_VERSIONS[run], strlen(INCLUDE_VERSIONS[run]));
+		Graphics::CompileShaderByteCode(includer, includerByteCode[run]);
+	}
+	std::filesystem::remove_all(includeDir);
+	bool bIncludesOk = !includerByteCode[0].empty() && includerByteCode[1] == includerByteCode[0] && includerByteCode[2] != includerByteCode[0];
+	Debug::Printf("Includes: %s\n", bIncludesOk ? "an edited include misses the cache" : "STALE BYTECODE FROM AN EDITED INCLUDE");
+}
+
+// A stand-in resource: a small object which, like a mesh or texture, owns a block of heap data made when it is created
+struct BenchResource
+{
+	explicit BenchResource(u32 value) : m_data(256) { m_values[0] = value; }
+	u32 m_values[8] = {};
+	std::vector<u8> m_data;
+};
+
+// Resource lookup throughput, walking the ids in creation order and shuffled, after churning the free list. A few
+// thousand resources stay in cache however they are stored; many more show how far apart the objects are.
+static void RunResourceLookupBenchmark(u32 resourceCount)
+{
+	static constexpr u32 BENCH_LOOKUPS{ 1u << 20 };
+	static constexpr u32 BENCH_RUNS{ 10 };
+	const u32 passes = BENCH_LOOKUPS / resourceCount;
+
+	Resources::ResourceManager<BenchResource>& rManager = Resources::ResourceManager<BenchResource>::Instance();
+	std::vector<IdKey<BenchResource>> ids;
+	for (u32 i = 0; i < resourceCount; i++)
+	{
+		ids.push_back(rManager.Create(i));
+	}
+	IdKey<BenchResource> staleId = ids[0];
+	for (u32 i = 0; i < resourceCount; i += 3)
+	{
+		rManager.Release(ids[i]);
+		ids[i] = rManager.Create(i);
+	}
+	Debug::Printf("Released id: %s\n", rManager.IsAlive(staleId) ? "STILL ALIVE" : "rejected");
+
+	std::vector<IdKey<BenchResource>> shuffled(ids);
+	Random random(7);
+	for (u32 i = resourceCount - 1; i > 0; i--)
+	{
+		std::swap(shuffled[i], shuffled[random.NextU32() % (i + 1)]);
+	}
+
+	const std::vector<IdKey<BenchResource>>* orders[] = { &ids, &shuffled };
+	const char* orderNames[] = { "In order", "Shuffled" };
+	for (int order = 0; order < 2; order++)
+	{
+		// Best of several runs, as other work on the machine only ever adds time
+		u64 sum = 0;
+		f64 bestNs = 0.0;
+		for (u32 run = 0; run < BENCH_RUNS; run++)
+		{
+			auto startTime = std::chrono::steady_clock::now();
+			for (u32 pass = 0; pass < passes; pass++)
+			{
+				for (IdKey<BenchResource> id : *orders[order])
+				{
+					sum += rManager.GetPtr(id)->m_values[0];
+				}
+			}
+			f64 ns = std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+			bestNs = run == 0 ? ns : std::min(bestNs, ns);
+		}
+		Debug::Printf("%6u resources, %-8s %6.2f ns per GetPtr (checksum %llu)\n", resourceCount, orderNames[order], bestNs / ((f64)passes * resourceCount),
+			(unsigned long long)sum);
+	}
+	rManager.ReleaseAll();
+}
+
+// Mesh bindings and draw calls for one frame of a crowded fight: 2000 pellets among asteroids, bombs and debris. Drawn
+// one object at a time in creation order, then through the mesh queue as DrawAll() does, which instances each run of
+// the same material and mesh. Every draw used to make all the bindings.
+static void RunDrawStateBenchmark()
+{
+	static constexpr u32 BOSS_PELLETS{ 1600 };
+	static constexpr u32 PLAYER_PELLETS{ 400 };
+	static constexpr u32 OBJECT_ROUNDS{ 12 };
+	static constexpr u32 BENCH_FRAMES{ 20 };
+	static constexpr GameObjectType OBJECT_TYPES[] = { TYPE_ASTEROID, TYPE_BOSS_BOMB, TYPE_BOSS_CHUNK_CORE, TYPE_PLAYER_CHUNK_WING_L };
+
+	System::Initialise();
+	FlowstateGame stateGame;
+	stateGame.EnterState();
+
+	GameObjectManager* pObjs = GetObjectManager();
+	std::vector<GameObject*> objects = { pObjs->GetPlayer(), pObjs->GetBoss() };
+	Random random(5);
+	for (u32 round = 0; round < OBJECT_ROUNDS; round++)
+	{
+		for (GameObjectType type : OBJECT_TYPES)
+		{
+			Vector3f pos(random.NextInRange(-GetGameHalfWidth(), GetGameHalfWidth()), random.NextInRange(-GetGameHalfHeight(), GetGameHalfHeight()), 0.f);
+			objects.push_back(pObjs->CreateObject(type, pos));
+		}
+	}
+	ProjectileStore* pProjectiles = pObjs->GetProjectiles();
+	for (u32 i = 0; i < BOSS_PELLETS + PLAYER_PELLETS; i++)
+	{
+		Vector2f pos(random.NextInRange(-GetGameHalfWidth(), GetGameHalfWidth()), random.NextInRange(-GetGameHalfHeight(), GetGameHalfHeight()));
+		pProjectiles->Spawn(i < BOSS_PELLETS ? OWNER_BOSS : OWNER_PLAYER, pos, Vector2f(0.f, 0.f));
+	}
+
+	const Graphics::HeadlessStats& stats = Graphics::GetHeadlessStats();
+	// Bindings are the same every frame; the time is the best of several frames
+	for (int bQueued = 0; bQueued <= 1; bQueued++)
+	{
+		Graphics::HeadlessStats frameStats{};
+		f64 bestMs = 0.0;
+		for (u32 frame = 0; frame < BENCH_FRAMES; frame++)
+		{
+			System::BeginFrame();
+			Graphics::BeginPrimitiveBatch();
+			Graphics::HeadlessStats startStats = stats;
+			auto startTime = std::chrono::steady_clock::now();
+			if (bQueued)
+			{
+				pObjs->DrawAll();
+			}
+			else
+			{
+				for (GameObject* pObj : objects)
+				{
+					pObj->Draw();
+				}
+				pProjectiles->DrawAll();
+			}
+			f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			bestMs = frame == 0 ? ms : std::min(bestMs, ms);
+			frameStats.m_meshDrawCount = stats.m_meshDrawCount - startStats.m_meshDrawCount;
+			frameStats.m_materialChangeCount = stats.m_materialChangeCount - startStats.m_materialChangeCount;
+			frameStats.m_meshBindCount = stats.m_meshBindCount - startStats.m_meshBindCount;
+			frameStats.m_redundantMeshBindCount = stats.m_redundantMeshBindCount - startStats.m_redundantMeshBindCount;
+			frameStats.m_instancedDrawCount = stats.m_instancedDrawCount - startStats.m_instancedDrawCount;
+			frameStats.m_instanceCount = stats.m_instanceCount - startStats.m_instanceCount;
+			Graphics::EndPrimitiveBatch();
+			System::EndFrame();
+		}
+
+		// Nothing is instanced in creation order, so every mesh is a draw of its own there
+		if (!bQueued)
+		{
+			Debug::Printf("%llu mesh draws, %llu bindings when every draw makes them all\n", (unsigned long long)frameStats.m_meshDrawCount,
+				(unsigned long long)(frameStats.m_meshBindCount + frameStats.m_redundantMeshBindCount));
+		}
+		Debug::Printf("%-16s %5llu draw calls (%llu instanced, %5llu instances), %5llu bindings, %4llu material changes, %.3f ms to submit\n",
+			bQueued ? "Mesh queue" : "Creation order", (unsigned long long)frameStats.m_meshDrawCount,
+			(unsigned long long)frameStats.m_instancedDrawCount, (unsigned long long)frameStats.m_instanceCount,
+			(unsigned long long)frameStats.m_meshBindCount, (unsigned long long)frameStats.m_materialChangeCount, bestMs);
+	}
+	stateGame.ExitState();
+}
+
+// Each instance holds its transform, and a normal matrix whose transpose undoes the transform's upper 3x3 so that normals
+// stay perpendicular to the transformed surface
+static bool SameInstanceData(const std::vector<Graphics::InstanceData>& instances, const Matrix4x4f* pTransforms, size_t count)
+{
+	if (instances.size() != count)
+	{
+		return false;
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		const Graphics::InstanceData& instance = instances[i];
+		if (memcmp(&instance.worldMtx, &pTransforms[i], sizeof(Matrix4x4f)) != 0)
+		{
+			return false;
+		}
+		Matrix3x3f product = Transpose(instance.normalMtx.Upper3x3()) * pTransforms[i].Upper3x3();
+		for (u32 c = 0; c < 3; c++)
+		{
+			for (u32 r = 0; r < 3; r++)
+			{
+				if (fabsf(product.m[c][r] - (c == r ? 1.f : 0.f)) > 1e-4f || instance.normalMtx.m[3][r] != 0.f)
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static constexpr AssetPath INSTANCING_SHADER_PATH{ "..\\Assets\\Shaders\\BossPellet.hlsl" };
+
+// Checks how the mesh queue groups draws into instanced runs and what it packs into the instance buffer: three
+// materials, one without an instanced vertex shader, drawn interleaved across two meshes
+static bool RunInstancingCheck()
+{
+	static constexpr u32 DRAWS{ 60 };
+	static constexpr u32 MATERIALS{ 3 };
+	static constexpr u32 MESHES{ 2 };
+	static constexpr u32 FULL_QUEUE{ 1u << 20 }; // draws the mesh queue's sort key can order
+
+	System::Initialise();
+	GameObjectManager* pObjs = GetObjectManager();
+	Graphics::MaterialId materials[MATERIALS] = {
+		pObjs->GetMaterial(),
+		pObjs->GetMaterialHLSL(INSTANCING_SHADER_PATH),
+		Resources::CreateAsset<Graphics::Material>(Graphics::ComplexMaterialDesc{}),
+	};
+	Graphics::MeshId meshes[MESHES] = { Graphics::CreateMeshCube(1.f), Graphics::CreateMeshBox(1.f, 2.f, 3.f) };
+	std::vector<Matrix4x4f> transforms;
+	for (u32 i = 0; i < DRAWS; i++)
+	{
+		// Rotated and non-uniformly scaled, so the normal matrix differs from the transform
+		transforms.push_back(MatrixTranslate<f32>((f32)i, 0.f, 0.f) * MatrixRotationY<f32>(0.1f * i) * MatrixScale<f32>(1.f, 2.f, 0.5f));
+	}
+
+	const Graphics::HeadlessStats& stats = Graphics::GetHeadlessStats();
+	bool bPassed = true;
+	auto check = [&bPassed](bool bOk, const char* pWhat)
+	{
+		Debug::Printf("%-64s %s\n", pWhat, bOk ? "ok" : "FAILED");
+		bPassed &= bOk;
+	};
+
+	// One instanced draw per material and mesh, except the last material's draws which go one at a time
+	System::BeginFrame();
+	Graphics::HeadlessStats startStats = stats;
+	Graphics::BeginMeshQueue();
+	for (u32 i = 0; i < DRAWS; i++)
+	{
+		Graphics::SetMaterial(materials[i % MATERIALS]);
+		Graphics::DrawMesh(meshes[(i / MATERIALS) % MESHES], transforms[i]);
+	}
+	Graphics::EndMeshQueue();
+	System::EndFrame();
+	u32 plainDraws = DRAWS / MATERIALS;
+	u32 instancedRuns = (MATERIALS - 1) * MESHES;
+	check(stats.m_meshDrawCount - startStats.m_meshDrawCount == instancedRuns + plainDraws, "Draw calls: one per instanced run, one per uninstanced draw");
+	check(stats.m_instancedDrawCount - startStats.m_instancedDrawCount == instancedRuns, "Instanced draw calls: one per material and mesh");
+	check(stats.m_instanceCount - startStats.m_instanceCount == DRAWS - plainDraws, "Instances: every draw of a material with an instanced shader");
+
+	// Only one instanced run, so the instance buffer holds its transforms in the order they were queued
+	System::BeginFrame();
+	std::vector<Matrix4x4f> runTransforms;
+	Graphics::BeginMeshQueue();
+	for (u32 i = 0; i < DRAWS; i++)
+	{
+		bool bInstanced = i % 2 == 0;
+		Graphics::SetMaterial(materials[bInstanced ? 0 : 2]);
+		Graphics::DrawMesh(meshes[0], transforms[i]);
+		if (bInstanced)
+		{
+			runTransforms.push_back(transforms[i]);
+		}
+	}
+	Graphics::EndMeshQueue();
+	System::EndFrame();
+	check(SameInstanceData(Graphics::GetHeadlessInstanceData(), runTransforms.data(), runTransforms.size()), "Queued run: world and normal matrices in queue order");
+
+	// A queue which outgrows its sort key is drawn in two parts as it fills, the second holding the last draws
+	System::BeginFrame();
+	startStats = stats;
+	Graphics::BeginMeshQueue();
+	Graphics::SetMaterial(materials[0]);
+	for (u32 i = 0; i < FULL_QUEUE + DRAWS; i++)
+	{
+		Graphics::DrawMesh(meshes[0], transforms[i < FULL_QUEUE ? 0 : i - FULL_QUEUE]);
+	}
+	Graphics::EndMeshQueue();
+	System::EndFrame();
+	check(stats.m_instancedDrawCount - startStats.m_instancedDrawCount == 2, "Overfull queue: one instanced draw per part");
+	check(stats.m_instanceCount - startStats.m_instanceCount == FULL_QUEUE + DRAWS, "Overfull queue: every draw drawn once");
+	check(SameInstanceData(Graphics::GetHeadlessInstanceData(), transforms.data(), transforms.size()), "Overfull queue: the last part holds the draws after the first");
+
+	// And outside the queue, a direct call
+	System::BeginFrame();
+	Graphics::SetMaterial(materials[1]);
+	Graphics::DrawMeshInstanced(meshes[1], transforms.data(), DRAWS);
+	System::EndFrame();
+	check(SameInstanceData(Graphics::GetHeadlessInstanceData(), transforms.data(), transforms.size()), "DrawMeshInstanced(): world and normal matrices of the transforms");
+
+	Debug::Printf("Instancing check %s\n", bPassed ? "passed" : "FAILED");
+	return bPassed;
+}
+
+// What each asset the packs loaded cost, slowest first
+static void PrintAssetLoadTimes()
+{
+	std::vector<Resources::AssetLoadTime> times = Resources::GetAssetLoadTimes();
+	std::sort(times.begin(), times.end(), [](const Resources::AssetLoadTime& a, const Resources::AssetLoadTime& b)
+	{
+		return a.m_loadMs + a.m_createMs > b.m_loadMs + b.m_createMs;
+	});
+	Debug::Printf("%-48s %10s %10s\n", "Asset", "load ms", "create ms");
+	for (const Resources::AssetLoadTime& rTime : times)
+	{
+		Debug::Printf("%-48s %10.3f %10.3f\n", rTime.m_path.c_str(), rTime.m_loadMs, rTime.m_createMs);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	u32 maxFrames = DEFAULT_MAX_FRAMES;
+	bool bDraw = true;
+	bool bAssetTimes = false;
+	const char* pTracePath = nullptr;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--no-draw") == 0)
+		{
+			bDraw = false;
+		}
+		else if (IsGameBenchmark(argv[i]))
+		{
+			System::Initialise();
+			bool bPassed = RunGameBenchmark(argv[i]);
+			System::Shutdown();
+			return bPassed ? 0 : 1;
+		}
+		else if (strcmp(argv[i], "--bench-particles") == 0)
+		{
+			RunParticleBenchmark();
+			return 0;
+		}
+		else if (strcmp(argv[i], "--bench-emitters") == 0)
+		{
+			RunEmitterBenchmark();
+			return 0;
+		}
+		else if (strcmp(argv[i], "--bench-points") == 0)
+		{
+			return RunPointBenchmark() ? 0 : 1;
+		}
+		else if (strcmp(argv[i], "--bench-meshes") == 0)
+		{
+			RunMeshCacheBenchmark();
+			return 0;
+		}
+		else if (strcmp(argv[i], "--bench-mesh-weld") == 0)
+		{
+			RunMeshWeldBenchmark();
+			return 0;
+		}
+		else if (strcmp(argv[i], "--bench-obj-parser") == 0)
+		{
+			RunObjParserBenchmark();
+			return 0;
+		}
+		else if (strcmp(argv[i], "--bench-shader-cache") == 0)
+		{
+			RunShaderCacheBenchmark();
+			return 0;
+		}
+		else if (strcmp(argv[i], "--bench-draw-state") == 0)
+		{
+			RunDrawStateBenchmark();
+			return 0;
+		}
+		else if (strcmp(argv[i], "--check-instancing") == 0)
+		{
+			return RunInstancingCheck() ? 0 : 1;
+		}
+		else if (strcmp(argv[i], "--bench-resources") == 0)
+		{
+			RunResourceLookupBenchmark(4096);
+			RunResourceLookupBenchmark(65536);
+			return 0;
+		}
+		else if (strcmp(argv[i], "--bench-enter") == 0 && i + 1 < argc)
+		{
+			RunEnterStateBenchmark(strcmp(argv[++i], "prefetch") == 0);
+			return 0;
+		}
+		else if (strcmp(argv[i], "--asset-times") == 0)
+		{
+			bAssetTimes = true;
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			pTracePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			u32 seed = (u32)strtoul(argv[++i], nullptr, 10);
+			SetSimSeed(seed); // EnterState() seeds the emitters from this too
+		}
+		else
+		{
+			maxFrames = (u32)strtoul(argv[i], nullptr, 10);
+		}
+	}
+
+	System::Initialise();
+
+	FlowstateGame stateGame;
+	stateGame.EnterState();
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	u32 frame = 0;
+	eFlowstates nextState = eFlowstates::STATE_NULL;
+	while (frame < maxFrames && nextState == eFlowstates::STATE_NULL)
+	{
+		ApplyScriptedInput(frame);
+
+		PROFILE_BEGIN_FRAME();
+		System::BeginFrame();
+		{
+			PROFILE_SCOPE(PROFILE_STATE_UPDATE);
+			nextState = stateGame.Update();
+		}
+		if (bDraw)
+		{
+			PROFILE_SCOPE(PROFILE_STATE_DRAW);
+			stateGame.Draw();
+		}
+		else
+		{
+			// Draw() is normally the join point for the particle jobs
+			EmitterRegistry::Get()->WaitTicks();
+		}
+		{
+			PROFILE_SCOPE(PROFILE_PRESENT);
+			System::EndFrame();
+		}
+		PROFILE_END_FRAME();
+
+		frame++;
+	}
+
+	f64 seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - startTime).count();
+
+	GameObjectManager* pObjs = GetObjectManager();
+	ObjectBoss* pBoss = static_cast<ObjectBoss*>(pObjs->GetBoss());
+	bool bBossAlive = pBoss && pBoss->IsAlive();
+	bool bPlayerDead = static_cast<ObjectPlayer*>(pObjs->GetPlayer())->IsGameOver();
+	const char* pOutcome = !bBossAlive ? "boss defeated" : (bPlayerDead ? "player defeated" : "unfinished");
+
+	const Graphics::HeadlessStats& stats = Graphics::GetHeadlessStats();
+	Debug::Printf("Outcome: %s after %u frames, %u sim ticks (%.1fs of game time)\n", pOutcome, frame, GetSimTickCount(), GetSimElapsedTime());
+	Debug::Printf("Wall time: %.3fs, %.0f ticks/s (%.1fx real time)\n", seconds, GetSimTickCount() / seconds, GetSimElapsedTime() / seconds);
+	Debug::Printf("Submitted: %llu mesh draws, %llu material changes, %llu primitive batches (%llu vertices), %llu text draws\n",
+		(unsigned long long)stats.m_meshDrawCount, (unsigned long long)stats.m_materialChangeCount,
+		(unsigned long long)stats.m_primitiveBatchCount, (unsigned long long)stats.m_primitiveVertexCount,
+		(unsigned long long)stats.m_textDrawCount);
+	Debug::Printf("Mesh bindings: %.1f per frame, %.1f redundant ones left out\n", (f64)stats.m_meshBindCount / frame,
+		(f64)stats.m_redundantMeshBindCount / frame);
+	Debug::Printf("Instancing: %llu of the mesh draws drew %llu instances\n", (unsigned long long)stats.m_instancedDrawCount,
+		(unsigned long long)stats.m_instanceCount);
+	const AssetRegistryStats& registryStats = pObjs->GetAssetRegistryStats();
+	Debug::Printf("Assets: %zu preloaded from packs, %d hitches, %d registry hits, %d misses\n", Resources::GetAssetLoadTimes().size(),
+		pObjs->GetAssetHitchCount(), registryStats.hits, registryStats.misses);
+	if (bAssetTimes)
+	{
+		PrintAssetLoadTimes();
+	}
+
+	Profiler::Get()->PrintSummary();
+	if (pTracePath)
+	{
+		Profiler::Get()->WriteChromeTrace(pTracePath);
+	}
+
+	stateGame.ExitState();
+	System::Shutdown();
+	Profiler::Destroy();
+
+	return (nextState != eFlowstates::STATE_NULL) ? 0 : 1;
+}
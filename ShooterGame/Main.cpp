@@ -10,6 +10,8 @@
 #include "FlowstateMachine.h"
 #include "FlowstateMenu.h"
 #include "FlowstateGame.h"
+#include "GameBenchmarks.h"
+#include "Profiler.h"
 
 // Play3d uses namespaces for each area of code.
 // The top level namespace is Play3d
@@ -20,6 +22,17 @@ int PlayMain()
 	// First we initialise the Play3d library.
 	System::Initialise();
 
+	// A benchmark flag on the command line runs that benchmark in place of the game
+	for (int i = 1; i < __argc; i++)
+	{
+		if (IsGameBenchmark(__argv[i]))
+		{
+			bool bPassed = RunGameBenchmark(__argv[i]);
+			System::Shutdown();
+			return bPassed ? 0 : 1;
+		}
+	}
+
 	//////////////////////////////////////
 	// create + register states
 	//////////////////////////////////////
@@ -38,6 +51,8 @@ int PlayMain()
 	bool bKeepGoing = true;
 	while (bKeepGoing)
 	{
+		PROFILE_BEGIN_FRAME();
+
 		// BeginFrame should be called first, it will return RESULT_QUIT if the user has quit via 'Close' icons.
 		if (System::BeginFrame() != RESULT_OK || Input::IsKeyPressed(VK_ESCAPE))
 		{
@@ -47,11 +62,17 @@ int PlayMain()
 		states.Update();
 
 		// Finally we signal the framework to finish the frame.
-		System::EndFrame();
+		{
+			PROFILE_SCOPE(PROFILE_PRESENT);
+			System::EndFrame();
+		}
+
+		PROFILE_END_FRAME();
 	}
 
 	// Make sure to shutdown the library before we end our main function.
 	System::Shutdown();
+	Profiler::Destroy();
 
 	return 0;
 };
@@ -7,13 +7,16 @@ static constexpr float POS_Y{0.f};
 static constexpr float POS_Z{0.f};
 static constexpr float ROT_FORWARD{kfHalfPi * 0.75f};
 
-MenuShip::MenuShip()
+static constexpr AssetPath MESH_PATH{ "..\\Assets\\Models\\_fighter.obj" };
+static constexpr AssetPath TEXTURE_PATH{ "..\\Assets\\Models\\_fighter-blue.jpg" };
+
+void MenuShip::LoadAssets()
 {
 	GameObjectManager* pObjs{ GetObjectManager() };
 
 	// Load and assign player mesh/mat
-	m_mesh = pObjs->GetMesh("..\\Assets\\Models\\_fighter.obj");
-	m_mat = pObjs->GetMaterial("..\\Assets\\Models\\_fighter-blue.jpg");
+	m_mesh = pObjs->GetMesh(MESH_PATH);
+	m_mat = pObjs->GetMaterial(TEXTURE_PATH);
 }
 
 void MenuShip::Update()
@@ -4,7 +4,8 @@
 class MenuShip
 {
 public:
-	MenuShip();
+	// After the menu's asset pack is loaded
+	void LoadAssets();
 
 	void Update();
 	void Draw();
@@ -3,16 +3,17 @@
 using namespace Play3d;
 
 static constexpr float MAX_WOBBLE{kfPi};
+static constexpr AssetPath MESH_PATH{ "..\\Assets\\Models\\asteroid.obj" };
 
 ObjectAsteroid::ObjectAsteroid(Play3d::Vector3f position) : GameObject(TYPE_BOSS, position)
 {
-	m_meshId = GetObjectManager()->GetMesh("..\\Assets\\Models\\asteroid.obj");
+	m_meshId = GetObjectManager()->GetMesh(MESH_PATH);
 	m_materialId = GetObjectManager()->GetMaterial();
 }
 
 void ObjectAsteroid::Update()
 {
-	float elapsedTime = System::GetElapsedTime();
+	float elapsedTime = GetSimElapsedTime();
 
 	m_rotation.x = sin(elapsedTime * 0.33f) * MAX_WOBBLE;
 	m_rotation.y = sin(elapsedTime * 0.5f) * MAX_WOBBLE;
@@ -2,6 +2,7 @@
 #include "ObjectManager.h"
 #include "GameHud.h"
 #include "ObjectPlayer.h"
+#include "ProjectileStore.h"
 
 #include "ObjectBossBomb.h"
 #include "AttackPatternA.h"
@@ -22,6 +23,13 @@ static constexpr float CANNON_OFFSET_Y{-2.5f};
 
 static constexpr int SFX_LIMIT_PELLETS{5}; // max of 5 simultaneous audio signals per frame
 
+static constexpr AssetPath MESH_PATH{ "..\\Assets\\Models\\_station.obj" };
+static constexpr AssetPath TEXTURE_PATH{ "..\\Assets\\Models\\_station-red.jpg" };
+static constexpr AssetPath FIRE_PELLET_SFX_PATHS[]{ "..\\Assets\\Audio\\BossPellet1.wav", "..\\Assets\\Audio\\BossPellet2.wav", "..\\Assets\\Audio\\BossPellet3.wav" };
+static constexpr AssetPath FIRE_BOMB_SFX_PATH{ "..\\Assets\\Audio\\BossBomb1.wav" };
+static constexpr AssetPath DAMAGE_SFX_PATHS[]{ "..\\Assets\\Audio\\Damage1.wav", "..\\Assets\\Audio\\Damage2.wav", "..\\Assets\\Audio\\Damage3.wav" };
+static constexpr AssetPath WIN_SFX_PATH{ "..\\Assets\\Audio\\GameWin.wav" };
+
 AttackPatternA patternRadialBursts;
 AttackPatternB patternTripleBomb;
 AttackPatternC patternPachinko;
@@ -33,15 +41,15 @@ ObjectBoss::ObjectBoss(Play3d::Vector3f position) : GameObject(TYPE_BOSS, positi
 {
 	// Get resources
 	GameObjectManager* pObj{GetObjectManager()};
-	m_meshId = pObj->GetMesh("..\\Assets\\Models\\_station.obj");
-	m_materialId = pObj->GetMaterial("..\\Assets\\Models\\_station-red.jpg");
-	m_sfxFirePellet[0] = pObj->GetAudioId("..\\Assets\\Audio\\BossPellet1.wav");
-	m_sfxFirePellet[1] = pObj->GetAudioId("..\\Assets\\Audio\\BossPellet2.wav");
-	m_sfxFirePellet[2] = pObj->GetAudioId("..\\Assets\\Audio\\BossPellet3.wav");
-	m_sfxFireBomb[0] = pObj->GetAudioId("..\\Assets\\Audio\\BossBomb1.wav");
-	m_sfxDamage[0] = pObj->GetAudioId("..\\Assets\\Audio\\Damage1.wav");
-	m_sfxDamage[1] = pObj->GetAudioId("..\\Assets\\Audio\\Damage2.wav");
-	m_sfxDamage[2] = pObj->GetAudioId("..\\Assets\\Audio\\Damage3.wav");
+	m_meshId = pObj->GetMesh(MESH_PATH);
+	m_materialId = pObj->GetMaterial(TEXTURE_PATH);
+	m_sfxFirePellet[0] = pObj->GetAudioId(FIRE_PELLET_SFX_PATHS[0]);
+	m_sfxFirePellet[1] = pObj->GetAudioId(FIRE_PELLET_SFX_PATHS[1]);
+	m_sfxFirePellet[2] = pObj->GetAudioId(FIRE_PELLET_SFX_PATHS[2]);
+	m_sfxFireBomb[0] = pObj->GetAudioId(FIRE_BOMB_SFX_PATH);
+	m_sfxDamage[0] = pObj->GetAudioId(DAMAGE_SFX_PATHS[0]);
+	m_sfxDamage[1] = pObj->GetAudioId(DAMAGE_SFX_PATHS[1]);
+	m_sfxDamage[2] = pObj->GetAudioId(DAMAGE_SFX_PATHS[2]);
 	m_vMultishotRequests.reserve(4);
 
 	// Gateway
@@ -70,12 +78,6 @@ ObjectBoss::ObjectBoss(Play3d::Vector3f position) : GameObject(TYPE_BOSS, positi
 	RegisterAttackPattern(&patternBlockDivider, eAttackPhase::PHASE_F);
 	m_phase = eAttackPhase::PHASE_A;
 	m_phases[m_phase]->Start(this);
-
-	// Ensure boss chunks are preloaded to avoid lag on first death
-	pObj->GetMesh("..\\Assets\\Models\\_station-chunk-core.obj");
-	pObj->GetMesh("..\\Assets\\Models\\_station-chunk-left.obj");
-	pObj->GetMesh("..\\Assets\\Models\\_station-chunk-right.obj");
-	pObj->GetMesh("..\\Assets\\Models\\_station-chunk-lower.obj");
 }
 
 void ObjectBoss::ActivateAttackPattern(eAttackPhase newPhase)
@@ -109,7 +111,7 @@ void ObjectBoss::Update()
 		m_sfxPelletsThisFrame = 0;
 
 		// ship wobble anim
-		float elapsedTime = System::GetElapsedTime();
+		float elapsedTime = GetSimElapsedTime();
 		//m_pos.x = sin(elapsedTime / 4) * POS_LIMIT_X;
 		m_rotation.x = sin(elapsedTime * 2) * WOBBLE_STRENGTH / 2;
 		m_rotation.y = cos(elapsedTime) * WOBBLE_STRENGTH;
@@ -149,7 +151,7 @@ void ObjectBoss::UpdateAttackPattern()
 
 void ObjectBoss::UpdateAutocannon()
 {
-	m_autocannonTimer -= Play3d::System::GetDeltaTime();
+	m_autocannonTimer -= GetSimDeltaTime();
 	if (m_autocannonTimer <= 0.f)
 	{
 		FireAtPlayer();
@@ -170,7 +172,7 @@ void ObjectBoss::UpdateMultishot()
 	{
 		MultishotRequest& r{m_vMultishotRequests[i]};
 
-		r.timer -= Play3d::System::GetDeltaTime();
+		r.timer -= GetSimDeltaTime();
 		if (r.timer <= 0.f)
 		{
 			FireAtPlayer(r.angleOffset);
@@ -200,8 +202,7 @@ void ObjectBoss::FirePellet(Play3d::Vector2f origin, float angle, float velocity
 		velocity = CANNON_SHOTSPEED;
 	}
 
-	GameObject* pObj = GetObjectManager()->CreateObject(TYPE_BOSS_PELLET, Vector3f(origin.x, origin.y, 0.f));
-	pObj->SetVelocity(Vector3f(sin(angle), cos(angle), 0.f) * velocity);
+	GetObjectManager()->GetProjectiles()->Spawn(OWNER_BOSS, origin, Vector2f(sin(angle), cos(angle)) * velocity);
 	AudioPellet();
 }
 
@@ -287,9 +288,9 @@ void ObjectBoss::AudioDamage()
 	Audio::PlaySound(m_sfxDamage[sfxId], 0.25f);
 }
 
-void ObjectBoss::OnCollision(GameObject* other)
+void ObjectBoss::OnProjectileHit(GameObjectType projectileType)
 {
-	if (other->GetObjectType() == GameObjectType::TYPE_PLAYER_PELLET)
+	if (projectileType == GameObjectType::TYPE_PLAYER_PELLET)
 	{
 		AudioDamage();
 		GameHud::Get()->SetBossBarPercent((f32)(m_health - 1) / BOSS_MAX_HEALTH);
@@ -329,7 +330,7 @@ void ObjectBoss::Die()
 	SetHidden(true);
 	Destroy();
 
-	Audio::PlaySound(GetObjectManager()->GetAudioId("..\\Assets\\Audio\\GameWin.wav"), 3.5f);
+	Audio::PlaySound(GetObjectManager()->GetAudioId(WIN_SFX_PATH), 3.5f);
 }
 
 void ObjectBoss::Draw() const
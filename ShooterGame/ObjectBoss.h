@@ -18,7 +18,7 @@ public:
 	void ActivateAttackPattern(eAttackPhase pattern);
 	void Update() override;
 	void Draw() const override;
-	void OnCollision(GameObject* other) override;
+	void OnProjectileHit(GameObjectType projectileType) override;
 	void Die();
 	bool IsAlive() {return m_health > 0;};
 
@@ -1,11 +1,17 @@
 #include "ObjectBossBomb.h"
 #include "ObjectManager.h"
+#include "ProjectileStore.h"
 using namespace Play3d;
 
-ObjectBossBomb::ObjectBossBomb(Play3d::Vector3f position) : GameObject(TYPE_BOSS_PELLET, position)
+// Bombs are created and burst throughout the fight, so their asset paths are hashed at compile time
+static constexpr AssetPath MESH_PATH{ "..\\Assets\\Models\\pelletEnemy.obj" };
+static constexpr AssetPath SHADER_PATH{ "..\\Assets\\Shaders\\BossPellet.hlsl" };
+static constexpr AssetPath BURST_SFX_PATH{ "..\\Assets\\Audio\\BombExplode.wav" };
+
+ObjectBossBomb::ObjectBossBomb(Play3d::Vector3f position) : GameObject(TYPE_BOSS_BOMB, position)
 {
-	m_meshId = GetObjectManager()->GetMesh("..\\Assets\\Models\\pelletEnemy.obj");
-	m_materialId = GetObjectManager()->GetMaterialHLSL("..\\Assets\\Shaders\\BossPellet.hlsl");
+	m_meshId = GetObjectManager()->GetMesh(MESH_PATH);
+	m_materialId = GetObjectManager()->GetMaterialHLSL(SHADER_PATH);
 
 	m_scale = 2.f;
 	m_colliders[0].radius = 0.15f;
@@ -13,7 +19,7 @@ ObjectBossBomb::ObjectBossBomb(Play3d::Vector3f position) : GameObject(TYPE_BOSS
 
 void ObjectBossBomb::Update()
 {
-	m_detonationTimer -= Play3d::System::GetDeltaTime();
+	m_detonationTimer -= GetSimDeltaTime();
 	if (m_detonationTimer <= 0.f)
 	{
 		Burst();
@@ -34,11 +40,9 @@ void ObjectBossBomb::Burst()
 
 	float rotIncrement{kfTwoPi / m_fragmentTotal};
 
-	GameObjectManager* pObjs{GetObjectManager()};
+	ProjectileStore* pProjectiles{GetObjectManager()->GetProjectiles()};
 	for (int i = 0; i < m_fragmentTotal; i++)
 	{
-		GameObject* pPellet = pObjs->CreateObject(TYPE_BOSS_PELLET, m_pos);
-
 		float x = sin(i * rotIncrement);
 		float y = cos(i * rotIncrement);
 		if (fabs(y) < std::numeric_limits<float>::epsilon())
@@ -49,11 +53,10 @@ void ObjectBossBomb::Burst()
 		{
 			x = 0.f;
 		}
-		Vector3f direction{x, y, 0.f};
+		Vector2f direction{x, y};
 
-		pPellet->SetVelocity(direction * 0.05f);
-		pPellet->SetHidden(false);
+		pProjectiles->Spawn(OWNER_BOSS, m_pos.xy(), direction * 0.05f);
 	}
 
-	Audio::PlaySound(GetObjectManager()->GetAudioId("..\\Assets\\Audio\\BombExplode.wav"));
+	Audio::PlaySound(GetObjectManager()->GetAudioId(BURST_SFX_PATH));
 }
\ No newline at end of file
@@ -3,12 +3,44 @@
 
 // Needs to know about all the object types so it can create them
 #include "ObjectPlayer.h"
-#include "ObjectPellet.h"
 #include "ObjectBoss.h"
-#include "ObjectBossPellet.h"
 #include "ObjectBossBomb.h"
 #include "ObjectAsteroid.h"
 #include "ObjectShipChunk.h"
+#include "ProjectileStore.h"
+#include "Profiler.h"
+
+// Slab capacity for pooled bombs, sized for the densest attack patterns (see GetPoolStats for tuning)
+static constexpr size_t POOL_CAPACITY_BOSS_BOMB{32};
+
+// Broadphase grid cell size in world units; a few pellet diameters, and the largest ships only span a handful of cells
+static constexpr float COLLISION_CELL_SIZE{1.f};
+
+// Which layers each layer can collide with. Only pairs with an OnCollision response are listed, and the table
+// must be symmetric since each layer pair is only visited once.
+static constexpr Play3d::u32 LayerBit(CollisionLayer layer) { return 1u << layer; }
+static constexpr Play3d::u32 s_layerMasks[LAYER_TOTAL]
+{
+	LayerBit(LAYER_ENEMY) | LayerBit(LAYER_ENEMY_PROJECTILE),	// LAYER_PLAYER
+	LayerBit(LAYER_ENEMY),										// LAYER_PLAYER_PROJECTILE
+	LayerBit(LAYER_PLAYER) | LayerBit(LAYER_PLAYER_PROJECTILE),	// LAYER_ENEMY
+	LayerBit(LAYER_PLAYER),										// LAYER_ENEMY_PROJECTILE
+	0,															// LAYER_DEBRIS
+};
+
+static constexpr bool IsLayerMaskSymmetric()
+{
+	for (int a = 0; a < LAYER_TOTAL; a++)
+	{
+		for (int b = 0; b < LAYER_TOTAL; b++)
+		{
+			if (((s_layerMasks[a] >> b) & 1u) != ((s_layerMasks[b] >> a) & 1u))
+				return false;
+		}
+	}
+	return true;
+}
+static_assert(IsLayerMaskSymmetric(), "s_layerMasks must be symmetric");
 
 // A global pointer to a GameObjectManager instance (not delared/visible outside of this compilation unit)
 GameObjectManager* g_pObjMan = nullptr;
@@ -34,12 +66,21 @@ void DestroyObjectManager()
 // The class implmentations for GameObjectManager continue from here
 // **************************************************************************************************
 
+GameObjectManager::GameObjectManager()
+{
+	m_pProjectiles = new ProjectileStore();
+	m_pBossBombPool = new ObjectPool<ObjectBossBomb>(POOL_CAPACITY_BOSS_BOMB);
+}
+
 GameObjectManager::~GameObjectManager()
 {
 	for( int i = 0; i < m_pGameObjectList.size(); i++ )
-		delete m_pGameObjectList[ i ];
+		FreeObject( m_pGameObjectList[ i ] );
 
 	m_pGameObjectList.clear();
+
+	PLAY_SAFE_DELETE(m_pProjectiles);
+	PLAY_SAFE_DELETE(m_pBossBombPool);
 }
 
 // This is a factory pattern which decouples the creation of specific object types from their class implementations
@@ -55,20 +96,12 @@ GameObject* GameObjectManager::CreateObject(GameObjectType objType, Play3d::Vect
 		pNewObj = new ObjectPlayer(pos);
 		break;
 
-	case TYPE_PLAYER_PELLET:
-		pNewObj = new ObjectPellet(pos);
-		break;
-
 	case TYPE_BOSS:
 		pNewObj = new ObjectBoss(pos);
 		break;
 
-	case TYPE_BOSS_PELLET:
-		pNewObj = new ObjectBossPellet(pos);
-		break;
-
 	case TYPE_BOSS_BOMB:
-		pNewObj = new ObjectBossBomb(pos);
+		pNewObj = m_pBossBombPool->Acquire(pos);
 		break;
 
 	case TYPE_ASTEROID:
@@ -87,146 +120,316 @@ GameObject* GameObjectManager::CreateObject(GameObjectType objType, Play3d::Vect
 	}
 
 	if( pNewObj != nullptr )
-		GetObjectManager()->RegisterGameObject( pNewObj );
+		RegisterGameObject( pNewObj );
 
 	PLAY_ASSERT(pNewObj);
 	return pNewObj;
 }
 
-Play3d::Graphics::MeshId GameObjectManager::GetMesh(const char* filepath)
+void GameObjectManager::RegisterGameObject(GameObject* obj)
+{
+	PLAY_ASSERT_MSG(obj->GetObjectType() != TYPE_NULL, "Registering an object with no type");
+	m_pGameObjectList.push_back( obj );
+
+	std::vector<GameObject*>& typeList = m_pTypeLists[ obj->GetObjectType() ];
+	obj->m_typeListIndex = typeList.size();
+	typeList.push_back( obj );
+}
+
+// O(1) removal from the per-type list by moving the last object of that type into the gap
+void GameObjectManager::UnregisterFromType(GameObject* obj)
+{
+	std::vector<GameObject*>& typeList = m_pTypeLists[ obj->GetObjectType() ];
+	PLAY_ASSERT(typeList[ obj->m_typeListIndex ] == obj);
+
+	GameObject* pLast = typeList.back();
+	typeList[ obj->m_typeListIndex ] = pLast;
+	pLast->m_typeListIndex = obj->m_typeListIndex;
+	typeList.pop_back();
+}
+
+// Returns an object to whichever slab it was acquired from, or the heap if it was never pooled (or overflowed)
+void GameObjectManager::FreeObject(GameObject* obj)
+{
+	// The boss is destroyed when it dies, so don't leave the game state holding a dangling pointer
+	if (obj == m_pBoss)
+		m_pBoss = nullptr;
+	if (obj == m_pPlayer)
+		m_pPlayer = nullptr;
+
+	if (m_pBossBombPool->Owns(obj))
+		m_pBossBombPool->Release(static_cast<ObjectBossBomb*>(obj));
+	else
+		delete obj;
+}
+
+ObjectPoolStats GameObjectManager::GetPoolStats(GameObjectType objType) const
 {
-	if (m_meshRegister.count(filepath) == 0)
+	switch (objType)
 	{
-		m_meshRegister.insert(std::pair<const char*, Play3d::Graphics::MeshId>(
-			filepath,
-			Play3d::Graphics::CreateMeshFromObjFile(filepath, Play3d::Colour::White, 0.25f)
-		));
+	case TYPE_BOSS_BOMB:
+		return m_pBossBombPool->GetStats();
+	default:
+		return ObjectPoolStats();
 	}
-	return m_meshRegister.at(filepath);
 }
 
-Play3d::Audio::SoundId GameObjectManager::GetAudioId(const char* filepath)
+void GameObjectManager::PreloadAssets(const char* packPath)
 {
-	if (m_audioRegister.count(filepath) == 0)
+	if (Play3d::Resources::LoadAssets(packPath) != Play3d::RESULT_OK)
 	{
-		m_audioRegister.insert(std::pair<const char*, Play3d::Audio::SoundId>(
-			filepath,
-			Play3d::Audio::LoadSoundFromFile(filepath)
-		));
+		Play3d::Debug::Printf("Asset pack %s didn't fully load\n", packPath);
 	}
-	return m_audioRegister.at(filepath);
+	m_bAssetsPreloaded = true;
 }
 
-Play3d::Graphics::MaterialId GameObjectManager::GetMaterial(const char* filepath)
+// A load from file mid-game stalls the frame, so once the flowstate's pack is in every one is logged
+void GameObjectManager::ReportAssetHitch(const char* filepath, std::chrono::steady_clock::time_point loadStart)
 {
-	if (m_materialRegister.count(filepath) == 0)
+	if (m_bAssetsPreloaded)
 	{
-		Play3d::Graphics::SimpleMaterialDesc desc;
-		desc.m_state.m_cullMode = Play3d::Graphics::CullMode::BACK;
-		desc.m_state.m_fillMode = Play3d::Graphics::FillMode::SOLID;
-		Play3d::Colour::White.as_float_rgba_srgb(&desc.m_constants.diffuseColour.x);
-		desc.m_bEnableLighting = true;
-		desc.m_lightCount = 3;
+		m_assetHitchCount++;
+		float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+		Play3d::Debug::Printf("Asset hitch: %s isn't in the asset pack, loading it took %.2f ms\n", filepath, ms);
+	}
+}
 
-		if (filepath != "")
+// Asset packs name their resources by path, so anything already loaded by one is used as is
+Play3d::Graphics::TextureId GameObjectManager::GetTexture(const char* filepath)
+{
+	Play3d::Graphics::TextureId textureId = Play3d::Resources::FindAsset<Play3d::Graphics::Texture>(filepath);
+	if (!textureId.IsValid())
+	{
+		auto loadStart = std::chrono::steady_clock::now();
+		textureId = Play3d::Graphics::CreateTextureFromFile(filepath);
+		if (textureId.IsValid())
 		{
-			desc.m_texture[0] = Play3d::Graphics::CreateTextureFromFile(filepath);
-			desc.m_sampler[0] = Play3d::Graphics::CreateLinearSampler();
+			ReportAssetHitch(filepath, loadStart);
 		}
+		else
+		{
+			Play3d::Debug::Printf("Texture %s not found\n", filepath);
+		}
+	}
+	return textureId;
+}
 
-		m_materialRegister.insert(std::pair<const char*, Play3d::Graphics::MaterialId>(
-			filepath,
-			Play3d::Resources::CreateAsset<Play3d::Graphics::Material>(desc)
-		));
+const GameObjectManager::AssetRegistryEntry* GameObjectManager::FindRegistered(AssetKey key, const AssetPath& path, const AssetPath& variant)
+{
+	auto it = m_assetRegistry.find(key.GetValue());
+	if (it == m_assetRegistry.end())
+	{
+		m_assetRegistryStats.misses++;
+		return nullptr;
+	}
+	// Keys are hashes, so two paths can share one. The later path is then loaded each time rather than given the other's asset.
+	if (!AssetPath::IsSamePath(it->second.path.c_str(), path.path) || !AssetPath::IsSamePath(it->second.variant.c_str(), variant.path))
+	{
+		Play3d::Debug::Printf("Asset key collision between %s and %s\n", it->second.path.c_str(), path.path);
+		m_assetRegistryStats.misses++;
+		return nullptr;
+	}
+	m_assetRegistryStats.hits++;
+	return &it->second;
+}
 
+// Failed loads are registered too, so a missing file is only tried once
+void GameObjectManager::Register(AssetKey key, const AssetPath& path, const AssetPath& variant, Play3d::u32 id)
+{
+	m_assetRegistry.insert({ key.GetValue(), AssetRegistryEntry{ id, path.path, variant.path } });
+}
+
+Play3d::Graphics::MeshId GameObjectManager::GetMesh(const AssetPath& filepath)
+{
+	AssetKey key(ASSET_MESH, filepath);
+	if (const AssetRegistryEntry* pEntry = FindRegistered(key, filepath))
+	{
+		return Play3d::Graphics::MeshId(pEntry->id);
+	}
+
+	Play3d::Graphics::MeshId meshId = Play3d::Resources::FindAsset<Play3d::Graphics::Mesh>(filepath.path);
+	if (!meshId.IsValid())
+	{
+		auto loadStart = std::chrono::steady_clock::now();
+		meshId = Play3d::Graphics::CreateMeshFromObjFile(filepath.path, Play3d::Colour::White, 0.25f);
+		ReportAssetHitch(filepath.path, loadStart);
+	}
+	Register(key, filepath, "", meshId.GetValue());
+	return meshId;
+}
+
+Play3d::Audio::SoundId GameObjectManager::GetAudioId(const AssetPath& filepath)
+{
+	AssetKey key(ASSET_SOUND, filepath);
+	if (const AssetRegistryEntry* pEntry = FindRegistered(key, filepath))
+	{
+		return Play3d::Audio::SoundId(pEntry->id);
 	}
 
-	return m_materialRegister.at(filepath);
+	Play3d::Audio::SoundId soundId = Play3d::Resources::FindAsset<Play3d::Audio::Sound>(filepath.path);
+	if (!soundId.IsValid())
+	{
+		auto loadStart = std::chrono::steady_clock::now();
+		soundId = Play3d::Audio::LoadSoundFromFile(filepath.path);
+		ReportAssetHitch(filepath.path, loadStart);
+	}
+	Register(key, filepath, "", soundId.GetValue());
+	return soundId;
 }
 
-Play3d::Graphics::MaterialId GameObjectManager::GetMaterialHLSL(const char* hlslPath, const char* texturePath)
+Play3d::Graphics::MaterialId GameObjectManager::GetMaterial(const AssetPath& filepath)
 {
-	static const int bufferSize{80};
-	char buffer[bufferSize];
-	strcpy_s(buffer, bufferSize, hlslPath);
-	strcat_s(buffer, bufferSize, texturePath);
+	AssetKey key(ASSET_MATERIAL, filepath);
+	if (const AssetRegistryEntry* pEntry = FindRegistered(key, filepath))
+	{
+		return Play3d::Graphics::MaterialId(pEntry->id);
+	}
+
+	Play3d::Graphics::SimpleMaterialDesc desc;
+	desc.m_state.m_cullMode = Play3d::Graphics::CullMode::BACK;
+	desc.m_state.m_fillMode = Play3d::Graphics::FillMode::SOLID;
+	Play3d::Colour::White.as_float_rgba_srgb(&desc.m_constants.diffuseColour.x);
+	desc.m_bEnableLighting = true;
+	desc.m_lightCount = 3;
 
-	if(m_materialRegister.count(buffer) == 0)
+	if (!filepath.IsEmpty())
 	{
-		using namespace Play3d;
+		desc.m_texture[0] = GetTexture(filepath.path);
+		desc.m_sampler[0] = Play3d::Graphics::CreateLinearSampler();
+	}
+
+	Play3d::Graphics::MaterialId materialId = Play3d::Resources::CreateAsset<Play3d::Graphics::Material>(desc);
+	Register(key, filepath, "", materialId.GetValue());
+	return materialId;
+}
 
+Play3d::Graphics::MaterialId GameObjectManager::GetMaterialHLSL(const AssetPath& hlslPath, const AssetPath& texturePath)
+{
+	AssetKey key(ASSET_MATERIAL_HLSL, hlslPath, texturePath);
+	if (const AssetRegistryEntry* pEntry = FindRegistered(key, hlslPath, texturePath))
+	{
+		return Play3d::Graphics::MaterialId(pEntry->id);
+	}
+
+	using namespace Play3d;
+
+	// Asset packs compile the shaders of a file under these names. Compiled bytecode is cached on disk by the engine,
+	// so a shader missing from the pack is still only compiled once across runs.
+	std::string vertexShaderName = std::string(hlslPath.path) + "_VS";
+	std::string pixelShaderName = std::string(hlslPath.path) + "_PS";
+	std::string instancedVertexShaderName = std::string(hlslPath.path) + "_VSI";
+	Graphics::ShaderId customVertexShader = Resources::FindAsset<Graphics::Shader>(vertexShaderName);
+	Graphics::ShaderId customPixelShader = Resources::FindAsset<Graphics::Shader>(pixelShaderName);
+	Graphics::ShaderId customInstancedVertexShader = Resources::FindAsset<Graphics::Shader>(instancedVertexShaderName);
+
+	if (!customVertexShader.IsValid() || !customPixelShader.IsValid())
+	{
+		auto loadStart = std::chrono::steady_clock::now();
 		size_t fileSizeBytes;
-		const char* hlslCode = (const char*)System::LoadFileData(hlslPath, fileSizeBytes);
+		const char* hlslCode = (const char*)System::LoadFileData(hlslPath.path, fileSizeBytes);
 		PLAY_ASSERT_MSG(hlslCode, "Could not load the shader file");
 
-		char shaderName[64];
-
-		Graphics::ShaderId customVertexShader;
 		{
-			sprintf_s(shaderName, 64, "%s_VS", hlslPath);
 			Graphics::ShaderCompilerDesc compilerOptions = {};
-			compilerOptions.m_name = shaderName;
+			compilerOptions.m_name = vertexShaderName;
 			compilerOptions.m_type = Graphics::ShaderType::VERTEX_SHADER;
 			compilerOptions.m_flags = (u32)Graphics::ShaderCompilationFlags::DEBUG;
 			compilerOptions.m_hlslCode = hlslCode;
+			compilerOptions.m_sourcePath = hlslPath.path;
 			compilerOptions.m_entryPoint = "VS_Main";
 			compilerOptions.m_defines.push_back({ "MAX_LIGHTS", "4" });
 			customVertexShader = Graphics::Shader::Compile(compilerOptions);
 			PLAY_ASSERT_MSG(customVertexShader.IsValid(), "Vertex Shader Compilation Failed!");
 		}
 
-		Graphics::ShaderId customPixelShader;
 		{
-			sprintf_s(shaderName, 64, "%s_PS", hlslPath);
 			Graphics::ShaderCompilerDesc compilerOptions = {};
-			compilerOptions.m_name = shaderName;
+			compilerOptions.m_name = pixelShaderName;
 			compilerOptions.m_type = Graphics::ShaderType::PIXEL_SHADER;
 			compilerOptions.m_flags = (u32)Graphics::ShaderCompilationFlags::DEBUG;
 			compilerOptions.m_hlslCode = hlslCode;
+			compilerOptions.m_sourcePath = hlslPath.path;
 			compilerOptions.m_entryPoint = "PS_Main";
 			compilerOptions.m_defines.push_back({ "MAX_LIGHTS", "4" });
 			customPixelShader = Graphics::Shader::Compile(compilerOptions);
-			PLAY_ASSERT_MSG(customVertexShader.IsValid(), "Pixel Shader Compilation Failed!");
+			PLAY_ASSERT_MSG(customPixelShader.IsValid(), "Pixel Shader Compilation Failed!");
 		}
 
-		System::ReleaseFileData(const_cast<char*>(hlslCode));
+		// Optional, without it the material's meshes are drawn one at a time
+		if (std::string_view(hlslCode, fileSizeBytes).find("VS_MainInstanced") != std::string_view::npos)
+		{
+			Graphics::ShaderCompilerDesc compilerOptions = {};
+			compilerOptions.m_name = instancedVertexShaderName;
+			compilerOptions.m_type = Graphics::ShaderType::VERTEX_SHADER;
+			compilerOptions.m_flags = (u32)Graphics::ShaderCompilationFlags::DEBUG;
+			compilerOptions.m_hlslCode = hlslCode;
+			compilerOptions.m_sourcePath = hlslPath.path;
+			compilerOptions.m_entryPoint = "VS_MainInstanced";
+			compilerOptions.m_defines.push_back({ "MAX_LIGHTS", "4" });
+			customInstancedVertexShader = Graphics::Shader::Compile(compilerOptions);
+			PLAY_ASSERT_MSG(customInstancedVertexShader.IsValid(), "Instanced Vertex Shader Compilation Failed!");
+		}
 
-		Graphics::ComplexMaterialDesc desc;
-		desc.m_state.m_cullMode = Graphics::CullMode::BACK;
-		desc.m_state.m_fillMode = Graphics::FillMode::SOLID;
-		desc.m_VertexShader = customVertexShader;
-		desc.m_PixelShader = customPixelShader;
+		System::ReleaseFileData(const_cast<char*>(hlslCode));
+		ReportAssetHitch(hlslPath.path, loadStart);
 
-		if (texturePath != "")
+		// Named as a pack would have, so other materials using the file share these
+		Resources::ResourceManager<Graphics::Shader>::Instance().AddAlias(vertexShaderName, customVertexShader);
+		Resources::ResourceManager<Graphics::Shader>::Instance().AddAlias(pixelShaderName, customPixelShader);
+		if (customInstancedVertexShader.IsValid())
 		{
-			desc.m_texture[0] = Graphics::CreateTextureFromFile(texturePath);
-			desc.m_sampler[0] = Graphics::CreateLinearSampler();
+			Resources::ResourceManager<Graphics::Shader>::Instance().AddAlias(instancedVertexShaderName, customInstancedVertexShader);
 		}
+	}
+
+	Graphics::ComplexMaterialDesc desc;
+	desc.m_state.m_cullMode = Graphics::CullMode::BACK;
+	desc.m_state.m_fillMode = Graphics::FillMode::SOLID;
+	desc.m_VertexShader = customVertexShader;
+	desc.m_PixelShader = customPixelShader;
+	desc.m_InstancedVertexShader = customInstancedVertexShader;
 
-		m_materialRegister.insert(std::pair<const char*, Play3d::Graphics::MaterialId>(
-			buffer,
-			Resources::CreateAsset<Graphics::Material>(desc)
-		));
+	if (!texturePath.IsEmpty())
+	{
+		desc.m_texture[0] = GetTexture(texturePath.path);
+		desc.m_sampler[0] = Graphics::CreateLinearSampler();
 	}
 
-	return m_materialRegister.at(buffer);
+	Graphics::MaterialId materialId = Resources::CreateAsset<Graphics::Material>(desc);
+	Register(key, hlslPath, texturePath, materialId.GetValue());
+	return materialId;
 }
 
 // Use the list of registered GameObjects to update them all...
 void GameObjectManager::UpdateAll()
 {
-	for( int i = 0; i < m_pGameObjectList.size(); i++ ) 
 	{
-		m_pGameObjectList[ i ]->StandardMovementUpdate();
-		m_pGameObjectList[ i ]->Update();
+		PROFILE_SCOPE(PROFILE_UPDATE_OBJECTS);
+		for( int i = 0; i < m_pGameObjectList.size(); i++ ) 
+		{
+			m_pGameObjectList[ i ]->StandardMovementUpdate();
+			m_pGameObjectList[ i ]->Update();
+		}
+	}
+	{
+		PROFILE_SCOPE(PROFILE_UPDATE_PROJECTILES);
+		m_pProjectiles->UpdateAll();
+	}
+	{
+		PROFILE_SCOPE(PROFILE_COLLIDE);
+		CollideAll();
+	}
+	{
+		PROFILE_SCOPE(PROFILE_CLEANUP);
+		CleanUpAll();
 	}
-	CollideAll();
-	CleanUpAll();
 }
 
 // Use the list of registered GameObjects to draw them all...
 void GameObjectManager::DrawAll()
 {
+	// Queued, so the meshes are drawn grouped by shader, material and mesh rather than in creation order
+	Play3d::Graphics::BeginMeshQueue();
 	for( int i = 0; i < m_pGameObjectList.size(); i++ ) 
 	{
 		if( !m_pGameObjectList[ i ]->IsHidden() )
@@ -235,6 +438,8 @@ void GameObjectManager::DrawAll()
 			obj.Draw();
 		}
 	}
+	m_pProjectiles->DrawAll();
+	Play3d::Graphics::EndMeshQueue();
 }
 
 // Use the list of registered GameObjects to draw them all...
@@ -248,77 +453,169 @@ void GameObjectManager::DrawCollisionAll()
 			obj.DrawCollision();
 		}
 	}
+	m_pProjectiles->DrawCollisionAll();
 }
 
 // Use the list of registered GameObjects to collide them all...
 void GameObjectManager::CollideAll()
 {
-	// Compare every game object with every other game object ignoring duplicate comparisons
-	// Not very efficent! O(n*(n-1)/2) => O(n2) so consider using hash maps and/or sweep and prune to reduce collision tests
-	for( int i = 0; i < m_pGameObjectList.size(); i++ ) 
+	// Bucket every collidable object by layer, skipping layers which can't collide with anything at all.
+	// Objects spawned by OnCollision() wait until next frame.
+	m_collisionStats = CollisionStats();
+	for (int layer = 0; layer < LAYER_TOTAL; layer++)
 	{
-		//      i  0  1  2  3  4 
-		//   j -|---------------
-		//   0  |  X  C  C  C  C  
-		//   1  |  X  X  C  C  C  
-		//   2  |  X  X  X  C  C 
-		//   3  |  X  X  X  X  C 
-		//   4  |  X  X  X  X  X 
-		// 
-		// There is no need to compare against objects 0-i becaue we've already done those (see above: C = collision test)
-		for( int j = i+1; j < m_pGameObjectList.size(); j++ ) 
+		m_layerObjects[layer].clear();
+		m_layerBounds[layer].clear();
+	}
+
+	for (size_t i = 0; i < m_pGameObjectList.size(); i++)
+	{
+		CollisionLayer layer = m_pGameObjectList[i]->GetCollisionLayer();
+		if (layer == LAYER_NONE || s_layerMasks[layer] == 0)
+			continue;
+
+		CollisionBounds bounds = m_pGameObjectList[i]->GetCollisionBounds();
+		if (bounds.IsEmpty())
+			continue;
+
+		m_layerObjects[layer].push_back((Play3d::u32)i);
+		m_layerBounds[layer].push_back(bounds);
+		m_collisionStats.objectsInGrid++;
+	}
+
+	for (int layer = 0; layer < LAYER_TOTAL; layer++)
+	{
+		if (!m_layerObjects[layer].empty())
+			m_layerGrids[layer].Build(m_layerBounds[layer], GetGameHalfWidth(), GetGameHalfHeight(), COLLISION_CELL_SIZE);
+	}
+
+	// Visit each colliding layer pair once; whole buckets which can't interact are never looked at
+	for (int layerA = 0; layerA < LAYER_TOTAL; layerA++)
+	{
+		for (int layerB = layerA; layerB < LAYER_TOTAL; layerB++)
 		{
-			// Don't compare objects against objects of the same type
-			if( m_pGameObjectList[ i ]->GetObjectType() != m_pGameObjectList[ j ]->GetObjectType() )
-			{
-				if( m_pGameObjectList[ i ]->IsColliding( m_pGameObjectList[ j ] ) )
-				{
-					// Need to call the OnCollision functions of BOTH objects as they are only compared once
-					m_pGameObjectList[ i ]->OnCollision( m_pGameObjectList[ j ] );
-					m_pGameObjectList[ j ]->OnCollision( m_pGameObjectList[ i ] );
-				}
-			}
+			if (s_layerMasks[layerA] & LayerBit((CollisionLayer)layerB))
+				CollideLayers((CollisionLayer)layerA, (CollisionLayer)layerB);
+		}
+	}
+
+	// Projectiles are tested against every object in their target layer's bucket
+	for (int owner = 0; owner < OWNER_TOTAL; owner++)
+	{
+		CollisionLayer targetLayer = m_pProjectiles->GetTargetLayer((ProjectileOwner)owner);
+		for (Play3d::u32 i : m_layerObjects[targetLayer])
+		{
+			m_pProjectiles->Collide((ProjectileOwner)owner, m_pGameObjectList[i], m_collisionStats);
+		}
+	}
+}
+
+void GameObjectManager::CollideLayers(CollisionLayer layerA, CollisionLayer layerB)
+{
+	if (m_layerObjects[layerA].empty() || m_layerObjects[layerB].empty())
+		return;
+
+	// Walk the smaller bucket and query the grid of the larger one (e.g. a single player against thousands of pellets)
+	CollisionLayer walkLayer = layerA;
+	CollisionLayer gridLayer = layerB;
+	if (m_layerObjects[layerA].size() > m_layerObjects[layerB].size())
+		std::swap(walkLayer, gridLayer);
+
+	const std::vector<Play3d::u32>& walkObjects = m_layerObjects[walkLayer];
+	const std::vector<Play3d::u32>& gridObjects = m_layerObjects[gridLayer];
+	for (size_t i = 0; i < walkObjects.size(); i++)
+	{
+		m_collisionCandidates.clear();
+		m_layerGrids[gridLayer].Query(m_layerBounds[walkLayer][i], m_collisionCandidates);
+
+		for (Play3d::u32 j : m_collisionCandidates)
+		{
+			// A layer colliding with itself sees every pair from both sides, so only handle it once
+			if (walkLayer == gridLayer && j <= i)
+				continue;
+
+			CollidePair(walkObjects[i], gridObjects[j]);
 		}
 	}
 }
 
+void GameObjectManager::CollidePair(Play3d::u32 objA, Play3d::u32 objB)
+{
+	GameObject* pA = m_pGameObjectList[ std::min(objA, objB) ];
+	GameObject* pB = m_pGameObjectList[ std::max(objA, objB) ];
+
+	// Don't compare objects against objects of the same type
+	if( pA->GetObjectType() == pB->GetObjectType() )
+		return;
+
+	m_collisionStats.pairsTested++;
+	if( pA->IsColliding( pB ) )
+	{
+		// Need to call the OnCollision functions of BOTH objects as they are only compared once
+		m_collisionStats.pairsColliding++;
+		pA->OnCollision( pB );
+		pB->OnCollision( pA );
+	}
+}
+
 // Remove any flagged objects from the list of registered GameObjects
 // Doing this outside of the main update loop helps to avoid various problems that can occur by deleting mid-update
 void GameObjectManager::CleanUpAll()
 {
-	for( int i = 0; i < m_pGameObjectList.size(); i++ )
+	if( m_cleanUpMode == CLEANUP_UNORDERED )
+	{
+		for( size_t i = 0; i < m_pGameObjectList.size(); )
+		{
+			if( m_pGameObjectList[ i ]->IsDestroyed() )
+			{
+				// Don't advance, the object swapped in still needs checking
+				UnregisterFromType( m_pGameObjectList[ i ] );
+				FreeObject( m_pGameObjectList[ i ] );
+				m_pGameObjectList[ i ] = m_pGameObjectList.back();
+				m_pGameObjectList.pop_back();
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+	else
 	{
-		if( m_pGameObjectList[ i ]->IsDestroyed() ) 
+		// Single linear sweep: survivors are shuffled down over the gaps, then the tail is trimmed once
+		size_t write = 0;
+		for( size_t read = 0; read < m_pGameObjectList.size(); read++ )
 		{
-			delete m_pGameObjectList[ i ];
-			m_pGameObjectList.erase( find( m_pGameObjectList.begin(), m_pGameObjectList.end(), m_pGameObjectList[ i-- ] ) );
+			if( m_pGameObjectList[ read ]->IsDestroyed() )
+			{
+				UnregisterFromType( m_pGameObjectList[ read ] );
+				FreeObject( m_pGameObjectList[ read ] );
+			}
+			else
+				m_pGameObjectList[ write++ ] = m_pGameObjectList[ read ];
 		}
+		m_pGameObjectList.resize( write );
 	}
 }
 
+ObjectRange GameObjectManager::GetObjectsOfType( GameObjectType objType ) const
+{
+	const std::vector<GameObject*>& typeList = m_pTypeLists[ objType ];
+	return ObjectRange{ typeList.data(), typeList.data() + typeList.size() };
+}
+
 int GameObjectManager::GetAllObjectsOfType( GameObjectType objType, std::vector<GameObject*>& objList, bool clearList )
 {
 	if( clearList == true )
 		objList.clear();
 
-	int count = 0;
-	for( int i = 0; i < m_pGameObjectList.size(); i++ )
-	{
-		if( m_pGameObjectList[ i ]->GetObjectType() == objType )
-		{
-			objList.push_back( m_pGameObjectList[ i ] );
-			count++;
-		}
-	}
-
-	return count;
+	ObjectRange objects = GetObjectsOfType( objType );
+	objList.insert( objList.end(), objects.begin(), objects.end() );
+	return (int)objects.size();
 }
 
 void GameObjectManager::DeleteGameObjectsByType( GameObjectType type )
 {
-	for( int i = 0; i < m_pGameObjectList.size(); i++ )
-	{
-		if( m_pGameObjectList[ i ]->GetObjectType() == type )
-			m_pGameObjectList[ i ]->Destroy();
-	}
+	for( GameObject* obj : GetObjectsOfType( type ) )
+		obj->Destroy();
 }
\ No newline at end of file
@@ -1,41 +1,124 @@
 #pragma once
 #include "GameObject.h"
+#include "ObjectPool.h"
+#include "AssetKey.h"
+#include <chrono>
 
 class GameObject;
+class ObjectBossBomb;
+class ProjectileStore;
+
+// Per-frame broadphase counters, reset at the start of every CollideAll()
+struct CollisionStats
+{
+	int objectsInGrid{0};	// objects which could collide this frame
+	int pairsTested{0};		// candidate pairs passed on to the narrowphase IsColliding() test
+	int pairsColliding{0};	// tested pairs which actually collided
+};
+
+// Lookups in the asset registry since the manager was created. Each miss is the first request for that asset.
+struct AssetRegistryStats
+{
+	int hits{0};
+	int misses{0};
+};
+
+// How CleanUpAll() removes destroyed objects from the object list
+enum CleanUpMode
+{
+	CLEANUP_STABLE,		// one compaction sweep, surviving objects keep their relative order
+	CLEANUP_UNORDERED,	// swap-and-pop, cheaper but moves objects from the end of the list into the gaps
+};
+
+// Non-owning view of a contiguous run of objects. Only valid until the next object is created or CleanUpAll() runs.
+struct ObjectRange
+{
+	GameObject* const* pBegin{ nullptr };
+	GameObject* const* pEnd{ nullptr };
+
+	GameObject* const* begin() const { return pBegin; }
+	GameObject* const* end() const { return pEnd; }
+	size_t size() const { return pEnd - pBegin; }
+	bool empty() const { return pBegin == pEnd; }
+	GameObject* operator[]( size_t i ) const { return pBegin[ i ]; }
+};
 
 class GameObjectManager
 {
 public:
-	GameObjectManager() = default;
+	GameObjectManager();
 	~GameObjectManager();
 
 	GameObject* CreateObject( GameObjectType objType, Play3d::Vector3f pos);
-	void RegisterGameObject( GameObject* obj ) { m_pGameObjectList.push_back( obj ); };
+	ObjectPoolStats GetPoolStats( GameObjectType objType ) const; // zeroed stats for types which are not pooled
+	void RegisterGameObject( GameObject* obj );
 	
-	// Load item into memory if not already loaded, then return resource ID
-	Play3d::Graphics::MeshId GetMesh(const char* filepath);
-	Play3d::Audio::SoundId GetAudioId(const char* filepath);
-	Play3d::Graphics::MaterialId GetMaterial(const char* textureFilepath = "");
-	Play3d::Graphics::MaterialId GetMaterialHLSL(const char* hlslPath, const char* texturePath = "");
+	// Loads a flowstate's asset pack and waits for it. Anything the Get functions below still have to load from file
+	// afterwards was missing from the pack, and is reported as a hitch.
+	void PreloadAssets(const char* packPath);
+	int GetAssetHitchCount() const { return m_assetHitchCount; }
+
+	// Load item into memory if not already loaded, then return resource ID. Paths are compared by their AssetPath hash,
+	// so any spelling of a file finds the same entry.
+	Play3d::Graphics::MeshId GetMesh(const AssetPath& filepath);
+	Play3d::Audio::SoundId GetAudioId(const AssetPath& filepath);
+	Play3d::Graphics::MaterialId GetMaterial(const AssetPath& textureFilepath = "");
+	Play3d::Graphics::MaterialId GetMaterialHLSL(const AssetPath& hlslPath, const AssetPath& texturePath = "");
+	const AssetRegistryStats& GetAssetRegistryStats() const { return m_assetRegistryStats; }
 
 	void UpdateAll();
 	void DrawAll();
 	void DrawCollisionAll();
 	void CollideAll();
 	void CleanUpAll(); 
+	void SetCleanUpMode( CleanUpMode mode ) { m_cleanUpMode = mode; }
+	const CollisionStats& GetCollisionStats() const { return m_collisionStats; }
 
+	ProjectileStore* GetProjectiles() { return m_pProjectiles; }
 	GameObject* GetPlayer() { return m_pPlayer; }
 	GameObject* GetBoss() {return m_pBoss; }
 	void SetPlayer( GameObject* pPlayer ) { m_pPlayer = pPlayer; }
 	void SetBoss(GameObject* pBoss) {m_pBoss = pBoss; }
+	ObjectRange GetAllObjects() const { return ObjectRange{ m_pGameObjectList.data(), m_pGameObjectList.data() + m_pGameObjectList.size() }; } // in list order
+	ObjectRange GetObjectsOfType( GameObjectType objType ) const; // no copy, order within a type is not preserved
 	int GetAllObjectsOfType( GameObjectType objType, std::vector<GameObject*>& objList, bool clearList = true );
 	void DeleteGameObjectsByType( GameObjectType type );
 
 private:
+	void FreeObject( GameObject* obj );
+	// One registry entry per asset. The entry keeps its own copy of the path, so callers' strings needn't outlive the call.
+	struct AssetRegistryEntry
+	{
+		Play3d::u32 id;	// value of the MeshId, SoundId or MaterialId
+		std::string path;
+		std::string variant;
+	};
+	const AssetRegistryEntry* FindRegistered(AssetKey key, const AssetPath& path, const AssetPath& variant = "");
+	void Register(AssetKey key, const AssetPath& path, const AssetPath& variant, Play3d::u32 id);
+	Play3d::Graphics::TextureId GetTexture(const char* filepath);
+	void ReportAssetHitch(const char* filepath, std::chrono::steady_clock::time_point loadStart);
+	void UnregisterFromType( GameObject* obj );
+	void CollideLayers( CollisionLayer layerA, CollisionLayer layerB );
+	void CollidePair( Play3d::u32 objA, Play3d::u32 objB );
+
 	std::vector<GameObject*> m_pGameObjectList;
-	std::unordered_map<const char*, Play3d::Graphics::MeshId> m_meshRegister;
-	std::unordered_map<const char*, Play3d::Audio::SoundId> m_audioRegister;
-	std::unordered_map<const char*, Play3d::Graphics::MaterialId> m_materialRegister;
+	std::vector<GameObject*> m_pTypeLists[ TYPE_TOTAL ]; // the same objects again, bucketed by type
+	// Stable by default since update, collision and draw order all follow the list order
+	CleanUpMode m_cleanUpMode{ CLEANUP_STABLE };
+	// Pellets aren't GameObjects at all, they live in the projectile store. Bombs are pooled, everything else is heap allocated
+	ProjectileStore* m_pProjectiles{ nullptr };
+	ObjectPool<ObjectBossBomb>* m_pBossBombPool{ nullptr };
+	// Broadphase state, kept between frames so the buffers stop allocating once warmed up
+	// One bucket and grid per collision layer; bucket entries are indices into m_pGameObjectList
+	CollisionGrid m_layerGrids[LAYER_TOTAL];
+	std::vector<Play3d::u32> m_layerObjects[LAYER_TOTAL];
+	std::vector<CollisionBounds> m_layerBounds[LAYER_TOTAL];
+	std::vector<Play3d::u32> m_collisionCandidates;
+	CollisionStats m_collisionStats;
+	std::unordered_map<Play3d::u64, AssetRegistryEntry> m_assetRegistry; // by AssetKey
+	AssetRegistryStats m_assetRegistryStats;
+	bool m_bAssetsPreloaded{ false };
+	int m_assetHitchCount{ 0 };
 	GameObject* m_pPlayer{ nullptr };
 	GameObject* m_pBoss{ nullptr };
 };
@@ -1,6 +1,7 @@
 #include "ObjectPlayer.h"
 #include "ObjectManager.h"
 #include "GameHud.h"
+#include "ProjectileStore.h"
 using namespace Play3d;
 
 static constexpr float SHIP_HALFWIDTH{0.15f};
@@ -26,22 +27,22 @@ static constexpr float MAX_ROT_Y{kfQuartPi / 4.f};
 static const Vector2f MIN_POS{-9.f, -7.f};
 static const Vector2f MAX_POS{9.f, 5.f};
 
+static constexpr AssetPath MESH_PATH{ "..\\Assets\\Models\\_fighter.obj" };
+static constexpr AssetPath TEXTURE_PATH{ "..\\Assets\\Models\\_fighter-blue.jpg" };
+static constexpr AssetPath DEATH_SFX_PATHS[]{ "..\\Assets\\Audio\\Death1.wav", "..\\Assets\\Audio\\Death2.wav", "..\\Assets\\Audio\\Death3.wav" };
+static constexpr AssetPath GAME_OVER_SFX_PATH{ "..\\Assets\\Audio\\GameOver.wav" };
+
 ObjectPlayer::ObjectPlayer(Vector3f position) : GameObject(TYPE_PLAYER, position)
 {
 	GameObjectManager* pObjs{ GetObjectManager() };
 
 	// Load and assign player mesh
-	m_meshId = pObjs->GetMesh("..\\Assets\\Models\\_fighter.obj");
-	m_materialId = pObjs->GetMaterial("..\\Assets\\Models\\_fighter-blue.jpg");
-
-	// Ensure player chunks are preloaded to avoid lag on first death
-	pObjs->GetMesh("..\\Assets\\Models\\_fighter-chunk-core.obj");
-	pObjs->GetMesh("..\\Assets\\Models\\_fighter-chunk-wingL.obj");
-	pObjs->GetMesh("..\\Assets\\Models\\_fighter-chunk-wingR.obj");
+	m_meshId = pObjs->GetMesh(MESH_PATH);
+	m_materialId = pObjs->GetMaterial(TEXTURE_PATH);
 
-	m_sfxDeath[0] = pObjs->GetAudioId("..\\Assets\\Audio\\Death1.wav");
-	m_sfxDeath[1] = pObjs->GetAudioId("..\\Assets\\Audio\\Death2.wav");
-	m_sfxDeath[2] = pObjs->GetAudioId("..\\Assets\\Audio\\Death3.wav");
+	m_sfxDeath[0] = pObjs->GetAudioId(DEATH_SFX_PATHS[0]);
+	m_sfxDeath[1] = pObjs->GetAudioId(DEATH_SFX_PATHS[1]);
+	m_sfxDeath[2] = pObjs->GetAudioId(DEATH_SFX_PATHS[2]);
 
 	ParticleEmitterSettings s;
 	s.capacity = 100;
@@ -65,7 +66,7 @@ ObjectPlayer::ObjectPlayer(Vector3f position) : GameObject(TYPE_PLAYER, position
 
 void ObjectPlayer::Update()
 {
-	m_invincibilityTimer -= Play3d::System::GetDeltaTime();
+	m_invincibilityTimer -= GetSimDeltaTime();
 
 	if (m_bIsAlive)
 	{
@@ -73,7 +74,7 @@ void ObjectPlayer::Update()
 	}
 	else
 	{
-		m_respawnCooldown -= System::GetDeltaTime();
+		m_respawnCooldown -= GetSimDeltaTime();
 		if (m_respawnCooldown <= 0.f)
 		{
 			Respawn();
@@ -89,6 +90,7 @@ void ObjectPlayer::Respawn()
 		m_pos = Vector3f(0.f, -GetGameHalfHeight() / 1.25f, 0.f);
 		m_velocity = Vector3f(0.f, 0.f, 0.f);
 		m_rotation = Vector3f(0.f, 0.f, 0.f);
+		SnapInterpolation();
 		m_bDoubleTapLeft = false;
 		m_bDoubleTapRight = false;
 		m_bIsBarrelRoll = false;
@@ -109,25 +111,24 @@ void ObjectPlayer::Respawn()
 	}
 	else if(m_lives == 0)
 	{
-		Audio::PlaySound(GetObjectManager()->GetAudioId("..\\Assets\\Audio\\GameOver.wav"), 3.5f);
+		Audio::PlaySound(GetObjectManager()->GetAudioId(GAME_OVER_SFX_PATH), 3.5f);
 		m_lives = -1;
 	}
 }
 
 void ObjectPlayer::HandleControls()
 {
-	float deltaTime = System::GetDeltaTime();
+	float deltaTime = GetSimDeltaTime();
 
 	// FIRE
 	m_shootCooldown -= deltaTime;
-	if (Input::IsKeyDown(VK_SPACE))
+	if (IsSimKeyDown(VK_SPACE))
 	{
 		if (m_shootCooldown < 0)
 		{
 			m_shootCooldown = DELAY_AUTOFIRE;
 
-			GameObject* pPellet = GetObjectManager()->CreateObject(TYPE_PLAYER_PELLET, m_pos + Vector3f(0.f, .33f, 0.f));
-			pPellet->SetVelocity(Vector3f(0.f, .2f, 0.f));
+			GetObjectManager()->GetProjectiles()->Spawn(OWNER_PLAYER, m_pos.xy() + Vector2f(0.f, .33f), Vector2f(0.f, .2f));
 		}
 	}
 	else
@@ -136,22 +137,17 @@ void ObjectPlayer::HandleControls()
 	}
 
 	// BOMB
-	if (Input::IsKeyPressed(VK_SHIFT) && m_bombs >= 1)
+	if (IsSimKeyPressed(VK_SHIFT) && m_bombs >= 1)
 	{
 		m_bombs--;
 		GameHud::Get()->SetBombs(m_bombs);
 
-		std::vector<GameObject*> pProjectiles;
-		GetObjectManager()->GetAllObjectsOfType(TYPE_BOSS_PELLET, pProjectiles);
-		GetObjectManager()->GetAllObjectsOfType(TYPE_BOSS_BOMB, pProjectiles, false); // false => results will append to vector
-		for (int i = 0; i < pProjectiles.size(); i++)
-		{
-			pProjectiles[i]->Destroy();
-		}
+		GetObjectManager()->GetProjectiles()->DestroyAll(OWNER_BOSS);
+		GetObjectManager()->DeleteGameObjectsByType(TYPE_BOSS_BOMB);
 	}
 
 	// STEER - VERTICAL
-	if (Input::IsKeyDown('W'))
+	if (IsSimKeyDown('W'))
 	{
 		m_velocity.y = std::min(m_velocity.y + (STEER_SPEED_Y * deltaTime), MAX_SPEED);
 
@@ -161,7 +157,7 @@ void ObjectPlayer::HandleControls()
 		}
 		m_rotSpeed.x = std::min(m_rotSpeed.x + (SPIN_SPEED * deltaTime), MAX_ROT_SPEED);
 	}
-	else if (Input::IsKeyDown('S'))
+	else if (IsSimKeyDown('S'))
 	{
 		m_velocity.y = std::max(m_velocity.y - (STEER_SPEED_Y * deltaTime), -MAX_SPEED);
 
@@ -179,7 +175,7 @@ void ObjectPlayer::HandleControls()
 	}
 
 	// STEER - HORIZONTAL
-	if (Input::IsKeyDown('A'))
+	if (IsSimKeyDown('A'))
 	{
 		float thrust = std::min(m_velocity.x + (STEER_SPEED_X * deltaTime), MAX_SPEED);
 		m_velocity.x = std::max(m_velocity.x, thrust); // don't clamp velocity if already above max-speed (barrel rolls)
@@ -191,7 +187,7 @@ void ObjectPlayer::HandleControls()
 		}
 		m_rotSpeed.y = std::max(m_rotSpeed.y - (SPIN_SPEED * deltaTime), -MAX_ROT_SPEED);
 	}
-	else if (Input::IsKeyDown('D'))
+	else if (IsSimKeyDown('D'))
 	{
 		float thrust = std::max(m_velocity.x - (STEER_SPEED_X * deltaTime), -MAX_SPEED);
 		m_velocity.x = std::min(m_velocity.x, thrust); // don't clamp velocity if already above max-speed (barrel rolls)
@@ -210,17 +206,27 @@ void ObjectPlayer::HandleControls()
 		m_rotation.y *= 0.86f; // reduce current angle
 		m_velocity.x *= 0.86f; // reduce speed
 	}
-	m_rotation.y = std::clamp(m_rotation.y, -MAX_ROT_X, MAX_ROT_X);
 	m_rotation.x = std::clamp(m_rotation.x, -MAX_ROT_Y, MAX_ROT_Y);
 
 	// BARREL ROLL - Cooldown
 	m_rollCooldown -= deltaTime;
 	if (m_rollCooldown <= 0.f)
 	{
+		if (m_bIsBarrelRoll)
+		{
+			// The roll leaves the ship nearly a whole turn round, unwind it from the drawn-from angle too so it doesn't spin back
+			float turns = std::round(m_rotation.y / kfTwoPi) * kfTwoPi;
+			m_rotation.y -= turns;
+			m_oldRotation.y -= turns;
+		}
 		m_bDoubleTapLeft = false;
 		m_bDoubleTapRight = false;
 		m_bIsBarrelRoll = false;
 	}
+	if (!m_bIsBarrelRoll)
+	{
+		m_rotation.y = std::clamp(m_rotation.y, -MAX_ROT_X, MAX_ROT_X);
+	}
 
 	// BARREL ROLL - Execute
 	if (m_bIsBarrelRoll)
@@ -238,7 +244,7 @@ void ObjectPlayer::HandleControls()
 	}
 
 	// BARREL ROLL - Trigger
-	if (!m_bIsBarrelRoll && Input::IsKeyPressed('A'))
+	if (!m_bIsBarrelRoll && IsSimKeyPressed('A'))
 	{
 		if (m_bDoubleTapLeft && m_rollCooldown > 0.f)
 		{
@@ -256,7 +262,7 @@ void ObjectPlayer::HandleControls()
 			m_rollCooldown = COOLDOWN_DOUBLE_TAP;
 		}
 	}
-	else if (!m_bIsBarrelRoll && Input::IsKeyPressed('D'))
+	else if (!m_bIsBarrelRoll && IsSimKeyPressed('D'))
 	{
 		if (m_bDoubleTapRight && m_rollCooldown > 0.f)
 		{
@@ -287,9 +293,9 @@ void ObjectPlayer::HandleControls()
 	thrusterRightOffset.x = (temp.x * c) - (temp.z * s);
 	thrusterRightOffset.z = (temp.z * c) + (temp.x * s);
 	m_emitterLeftThruster.m_position = m_pos + thrusterLeftOffset;
-	m_emitterLeftThruster.Tick();
+	m_emitterLeftThruster.QueueTick(GetSimDeltaTime());
 	m_emitterRightThruster.m_position = m_pos + thrusterRightOffset;
-	m_emitterRightThruster.Tick();
+	m_emitterRightThruster.QueueTick(GetSimDeltaTime());
 
 	// Enforce limits
 	Vector3f cachedPos = m_pos;
@@ -309,38 +315,51 @@ void ObjectPlayer::HandleControls()
 }
 
 void ObjectPlayer::OnCollision(GameObject* other)
+{
+	if(other->GetObjectType() == GameObjectType::TYPE_BOSS_BOMB || other->GetObjectType() == GameObjectType::TYPE_BOSS)
+	{
+		Die();
+	}
+}
+
+void ObjectPlayer::OnProjectileHit(GameObjectType projectileType)
+{
+	if (projectileType == GameObjectType::TYPE_BOSS_PELLET)
+	{
+		Die();
+	}
+}
+
+void ObjectPlayer::Die()
 {
 	if (m_invincibilityTimer >= 0.f)
 	{
 		return;
 	}
 
-	if(other->GetObjectType() == GameObjectType::TYPE_BOSS_PELLET || other->GetObjectType() == GameObjectType::TYPE_BOSS)
-	{
-		// Die > if lives remain, start respawn timer, else gameover
-		SetHidden(true);
-		m_canCollide = false;
-		m_bIsAlive = false;
-		m_respawnCooldown = COOLDOWN_RESPAWN;
+	// Die > if lives remain, start respawn timer, else gameover
+	SetHidden(true);
+	m_canCollide = false;
+	m_bIsAlive = false;
+	m_respawnCooldown = COOLDOWN_RESPAWN;
 
-		GameObjectManager* pObjs{GetObjectManager()};
-		GameObject* pChunk;
+	GameObjectManager* pObjs{GetObjectManager()};
+	GameObject* pChunk;
 
-		pChunk = pObjs->CreateObject(TYPE_PLAYER_CHUNK_CORE, m_pos);
-		pChunk->SetVelocity((m_velocity / 8.f) + Vector3f(0.f, 0.01f, 0.f));
-		pChunk->SetRotationSpeed(m_rotation / 8.f);
+	pChunk = pObjs->CreateObject(TYPE_PLAYER_CHUNK_CORE, m_pos);
+	pChunk->SetVelocity((m_velocity / 8.f) + Vector3f(0.f, 0.01f, 0.f));
+	pChunk->SetRotationSpeed(m_rotation / 8.f);
 
-		pChunk = pObjs->CreateObject(TYPE_PLAYER_CHUNK_WING_L, m_pos);
-		pChunk->SetVelocity((m_velocity / 8.f) + Vector3f(0.01f, -0.01f, 0.f));
-		pChunk->SetRotationSpeed(-m_rotation / 8.f);
+	pChunk = pObjs->CreateObject(TYPE_PLAYER_CHUNK_WING_L, m_pos);
+	pChunk->SetVelocity((m_velocity / 8.f) + Vector3f(0.01f, -0.01f, 0.f));
+	pChunk->SetRotationSpeed(-m_rotation / 8.f);
 
-		pChunk = pObjs->CreateObject(TYPE_PLAYER_CHUNK_WING_R, m_pos);
-		pChunk->SetVelocity((m_velocity / 8.f) + Vector3f(-0.01f, -0.01f, 0.f));
-		pChunk->SetRotationSpeed(-m_rotation / 8.f);
+	pChunk = pObjs->CreateObject(TYPE_PLAYER_CHUNK_WING_R, m_pos);
+	pChunk->SetVelocity((m_velocity / 8.f) + Vector3f(-0.01f, -0.01f, 0.f));
+	pChunk->SetRotationSpeed(-m_rotation / 8.f);
 
-		int sfxId = std::floor(RandValueInRange(0.f, SFX_DEATH_SLOTS));
-		Audio::PlaySound(m_sfxDeath[sfxId]);
-	}
+	int sfxId = std::floor(RandValueInRange(0.f, SFX_DEATH_SLOTS));
+	Audio::PlaySound(m_sfxDeath[sfxId]);
 }
 
 void ObjectPlayer::Draw() const
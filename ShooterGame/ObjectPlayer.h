@@ -13,6 +13,8 @@ public:
 	void Respawn();
 	void HandleControls();
 	void OnCollision(GameObject* other) override;
+	void OnProjectileHit(GameObjectType projectileType) override;
+	void Die();
 
 	void Draw() const override;
 
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Counters exposed so pool capacities can be tuned against real attack patterns
+struct ObjectPoolStats
+{
+	size_t capacity{0};	// slots reserved up front
+	size_t active{0};	// slots currently handed out
+	size_t peak{0};		// highest 'active' value seen since creation
+	size_t overflow{0};	// acquisitions which found the pool full and fell back to the heap
+};
+
+// Fixed-capacity slab of T: one allocation up front, O(1) acquire/release via a stack of free slot indices.
+// When the slab is exhausted Acquire() falls back to plain new so gameplay never fails, but the overflow is
+// counted so the capacity can be raised. Overflow objects are not Owns() by the pool and must be deleted normally.
+template<typename T>
+class ObjectPool
+{
+public:
+	explicit ObjectPool(size_t capacity)
+		: m_pSlots(new Slot[capacity])
+		, m_capacity(capacity)
+	{
+		m_freeSlots.reserve(capacity);
+		for (size_t i = capacity; i > 0; i--)
+		{
+			m_freeSlots.push_back(i - 1);
+		}
+		m_stats.capacity = capacity;
+	}
+
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	template<typename ... ConstructorArgs>
+	T* Acquire(ConstructorArgs&& ... args)
+	{
+		if (m_freeSlots.empty())
+		{
+			m_stats.overflow++;
+			return new T(std::forward<ConstructorArgs>(args)...);
+		}
+
+		size_t slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		T* pObj = new (&m_pSlots[slot]) T(std::forward<ConstructorArgs>(args)...);
+
+		m_stats.active++;
+		if (m_stats.active > m_stats.peak)
+		{
+			m_stats.peak = m_stats.active;
+		}
+		return pObj;
+	}
+
+	void Release(T* pObj)
+	{
+		size_t slot = reinterpret_cast<Slot*>(pObj) - m_pSlots.get();
+		pObj->~T();
+		m_freeSlots.push_back(slot);
+		m_stats.active--;
+	}
+
+	bool Owns(const void* pObj) const
+	{
+		const Slot* pSlot = static_cast<const Slot*>(pObj);
+		return pSlot >= m_pSlots.get() && pSlot < m_pSlots.get() + m_capacity;
+	}
+
+	const ObjectPoolStats& GetStats() const { return m_stats; }
+
+private:
+	struct Slot
+	{
+		alignas(T) unsigned char bytes[sizeof(T)];
+	};
+
+	std::unique_ptr<Slot[]> m_pSlots;
+	std::vector<size_t> m_freeSlots;
+	size_t m_capacity{0};
+	ObjectPoolStats m_stats;
+};
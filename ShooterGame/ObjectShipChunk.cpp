@@ -2,6 +2,17 @@
 #include "ObjectManager.h"
 using namespace Play3d;
 
+static constexpr AssetPath PLAYER_CORE_MESH_PATH{ "..\\Assets\\Models\\_fighter-chunk-core.obj" };
+static constexpr AssetPath PLAYER_WING_L_MESH_PATH{ "..\\Assets\\Models\\_fighter-chunk-wingL.obj" };
+static constexpr AssetPath PLAYER_WING_R_MESH_PATH{ "..\\Assets\\Models\\_fighter-chunk-wingR.obj" };
+static constexpr AssetPath PLAYER_TEXTURE_PATH{ "..\\Assets\\Models\\_fighter-blue.jpg" };
+
+static constexpr AssetPath BOSS_CORE_MESH_PATH{ "..\\Assets\\Models\\_station-chunk-core.obj" };
+static constexpr AssetPath BOSS_LEFT_MESH_PATH{ "..\\Assets\\Models\\_station-chunk-left.obj" };
+static constexpr AssetPath BOSS_RIGHT_MESH_PATH{ "..\\Assets\\Models\\_station-chunk-right.obj" };
+static constexpr AssetPath BOSS_LOWER_MESH_PATH{ "..\\Assets\\Models\\_station-chunk-lower.obj" };
+static constexpr AssetPath BOSS_TEXTURE_PATH{ "..\\Assets\\Models\\_station-red.jpg" };
+
 ObjectShipChunk::ObjectShipChunk(GameObjectType type, Play3d::Vector3f position) : GameObject(type, position)
 {
 	// Switch - MESH
@@ -9,27 +20,27 @@ ObjectShipChunk::ObjectShipChunk(GameObjectType type, Play3d::Vector3f position)
 	{
 		// Player ship chunks
 		case TYPE_PLAYER_CHUNK_CORE:
-			m_meshId = GetObjectManager()->GetMesh("..\\Assets\\Models\\_fighter-chunk-core.obj");
+			m_meshId = GetObjectManager()->GetMesh(PLAYER_CORE_MESH_PATH);
 			break;
 		case TYPE_PLAYER_CHUNK_WING_L:
-			m_meshId = GetObjectManager()->GetMesh("..\\Assets\\Models\\_fighter-chunk-wingL.obj");
+			m_meshId = GetObjectManager()->GetMesh(PLAYER_WING_L_MESH_PATH);
 			break;
 		case TYPE_PLAYER_CHUNK_WING_R:
-			m_meshId = GetObjectManager()->GetMesh("..\\Assets\\Models\\_fighter-chunk-wingR.obj");
+			m_meshId = GetObjectManager()->GetMesh(PLAYER_WING_R_MESH_PATH);
 			break;
 
 		// Boss ship chunks
 		case TYPE_BOSS_CHUNK_CORE:
-			m_meshId = GetObjectManager()->GetMesh("..\\Assets\\Models\\_station-chunk-core.obj");
+			m_meshId = GetObjectManager()->GetMesh(BOSS_CORE_MESH_PATH);
 			break;
 		case TYPE_BOSS_CHUNK_LEFT:
-			m_meshId = GetObjectManager()->GetMesh("..\\Assets\\Models\\_station-chunk-left.obj");
+			m_meshId = GetObjectManager()->GetMesh(BOSS_LEFT_MESH_PATH);
 			break;
 		case TYPE_BOSS_CHUNK_RIGHT:
-			m_meshId = GetObjectManager()->GetMesh("..\\Assets\\Models\\_station-chunk-right.obj");
+			m_meshId = GetObjectManager()->GetMesh(BOSS_RIGHT_MESH_PATH);
 			break;
 		case TYPE_BOSS_CHUNK_LOWER:
-			m_meshId = GetObjectManager()->GetMesh("..\\Assets\\Models\\_station-chunk-lower.obj");
+			m_meshId = GetObjectManager()->GetMesh(BOSS_LOWER_MESH_PATH);
 			break;
 	}
 
@@ -39,7 +50,7 @@ ObjectShipChunk::ObjectShipChunk(GameObjectType type, Play3d::Vector3f position)
 	case TYPE_PLAYER_CHUNK_CORE:
 	case TYPE_PLAYER_CHUNK_WING_L:
 	case TYPE_PLAYER_CHUNK_WING_R:
-		m_materialId = GetObjectManager()->GetMaterial("..\\Assets\\Models\\_fighter-blue.jpg");
+		m_materialId = GetObjectManager()->GetMaterial(PLAYER_TEXTURE_PATH);
 		m_lifetime = 1.f;
 		break;
 
@@ -47,7 +58,7 @@ ObjectShipChunk::ObjectShipChunk(GameObjectType type, Play3d::Vector3f position)
 	case TYPE_BOSS_CHUNK_LEFT:
 	case TYPE_BOSS_CHUNK_RIGHT:
 	case TYPE_BOSS_CHUNK_LOWER:
-		m_materialId = GetObjectManager()->GetMaterial("..\\Assets\\Models\\_station-red.jpg");
+		m_materialId = GetObjectManager()->GetMaterial(BOSS_TEXTURE_PATH);
 		m_lifetime = 5.f;
 		break;
 	}
@@ -55,7 +66,7 @@ ObjectShipChunk::ObjectShipChunk(GameObjectType type, Play3d::Vector3f position)
 
 void ObjectShipChunk::Update()
 {
-	m_lifetime -= System::GetDeltaTime();
+	m_lifetime -= GetSimDeltaTime();
 	if(m_lifetime <= 0.f)
 	{
 		Destroy();
@@ -1,12 +1,35 @@
 #include "ParticleEmitter.h"
-#include "UtilityFunctions.h"
+#include "ParticleKernels.h"
+#include "EmitterRegistry.h"
+
+ParticleEmitter::ParticleEmitter()
+{
+	m_random.Seed(EmitterRegistry::Get()->Register(this));
+}
+
+ParticleEmitter::~ParticleEmitter()
+{
+	EmitterRegistry::Get()->Unregister(this);
+}
+
+void ParticleEmitter::Reseed()
+{
+	EmitterRegistry::Get()->WaitTicks();
+	m_random.Seed(EmitterRegistry::Get()->NextSeed());
+}
 
 // Helper functions
 void ParticleEmitter::ApplySettings(const ParticleEmitterSettings& rSettings) 
 {	
 	m_settings = rSettings;
-	m_particles.reserve(m_settings.capacity);
-	srand(time(nullptr));
+	m_capacity = (size_t)std::max(m_settings.capacity, 0);
+	for (std::vector<float>* pStream : { &m_posX, &m_posY, &m_posZ, &m_velX, &m_velY, &m_velZ, &m_timeAlive })
+	{
+		pStream->assign(m_capacity, 0.f);
+	}
+	m_head = 0;
+	m_count = 0;
+	m_queuedTickCount = 0;
 }
 
 void ParticleEmitter::Prewarm()
@@ -20,61 +43,109 @@ void ParticleEmitter::Prewarm()
 
 void ParticleEmitter::Tick(float customTime)
 {
-	float deltaTime = (customTime == 0.f ? Play3d::System::GetDeltaTime() : customTime);
+	Step(customTime == 0.f ? Play3d::System::GetDeltaTime() : customTime, m_position);
+}
+
+void ParticleEmitter::QueueTick(float deltaTime)
+{
+	if (m_queuedTickCount == MAX_QUEUED_TICKS)
+	{
+		// Fold into the last tick rather than lose the time
+		m_queuedTicks[MAX_QUEUED_TICKS - 1].deltaTime += deltaTime;
+		m_queuedTicks[MAX_QUEUED_TICKS - 1].origin = m_position;
+		return;
+	}
+	m_queuedTicks[m_queuedTickCount++] = { deltaTime, m_position };
+}
 
+void ParticleEmitter::RunQueuedTicks()
+{
+	for (int i = 0; i < m_queuedTickCount; i++)
+	{
+		Step(m_queuedTicks[i].deltaTime, m_queuedTicks[i].origin);
+	}
+	m_queuedTickCount = 0;
+}
+
+void ParticleEmitter::Step(float deltaTime, const Play3d::Vector3f& origin)
+{
 	// Emit new particles based on timing config
 	m_timerEmit -= deltaTime;
 	if (m_timerEmit < 0 || m_settings.emitWaitMax <= 0.f)
 	{
-		m_timerEmit = RandValueInRange(m_settings.emitWaitMin, m_settings.emitWaitMax);
-
-		for (int i = 0; i < m_settings.particlesPerEmit; i++)
-		{
-			if (m_particles.size() >= m_settings.capacity)
-			{
-				break;
-			}
-
-			m_particles.push_back(Particle());
-			Particle& p = m_particles.back();
+		m_timerEmit = m_random.NextInRange(m_settings.emitWaitMin, m_settings.emitWaitMax);
 
-			p.pos.x = (m_settings.particlesRelativeToEmitter ? 0 : m_position.x) + RandValueInRange(m_settings.emitterMinExtents.x, m_settings.emitterMaxExtents.x);
-			p.pos.y = (m_settings.particlesRelativeToEmitter ? 0 : m_position.y) + RandValueInRange(m_settings.emitterMinExtents.y, m_settings.emitterMaxExtents.y);
-			p.pos.z = (m_settings.particlesRelativeToEmitter ? 0 : m_position.z) + RandValueInRange(m_settings.emitterMinExtents.z, m_settings.emitterMaxExtents.z);
-
-			p.velocity.x = RandValueInRange(m_settings.particleMinVelocity.x, m_settings.particleMaxVelocity.x);
-			p.velocity.y = RandValueInRange(m_settings.particleMinVelocity.y, m_settings.particleMaxVelocity.y);
-			p.velocity.z = RandValueInRange(m_settings.particleMinVelocity.z, m_settings.particleMaxVelocity.z);
-		}
+		// The burst lands in at most two runs of the ring
+		size_t spawnCount = std::min((size_t)std::max(m_settings.particlesPerEmit, 0), m_capacity - m_count);
+		size_t spawnStart = GetSlot(m_count);
+		size_t firstRunCount = std::min(spawnCount, m_capacity - spawnStart);
+		SpawnRun(spawnStart, firstRunCount, origin);
+		SpawnRun(0, spawnCount - firstRunCount, origin);
+		m_count += spawnCount;
 	}
 
 	#ifdef _DEBUG
-	m_debugMaxParticleCount = std::max(m_debugMaxParticleCount, m_particles.size());
+	m_debugMaxParticleCount = std::max(m_debugMaxParticleCount, m_count);
 	#endif
 
-	// Update existing particles
-	for (int i = m_particles.size() - 1; i >= 0; i--)
-	{
-		Particle& p{m_particles[i]};
-		p.pos += (p.velocity * deltaTime);
-		p.timeAlive += deltaTime;
+	// Update existing particles, which occupy at most two runs of the ring. The expired ones are always the oldest,
+	// so the count the kernel returns is how far to advance m_head.
+	ParticleKernels::Streams streams{ m_posX.data(), m_posY.data(), m_posZ.data(), m_velX.data(), m_velY.data(), m_velZ.data(), m_timeAlive.data() };
+	size_t firstRunEnd = std::min(m_head + m_count, m_capacity);
+	size_t expired = ParticleKernels::Integrate(streams, m_head, firstRunEnd, deltaTime, m_settings.particleLifetime);
+	expired += ParticleKernels::Integrate(streams, 0, m_count - (firstRunEnd - m_head), deltaTime, m_settings.particleLifetime);
 
-		if (p.timeAlive > m_settings.particleLifetime)
-		{
-			m_particles.erase(m_particles.begin() + i);
-		}
+	m_head = GetSlot(expired);
+	m_count -= expired;
+}
+
+// One batched fill per component for the whole run
+void ParticleEmitter::SpawnRun(size_t begin, size_t count, const Play3d::Vector3f& origin)
+{
+	if (count == 0)
+	{
+		return;
 	}
+
+	const Play3d::Vector3f offset = m_settings.particlesRelativeToEmitter ? Play3d::Vector3f(0.f, 0.f, 0.f) : origin;
+	const Play3d::Vector3f& minExtents = m_settings.emitterMinExtents;
+	const Play3d::Vector3f& maxExtents = m_settings.emitterMaxExtents;
+	m_random.FillInRange(&m_posX[begin], count, offset.x + minExtents.x, offset.x + maxExtents.x);
+	m_random.FillInRange(&m_posY[begin], count, offset.y + minExtents.y, offset.y + maxExtents.y);
+	m_random.FillInRange(&m_posZ[begin], count, offset.z + minExtents.z, offset.z + maxExtents.z);
+
+	m_random.FillInRange(&m_velX[begin], count, m_settings.particleMinVelocity.x, m_settings.particleMaxVelocity.x);
+	m_random.FillInRange(&m_velY[begin], count, m_settings.particleMinVelocity.y, m_settings.particleMaxVelocity.y);
+	m_random.FillInRange(&m_velZ[begin], count, m_settings.particleMinVelocity.z, m_settings.particleMaxVelocity.z);
+
+	std::fill(&m_timeAlive[begin], &m_timeAlive[begin] + count, 0.f);
 }
 
 void ParticleEmitter::Draw() const
 {
-	for (const Particle& p : m_particles)
+	// Written straight into the primitive batch, oldest first, one ring run at a time
+	Play3d::u32 reserved = 0;
+	Play3d::Graphics::PrimitiveVertex* pVertices = Play3d::Graphics::ReservePoints((Play3d::u32)m_count, reserved);
+
+	const Play3d::Vector3f offset = m_settings.particlesRelativeToEmitter ? m_position : Play3d::Vector3f(0.f, 0.f, 0.f);
+	size_t firstRunCount = std::min((size_t)reserved, m_capacity - m_head);
+	size_t runStart[2] = { m_head, 0 };
+	size_t runCount[2] = { firstRunCount, reserved - firstRunCount };
+	for (int run = 0; run < 2; run++)
 	{
-		Play3d::Graphics::DrawPoint((m_settings.particlesRelativeToEmitter ? m_position : Play3d::Vector3f(0.f, 0.f, 0.f)) + p.pos, m_settings.particleColour);
+		const size_t start = runStart[run];
+		for (size_t i = 0; i < runCount[run]; i++)
+		{
+			pVertices->position = Play3d::Vector3f(m_posX[start + i] + offset.x, m_posY[start + i] + offset.y, m_posZ[start + i] + offset.z);
+			pVertices->colour = m_settings.particleColour;
+			pVertices++;
+		}
 	}
 }
 
 void ParticleEmitter::DestroyAll()
 {
-	m_particles.clear();
+	m_head = 0;
+	m_count = 0;
+	m_queuedTickCount = 0;
 }
\ No newline at end of file
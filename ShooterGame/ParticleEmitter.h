@@ -1,12 +1,6 @@
 #pragma once
 #include "Play3d.h"
-
-struct Particle
-{
-	Play3d::Vector3f pos{0.f, 0.f, 0.f};
-	Play3d::Vector3f velocity{ 0.f, 0.f, 0.f };
-	float timeAlive{0.f};
-};
+#include "Random.h"
 
 struct ParticleEmitterSettings
 {
@@ -31,19 +25,61 @@ struct ParticleEmitterSettings
 class ParticleEmitter
 {
 public:
+	ParticleEmitter();
+	~ParticleEmitter();
+	PLAY_NONCOPYABLE(ParticleEmitter);
+
 	void ApplySettings(const ParticleEmitterSettings& rSettings);
+	void Reseed(); // takes the registry's next seed, for emitters which outlive a reset of the simulation
 
 	void Prewarm(); // slow
 	void Tick(float customTime = 0.f); // may wish to trigger manually rather than every frame, hence avoiding 'update'
 	void Draw() const;
 	void DestroyAll();
 
+	// Deferred Tick() from the current m_position, run with every other emitter's by EmitterRegistry::KickTicks()
+	void QueueTick(float deltaTime);
+	void RunQueuedTicks();
+
+	size_t GetParticleCount() const { return m_count; }
+	Play3d::Vector3f GetParticlePosition(size_t i) const { size_t slot = GetSlot(i); return Play3d::Vector3f(m_posX[slot], m_posY[slot], m_posZ[slot]); }
+
 	Play3d::Vector3f m_position{0.f, 0.f, 0.f};
 
 private:
-	std::vector<Particle> m_particles;
+	void Step(float deltaTime, const Play3d::Vector3f& origin);
+	void SpawnRun(size_t begin, size_t count, const Play3d::Vector3f& origin);
+
+	// Enough for a frame which runs the most simulation ticks
+	static constexpr int MAX_QUEUED_TICKS{ 8 };
+
+	struct QueuedTick
+	{
+		float deltaTime;
+		Play3d::Vector3f origin;
+	};
+
+	// Fixed ring of m_capacity particles, oldest at m_head, stored as one array per component for the integration
+	// kernel. Every particle has the same lifetime and ages at the same rate, so they expire in the order they were
+	// emitted and expiry is just advancing m_head.
+	size_t GetSlot(size_t i) const { size_t slot = m_head + i; return slot < m_capacity ? slot : slot - m_capacity; }
+
+	std::vector<float> m_posX;
+	std::vector<float> m_posY;
+	std::vector<float> m_posZ;
+	std::vector<float> m_velX;
+	std::vector<float> m_velY;
+	std::vector<float> m_velZ;
+	std::vector<float> m_timeAlive;
+	size_t m_capacity{0};
+	size_t m_head{0};
+	size_t m_count{0};
 	ParticleEmitterSettings m_settings;
 	float m_timerEmit{0.f};
+	Random m_random;
+
+	QueuedTick m_queuedTicks[MAX_QUEUED_TICKS];
+	int m_queuedTickCount{0};
 
 	#ifdef _DEBUG
 	size_t m_debugMaxParticleCount{0};
@@ -0,0 +1,98 @@
+#include "ParticleKernels.h"
+#include "CollisionKernels.h"
+#include <immintrin.h>
+
+using namespace Play3d;
+
+// MSVC accepts AVX intrinsics in any function, GCC/Clang need the target enabled per function
+#if defined(_MSC_VER)
+#define KERNEL_TARGET_AVX2
+#else
+#define KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace ParticleKernels
+{
+	// Scalar version, used directly and for the tails of the vector loops
+	static size_t IntegrateScalar(const Streams& s, size_t begin, size_t end, float deltaTime, float lifetime)
+	{
+		size_t expired = 0;
+		for (size_t i = begin; i < end; i++)
+		{
+			s.posX[i] += s.velX[i] * deltaTime;
+			s.posY[i] += s.velY[i] * deltaTime;
+			s.posZ[i] += s.velZ[i] * deltaTime;
+			s.age[i] += deltaTime;
+			expired += (s.age[i] > lifetime) ? 1 : 0;
+		}
+		return expired;
+	}
+
+	// The vector versions count expired lanes by subtracting the all-ones compare masks (-1 per expired lane) from a
+	// per-lane counter, summed once at the end
+	static size_t IntegrateSSE(const Streams& s, size_t begin, size_t end, float deltaTime, float lifetime, size_t* pExpired)
+	{
+		const __m128 dt = _mm_set1_ps(deltaTime);
+		const __m128 maxAge = _mm_set1_ps(lifetime);
+		__m128i expired = _mm_setzero_si128();
+
+		size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			_mm_storeu_ps(s.posX + i, _mm_add_ps(_mm_loadu_ps(s.posX + i), _mm_mul_ps(_mm_loadu_ps(s.velX + i), dt)));
+			_mm_storeu_ps(s.posY + i, _mm_add_ps(_mm_loadu_ps(s.posY + i), _mm_mul_ps(_mm_loadu_ps(s.velY + i), dt)));
+			_mm_storeu_ps(s.posZ + i, _mm_add_ps(_mm_loadu_ps(s.posZ + i), _mm_mul_ps(_mm_loadu_ps(s.velZ + i), dt)));
+
+			__m128 age = _mm_add_ps(_mm_loadu_ps(s.age + i), dt);
+			_mm_storeu_ps(s.age + i, age);
+			expired = _mm_sub_epi32(expired, _mm_castps_si128(_mm_cmpgt_ps(age, maxAge)));
+		}
+
+		alignas(16) u32 lanes[4];
+		_mm_store_si128((__m128i*)lanes, expired);
+		*pExpired = (size_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+		return i;
+	}
+
+	KERNEL_TARGET_AVX2 static size_t IntegrateAVX2(const Streams& s, size_t begin, size_t end, float deltaTime, float lifetime, size_t* pExpired)
+	{
+		const __m256 dt = _mm256_set1_ps(deltaTime);
+		const __m256 maxAge = _mm256_set1_ps(lifetime);
+		__m256i expired = _mm256_setzero_si256();
+
+		size_t i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			_mm256_storeu_ps(s.posX + i, _mm256_add_ps(_mm256_loadu_ps(s.posX + i), _mm256_mul_ps(_mm256_loadu_ps(s.velX + i), dt)));
+			_mm256_storeu_ps(s.posY + i, _mm256_add_ps(_mm256_loadu_ps(s.posY + i), _mm256_mul_ps(_mm256_loadu_ps(s.velY + i), dt)));
+			_mm256_storeu_ps(s.posZ + i, _mm256_add_ps(_mm256_loadu_ps(s.posZ + i), _mm256_mul_ps(_mm256_loadu_ps(s.velZ + i), dt)));
+
+			__m256 age = _mm256_add_ps(_mm256_loadu_ps(s.age + i), dt);
+			_mm256_storeu_ps(s.age + i, age);
+			expired = _mm256_sub_epi32(expired, _mm256_castps_si256(_mm256_cmp_ps(age, maxAge, _CMP_GT_OQ)));
+		}
+
+		alignas(32) u32 lanes[8];
+		_mm256_store_si256((__m256i*)lanes, expired);
+		*pExpired = (size_t)lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+		return i;
+	}
+
+	size_t Integrate(const Streams& streams, size_t begin, size_t end, float deltaTime, float lifetime)
+	{
+		size_t expired = 0;
+		size_t done = begin;
+		switch (CollisionKernels::GetIsa())
+		{
+		case CollisionKernels::Isa::AVX2:
+			done = IntegrateAVX2(streams, begin, end, deltaTime, lifetime, &expired);
+			break;
+		case CollisionKernels::Isa::SSE:
+			done = IntegrateSSE(streams, begin, end, deltaTime, lifetime, &expired);
+			break;
+		default:
+			break;
+		}
+		return expired + IntegrateScalar(streams, done, end, deltaTime, lifetime);
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "Play3d.h"
+
+// Particle integration over separate x/y/z/vx/vy/vz/age arrays: pos += velocity * deltaTime, age += deltaTime.
+// Runs on the ISA selected by CollisionKernels::SetIsa(). Every path performs the same float operations in the same
+// order (no FMA), so results are bit-identical whichever one runs.
+namespace ParticleKernels
+{
+	struct Streams
+	{
+		float* posX;
+		float* posY;
+		float* posZ;
+		const float* velX;
+		const float* velY;
+		const float* velZ;
+		float* age;
+	};
+
+	// Integrates elements [begin, end) and returns how many of them are older than lifetime afterwards
+	size_t Integrate(const Streams& streams, size_t begin, size_t end, float deltaTime, float lifetime);
+}
@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <functional>
 #include <atomic>
+#ifndef PLAY_HEADLESS
 #include <windows.h>
 #include <wincodec.h>
 #include <dxgi1_3.h>
@@ -30,6 +31,110 @@
 #include <wrl/client.h>
 #include <hidusage.h>
 #include <xaudio2.h>
+#else
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdarg>
+#include <csignal>
+#endif
+
+//-----------------------------------------------------------
+// Play3dImpl\HeadlessPlatform.h
+
+#ifdef PLAY_HEADLESS
+// Headless builds have no Win32, D3D11 or XAudio2. The few platform names which appear in the public API are
+// declared here so that client code compiles unchanged; none of them are ever dereferenced.
+
+#define __debugbreak() raise(SIGTRAP)
+
+using UINT = unsigned int;
+using BYTE = unsigned char;
+
+struct ID3D11Device;
+struct ID3D11DeviceContext;
+struct ID3D11DeviceChild;
+struct ID3D11Buffer;
+struct ID3D11Texture2D;
+struct ID3D11ShaderResourceView;
+struct ID3D11SamplerState;
+struct ID3D11RasterizerState;
+
+struct D3D_SHADER_MACRO
+{
+	const char* Name;
+	const char* Definition;
+};
+
+struct WAVEFORMATEX {};
+struct XAUDIO2_BUFFER {};
+
+namespace Microsoft
+{
+	namespace WRL
+	{
+		template<class T> class ComPtr
+		{
+		public:
+			T* Get() const { return nullptr; }
+		};
+	}
+}
+
+// Virtual key codes, matching WinUser.h
+#define VK_BACK 0x08
+#define VK_TAB 0x09
+#define VK_RETURN 0x0D
+#define VK_SHIFT 0x10
+#define VK_CONTROL 0x11
+#define VK_MENU 0x12
+#define VK_ESCAPE 0x1B
+#define VK_SPACE 0x20
+#define VK_LEFT 0x25
+#define VK_UP 0x26
+#define VK_RIGHT 0x27
+#define VK_DOWN 0x28
+#define VK_F1 0x70
+#define VK_F2 0x71
+#define VK_F3 0x72
+#define VK_F4 0x73
+
+// Bounds checked CRT functions used by client code
+inline int strcpy_s(char* pDest, size_t destSize, const char* pSrc)
+{
+	if (!pDest || destSize == 0) { return -1; }
+	snprintf(pDest, destSize, "%s", pSrc);
+	return 0;
+}
+
+inline int strcat_s(char* pDest, size_t destSize, const char* pSrc)
+{
+	if (!pDest || destSize == 0) { return -1; }
+	size_t len = strnlen(pDest, destSize);
+	snprintf(pDest + len, destSize - len, "%s", pSrc);
+	return 0;
+}
+
+inline int vsprintf_s(char* pDest, size_t destSize, const char* pFmtStr, va_list args)
+{
+	return vsnprintf(pDest, destSize, pFmtStr, args);
+}
+
+inline int sprintf_s(char* pDest, size_t destSize, const char* pFmtStr, ...)
+{
+	va_list args;
+	va_start(args, pFmtStr);
+	int result = vsnprintf(pDest, destSize, pFmtStr, args);
+	va_end(args);
+	return result;
+}
+
+inline int fopen_s(FILE** ppFile, const char* pFilename, const char* pMode)
+{
+	*ppFile = fopen(pFilename, pMode);
+	return *ppFile ? 0 : -1;
+}
+#endif
 
 //-----------------------------------------------------------
 
@@ -912,7 +1017,26 @@ namespace Play3d
 {
 	namespace Resources
 	{
+		// Resource names are mostly file paths, so they are compared with case folded and '\' read as '/'. Every
+		// spelling of a file then finds the same resource, however it was named when loaded.
+		constexpr char NormaliseNameChar(char c)
+		{
+			return c == '\\' ? '/' : (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+		}
 
+		inline std::string NormaliseName(std::string_view name)
+		{
+			std::string normalised(name);
+			for (char& c : normalised)
+			{
+				c = NormaliseNameChar(c);
+			}
+			return normalised;
+		}
+
+		// Owns every object of one resource type. Objects are built in place in fixed size chunks of slots, so they never
+		// move and a lookup is one chunk pointer load. An id packs the slot index with the slot's generation, which is
+		// bumped on release: debug builds assert on an id whose object has since been released, IsAlive() checks it always.
 		template <typename T> class ResourceManager
 		{
 			ResourceManager()
@@ -921,83 +1045,151 @@ namespace Play3d
 			~ResourceManager()
 			{
 				ReleaseAll();
+				for (u32 i = 0; i < m_slotCount; i += kChunkSize)
+				{
+					delete m_chunks[i >> kChunkBits];
+				}
 			}
 		public:
 			static ResourceManager& Instance() { static ResourceManager s_instance; return s_instance; }
 
 			template<typename ... ConstructorArgs> IdKey<T> Create(ConstructorArgs ... args)
 			{ 
-
-				T* p = new T(args ...);
-				PLAY_ASSERT(p);
-				if (!p)
-				{
-					return IdKey<T>();
-				}
+				u32 index;
 				if (m_freelist.empty())
 				{
-					u32 index = (u32)m_objects.size();
-					m_objects.push_back(p);
-
-					return IdKey<T>(index);
+					index = m_slotCount++;
+					PLAY_ASSERT_MSG(index < kMaxSlots, "Too many resources of one type");
+					if ((index & kChunkMask) == 0)
+					{
+						m_chunks[index >> kChunkBits] = new Chunk;
+					}
 				}
 				else
 				{
-					u32 index = m_freelist.back();
+					index = m_freelist.back();
 					m_freelist.pop_back();
-
-					m_objects[index] = p;
-					return IdKey<T>(index);
 				}
+
+				Chunk& rChunk = GetChunk(index);
+				u32 slot = index & kChunkMask;
+				new (rChunk.m_storage[slot]) T(args ...);
+				rChunk.m_bAlive[slot] = true;
+				return IdKey<T>(MakeValue(index, rChunk.m_generation[slot]));
 			}
 
 			void Release(IdKey<T> id)
 			{
-				if(id.IsValid())
+				PLAY_ASSERT_MSG(id.IsInvalid() || IsAlive(id), "Releasing a resource that was already released");
+				if(IsAlive(id))
 				{
-					u32 index = id.GetValue();
-					T* p = m_objects.at(index);
-					PLAY_ASSERT(p);
-;					m_objects.at(index) = nullptr;
-					m_freelist.push_back(index);
-					delete p;
+					u32 value = id.GetValue();
+					ReleaseSlot(value & kIndexMask);
+
+					for (auto it = m_namedObjectLUT.begin(); it != m_namedObjectLUT.end();)
+					{
+						it = it->second == value ? m_namedObjectLUT.erase(it) : std::next(it);
+					}
 				}
 			}
 
 			IdKey<T> Find(std::string_view name) const
-			{ 
-				return IdKey<T>();
+			{
+				auto it = m_namedObjectLUT.find(NormaliseName(name));
+				return it != m_namedObjectLUT.end() ? IdKey<T>(it->second) : IdKey<T>();
+			}
+
+			// Returns false for an invalid id and for one whose object has been released
+			bool IsAlive(IdKey<T> id) const
+			{
+				if (id.IsInvalid())
+				{
+					return false;
+				}
+				u32 index = id.GetValue() & kIndexMask;
+				if (index >= m_slotCount)
+				{
+					return false;
+				}
+				const Chunk& rChunk = GetChunk(index);
+				u32 slot = index & kChunkMask;
+				return rChunk.m_bAlive[slot] && MakeValue(index, rChunk.m_generation[slot]) == id.GetValue();
 			}
 
 			T* GetPtr(IdKey<T> id) const
 			{
 				if (id.IsValid())
 				{
-					u32 index = id.GetValue();
-					return m_objects.at(index);
+					PLAY_ASSERT_MSG(IsAlive(id), "Resource id is stale or out of range");
+					u32 index = id.GetValue() & kIndexMask;
+					return reinterpret_cast<T*>(GetChunk(index).m_storage[index & kChunkMask]);
 				}
 				return nullptr;
 			}
 
-			void AddAlias(std::string_view name, IdKey<T> id) {}
+			void AddAlias(std::string_view name, IdKey<T> id)
+			{
+				if (id.IsValid())
+				{
+					m_namedObjectLUT[NormaliseName(name)] = id.GetValue();
+				}
+			}
 
 			void ReleaseAll()
 			{
-				for (u32 i = 0; i < (u32)m_objects.size(); ++i)
+				for (u32 i = 0; i < m_slotCount; ++i)
 				{
-					if(m_objects[i])
+					if(GetChunk(i).m_bAlive[i & kChunkMask])
 					{
-						delete m_objects[i];
-						m_objects[i] = nullptr;
-						m_freelist.push_back(i);
+						ReleaseSlot(i);
 					}
 				}
+				m_namedObjectLUT.clear();
 			}
 
 		private:
-			std::vector<T*> m_objects;
+			static constexpr u32 kIndexBits = 20;
+			static constexpr u32 kIndexMask = (1u << kIndexBits) - 1;
+			static constexpr u32 kGenerationMask = (1u << (32 - kIndexBits)) - 1;
+			// The last index is left unused, with the top generation it would spell the invalid id
+			static constexpr u32 kMaxSlots = kIndexMask;
+			static constexpr u32 kChunkBits = 8;
+			static constexpr u32 kChunkSize = 1u << kChunkBits;
+			static constexpr u32 kChunkMask = kChunkSize - 1;
+
+			// The objects are packed together, apart from the state only Create and Release touch
+			struct Chunk
+			{
+				alignas(T) u8 m_storage[kChunkSize][sizeof(T)];
+				u32 m_generation[kChunkSize] = {};
+				bool m_bAlive[kChunkSize] = {};
+			};
+
+			static u32 MakeValue(u32 index, u32 generation)
+			{
+				return (generation << kIndexBits) | index;
+			}
+
+			Chunk& GetChunk(u32 index) const
+			{
+				return *m_chunks[index >> kChunkBits];
+			}
+
+			void ReleaseSlot(u32 index)
+			{
+				Chunk& rChunk = GetChunk(index);
+				u32 slot = index & kChunkMask;
+				PLAY_ASSERT(rChunk.m_bAlive[slot]);
+				reinterpret_cast<T*>(rChunk.m_storage[slot])->~T();
+				rChunk.m_bAlive[slot] = false;
+				rChunk.m_generation[slot] = (rChunk.m_generation[slot] + 1) & kGenerationMask;
+				m_freelist.push_back(index);
+			}
+
+			Chunk* m_chunks[(kMaxSlots >> kChunkBits) + 1] = {};
+			u32 m_slotCount = 0;
 			std::vector<uint32_t> m_freelist;
-			std::unordered_map<std::string, uint32_t> m_namedObjectLUT;
+			std::unordered_map<std::string, uint32_t> m_namedObjectLUT; // by NormaliseName()
 		};
 
 		template <typename T>
@@ -1012,13 +1204,31 @@ namespace Play3d
 			return ResourceManager<T>::Instance().Create(args ...);
 		}
 
-		class AsyncLoadingTask {};
+		class AsyncLoadingTask;
 
+		// Starts reading and decoding every asset in an asset pack on the loader threads. Each line of the pack is
+		// "mesh <path> [scale]", "texture <path>", "sound <path>" or "shader <path>", and '#' starts a comment. Assets
+		// are named by their path for FindAsset(), and any already loaded are skipped. A shader line compiles the file's
+		// VS_Main and PS_Main, with MAX_LIGHTS defined and debug info, named "<path>_VS" and "<path>_PS", plus
+		// VS_MainInstanced as "<path>_VSI" when the file has one.
 		IdKey<AsyncLoadingTask> AsyncLoadAssets(std::string_view pathToAssetPack);
 
+		// Creates the resources for whatever the loader threads have finished, on the calling thread. Returns true once
+		// every asset is done, at which point the task is released.
 		bool AssetsLoaded(IdKey<AsyncLoadingTask> hAsyncLoad);
 
+		// Loads a pack and waits for it, taking over any task already loading the same pack
 		result_t LoadAssets(std::string_view pathToAssetPack);
+
+		struct AssetLoadTime
+		{
+			std::string m_path;
+			f32 m_loadMs; // reading and decoding, on a loader thread
+			f32 m_createMs; // creating the resource, on the main thread
+		};
+
+		// Every asset the packs have loaded so far, in the order they were created
+		const std::vector<AssetLoadTime>& GetAssetLoadTimes();
 	}
 }
 
@@ -1094,6 +1304,12 @@ namespace Play3d
 		const MouseState& GetMouseState();
 		void CaptureMouse(bool bEnable);
 
+#ifdef PLAY_HEADLESS
+		// Headless builds have no keyboard; keys are held down or released by the client, e.g. from a script.
+		// Pressed state is derived at BeginFrame, as on Windows.
+		void SetKeyState(u32 keycode, bool bDown);
+#endif
+
 	}
 }
 
@@ -1368,6 +1584,7 @@ namespace Play3d
 		enum class StreamType
 		{
 			INDEX, // u32 indices
+			INDEX16, // u16 indices
 
 			POSITION, // float3
 			COLOUR, // u32/colour
@@ -1427,6 +1644,7 @@ namespace Play3d
 
 			u32 m_indexCount;
 			u32 m_vertexCount;
+			u32 m_indexStride;
 		};
 	}
 }
@@ -1460,8 +1678,28 @@ namespace Play3d
 
 			result_t ParseObjFormat(std::string_view objString, ColourValue coloure, f32 fScale);
 
+			// Merges vertices whose position, normal, uv and colour are bitwise identical
+			void WeldVertices();
+
+			// Reorders the triangles for the post-transform vertex cache, then the vertices into first use order
+			void OptimiseVertexCache();
+
+			u32 GetVertexCount() const { return (u32)m_positions.size(); }
+			const std::vector<Vector3f>& GetPositions() const { return m_positions; }
+			const std::vector<Vector3f>& GetNormals() const { return m_normals; }
+			const std::vector<Vector2f>& GetUVs() const { return m_uvs; }
+			const std::vector<ColourValue>& GetColours() const { return m_colours; }
+			const std::vector<u32>& GetIndices() const { return m_indices; }
+
+			// CreateMesh() uses 16 bit indices whenever the vertex count allows
+			u32 GetIndexStride() const { return m_positions.size() <= 0x10000 ? sizeof(u16) : sizeof(u32); }
+
 			MeshId CreateMesh();
 
+			// Writes the streams CreateMesh() would upload as a .p3m mesh cache
+			result_t SaveMeshCache(const char* filePath, u64 sourceHash) const;
+			void BuildMeshCache(u64 sourceHash, std::vector<u8>& fileOut) const;
+
 			void Reset();
 		private:
 
@@ -1520,6 +1758,7 @@ namespace Play3d
 			ShaderType m_type;
 			std::string m_name; // optional debug annotation
 			std::string m_hlslCode;
+			std::string m_sourcePath; // optional, the file m_hlslCode came from: #include "file" is found relative to it
 			std::string m_entryPoint;
 			std::vector<D3D_SHADER_MACRO> m_defines;
 			u32 m_flags; // from ShaderCompilationFlags
@@ -1686,6 +1925,7 @@ namespace Play3d
 			MaterialStateSettings m_state;
 			ShaderId m_VertexShader;
 			ShaderId m_PixelShader;
+			ShaderId m_InstancedVertexShader; // optional, for DrawMeshInstanced()
 			TextureId m_texture[kMaxMaterialTextureSlots];
 			SamplerId m_sampler[kMaxMaterialTextureSlots];
 			const void* m_pConstantData = nullptr;
@@ -1704,10 +1944,13 @@ namespace Play3d
 			void SetupTextureBindings(ID3D11Device* pDevice, const TextureId* pTextureId, const SamplerId* pSamplerId);
 		private:
 			friend class Graphics_Impl;
+			friend struct MeshDrawState;
 			ComPtr<ID3D11RasterizerState> m_pRasterState;
 			ComPtr<ID3D11Buffer> m_pMaterialConstants;
 			ShaderId m_VertexShader;
 			ShaderId m_PixelShader;
+			ShaderId m_InstancedVertexShader;
+			bool m_bInstancing = false; // simple materials always can, using the framework's shaders
 			TextureId m_texture[kMaxMaterialTextureSlots];
 			SamplerId m_sampler[kMaxMaterialTextureSlots];
 		};
@@ -1734,6 +1977,24 @@ namespace Play3d
 
 		SurfaceSize GetDisplaySurfaceSize();
 
+#ifdef PLAY_HEADLESS
+		// Headless builds record what would have been submitted to the GPU instead of drawing it
+		struct HeadlessStats
+		{
+			u64 m_frameCount;
+			u64 m_meshDrawCount;
+			u64 m_materialChangeCount;
+			u64 m_primitiveBatchCount;
+			u64 m_primitiveVertexCount;
+			u64 m_textDrawCount;
+			u64 m_meshBindCount; // pipeline bindings the mesh draws made
+			u64 m_redundantMeshBindCount; // and those left out because they were already in place
+			u64 m_instancedDrawCount; // mesh draws which drew more than one instance
+			u64 m_instanceCount; // and the instances they drew
+		};
+		const HeadlessStats& GetHeadlessStats();
+#endif
+
 		void SetDepthTarget(TextureId textureId);
 		void SetRenderTarget(TextureId textureId);
 
@@ -1755,8 +2016,17 @@ namespace Play3d
 		void SetViewMatrix(const Matrix4x4f& m);
 		void SetProjectionMatrix(const Matrix4x4f& m);
 
+		struct PrimitiveVertex
+		{
+			Vector3f position;
+			ColourValue colour;
+		};
+
 		void BeginPrimitiveBatch();
 		void DrawPoint(const Vector3f& v1, ColourValue colour);
+		// Appends up to count points to the batch for the caller to fill in, saving a call per point. Returns the first
+		// of them; reservedOut is how many fit, which may be fewer than count.
+		PrimitiveVertex* ReservePoints(u32 count, u32& reservedOut);
 		void DrawLine(const Vector3f& v1, const Vector3f& v2, ColourValue colour);
 		void DrawLine(const Vector3f& v1, const Vector3f& v2, ColourValue c1, ColourValue c2);
 		void DrawTriangle(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, ColourValue colour);
@@ -1764,11 +2034,41 @@ namespace Play3d
 		void DrawQuad(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, const Vector3f& v4, ColourValue colour);
 		void DrawQuad(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, const Vector3f& v4, ColourValue c1, ColourValue c2, ColourValue c3, ColourValue c4);
 		void EndPrimitiveBatch();
+#ifdef PLAY_HEADLESS
+		// The vertex buffer as the last EndPrimitiveBatch() flushed it: its points, then lines, then triangles
+		const PrimitiveVertex* GetHeadlessPrimitiveVertices(u32& countOut);
+#endif
 
 		void DrawMesh(MeshId hMesh, const Matrix4x4f& transform);
 
 		void SetMaterial(MaterialId materialId);
 
+		// Between these, SetMaterial() and DrawMesh() are recorded instead of drawn. EndMeshQueue() draws them sorted, so
+		// draws which share shaders, then material, then mesh come together and rebind as little state as possible.
+		// Draws which share all three keep their order; otherwise the depth test alone decides what ends up in front.
+		// A queue of over a million draws is drawn in parts as it fills, each sorted on its own.
+		void BeginMeshQueue();
+		void EndMeshQueue();
+
+		// What DrawMeshInstanced() writes to the instance buffer for each instance. Instanced vertex shaders read it as
+		// StructuredBuffer<InstanceData> at register t4, indexed by SV_InstanceID.
+		struct InstanceData
+		{
+			Matrix4x4f worldMtx;
+			Matrix4x4f normalMtx; // inverse_transpose(world)
+		};
+		constexpr u32 kInstanceBufferSlot = 4;
+
+		// Draws the mesh at each transform with the current material, in one draw call when the material has an instanced
+		// vertex shader and one draw per transform when it doesn't. The mesh queue draws runs of draws which share a
+		// material and mesh this way.
+		void DrawMeshInstanced(MeshId hMesh, const Matrix4x4f* pTransforms, u32 count);
+
+#ifdef PLAY_HEADLESS
+		// The instance buffer as the last instanced draw filled it
+		const std::vector<InstanceData>& GetHeadlessInstanceData();
+#endif
+
 		void SetLightPosition(u32 index, const Vector3f& vPosition);
 		void SetLightDirection(u32 index, const Vector3f& vDirection);
 		void SetLightColour(u32 index, ColourValue colour);
@@ -1784,6 +2084,8 @@ namespace Play3d
 		MeshId CreatePlatonicOctahedron(ColourValue colour = Colour::White);
 
 		MeshId CreateMeshFromObjString(std::string_view objString, ColourValue colour = Colour::White, f32 fScale = 1.0f);
+		// Loads from the binary cache beside the OBJ (filePath + ".p3m") when it matches the OBJ, colour and scale.
+		// Otherwise parses the OBJ and writes the cache for next time.
 		MeshId CreateMeshFromObjFile(const char* filePath, ColourValue colour = Colour::White, f32 fScale = 1.0f);
 
 
@@ -1911,6 +2213,58 @@ namespace Play3d
 
 		void* LoadFileData(const char* filePath, size_t& sizeOut);
 		void ReleaseFileData(void* pMemory);
+		// Reads the whole file straight into dataOut, for callers which keep the bytes; dataOut is left empty on failure
+		result_t LoadFileData(const char* filePath, std::vector<u8>& dataOut);
+		// Writes under a temporary name and renames over filePath, so readers never see a partial file
+		result_t SaveFileData(const char* filePath, const void* pData, size_t size);
+
+		// Read-only view of a whole file, paged in on demand; nullptr if it can't be opened or is empty
+		const void* MapFile(const char* filePath, size_t& sizeOut);
+		void UnmapFile(const void* pMemory, size_t size);
+
+		// Size and last write time, for spotting stale derived files; false if the file doesn't exist
+		bool GetFileStamp(const char* filePath, u64& sizeOut, u64& writeTimeOut);
+
+		// Succeeds if the directory already exists; the parent must exist
+		result_t MakeDirectory(const char* path);
+	}
+}
+
+
+
+//-----------------------------------------------------------
+// Play3dImpl\JobsApi.h
+
+namespace Play3d
+{
+	namespace Jobs
+	{
+		// A batch of work started by Dispatch(). The data it touches must be left alone until Wait() returns.
+		class JobGroup
+		{
+		public:
+			JobGroup() = default;
+			PLAY_NONCOPYABLE(JobGroup);
+
+			bool IsBusy() const { return m_pending.load(std::memory_order_acquire) != 0; }
+
+			std::function<void(u32 begin, u32 end)> m_function;
+			std::atomic<u32> m_pending{ 0 };
+		};
+
+		static constexpr u32 kDefaultWorkerCount = ~0u; // one per hardware thread, less the calling thread
+
+		// Called by System::Initialise/Shutdown; may be called again in between to change the number of workers
+		result_t Initialise(u32 workerCount = kDefaultWorkerCount);
+		result_t Shutdown();
+		u32 GetWorkerCount();
+
+		// Splits [0, count) into ranges of up to grainSize and calls function on each from the worker threads.
+		// The group must not be busy.
+		void Dispatch(JobGroup& group, u32 count, u32 grainSize, std::function<void(u32 begin, u32 end)> function);
+
+		// Runs queued ranges on the calling thread until the group has finished
+		void Wait(JobGroup& group);
 	}
 }
 
@@ -1942,24 +2296,181 @@ namespace Play3d
 ////////////////// BEGIN IMPLEMENTATION SECTION //////////////////////////
 #include <cstdarg>
 #include <cstdio>
+#include <charconv>
+#ifndef PLAY_HEADLESS
 #include <windows.h>
 #include <Xinput.h>
-#include <charconv>
 #include <d3dcompiler.h>
+#else
+#include <cstdlib>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
 
 //-----------------------------------------------------------
+// Play3dImpl\MeshDrawState_Impl.h
 
 
-//-----------------------------------------------------------
-// Play3dImpl\AudioApi.cpp
 
+namespace Play3d
+{
+	namespace Graphics
+	{
+		// The pipeline bindings a mesh draw needs, one bit each
+		namespace MeshBinding
+		{
+			enum Type : u32
+			{
+				BLEND = 1 << 0,
+				RASTER = 1 << 1,
+				VERTEX_SHADER = 1 << 2,
+				PIXEL_SHADER = 1 << 3,
+				MATERIAL_CONSTANTS = 1 << 4,
+				TEXTURES = 1 << 5,
+				SAMPLERS = 1 << 6,
+				INPUT_LAYOUT = 1 << 7,
+				BUFFERS = 1 << 8,
+				FRAME_CONSTANTS = 1 << 9,
+				DRAW_CONSTANTS = 1 << 10,
+				LIGHT_CONSTANTS = 1 << 11,
+				TOPOLOGY = 1 << 12,
+
+				ALL = (1 << 13) - 1,
+
+				// Overwritten by drawing a primitive batch or text, so the next mesh draw binds them again
+				PRIMITIVE_BATCH = INPUT_LAYOUT | VERTEX_SHADER | PIXEL_SHADER | BUFFERS | TOPOLOGY,
+				TEXT = BLEND | VERTEX_SHADER | PIXEL_SHADER | INPUT_LAYOUT | BUFFERS | FRAME_CONSTANTS | TEXTURES | SAMPLERS | TOPOLOGY,
+			};
+			constexpr u32 kCount = 13;
+
+			inline u32 Count(u32 bindings)
+			{
+				u32 count = 0;
+				for (; bindings; bindings &= bindings - 1)
+				{
+					++count;
+				}
+				return count;
+			}
+		}
+
+		// What a mesh draw binds, named by resource so it can be compared with what is already bound. An invalid
+		// material or shader stands for the fallback the backend draws with in its place.
+		struct MeshDrawState
+		{
+			MeshDrawState() {}
+			// An instanced draw binds the material's instanced vertex shader in place of its vertex shader
+			MeshDrawState(MaterialId materialId, MeshId meshId, bool bInstanced = false);
 
+			static bool HasInstancing(MaterialId materialId);
 
+			// The bindings which differ from rBound, plus any not in validBindings
+			u32 GetChangedBindings(const MeshDrawState& rBound, u32 validBindings) const;
 
-//-----------------------------------------------------------
-// Play3dImpl\Audio_Impl.h
+			MaterialId m_material;
+			ShaderId m_vertexShader;
+			ShaderId m_pixelShader;
+			TextureId m_texture[kMaxMaterialTextureSlots];
+			SamplerId m_sampler[kMaxMaterialTextureSlots];
+			MeshId m_mesh;
+		};
+
+		inline MeshDrawState::MeshDrawState(MaterialId materialId, MeshId meshId, bool bInstanced)
+			: m_mesh(meshId)
+		{
+			const Material* pMaterial = Resources::ResourceManager<Material>::Instance().GetPtr(materialId);
+			if (pMaterial)
+			{
+				m_material = materialId;
+				m_vertexShader = bInstanced ? pMaterial->m_InstancedVertexShader : pMaterial->m_VertexShader;
+				m_pixelShader = pMaterial->m_PixelShader;
+				for (u32 i = 0; i < kMaxMaterialTextureSlots; ++i)
+				{
+					if (pMaterial->m_texture[i].IsValid())
+					{
+						m_texture[i] = pMaterial->m_texture[i];
+						m_sampler[i] = pMaterial->m_sampler[i];
+					}
+				}
+			}
+		}
+
+		inline bool MeshDrawState::HasInstancing(MaterialId materialId)
+		{
+			const Material* pMaterial = Resources::ResourceManager<Material>::Instance().GetPtr(materialId);
+			return pMaterial && pMaterial->m_bInstancing;
+		}
+
+		// Keeps normals perpendicular to the surface under non-uniform scale. A degenerate transform (e.g. zero scale) falls
+		// back to its upper 3x3, as there is no surface left to light.
+		inline Matrix4x4f MakeNormalMatrix(const Matrix4x4f& world)
+		{
+			Matrix3x3f upper = world.Upper3x3();
+			if (Determinant(upper) != 0.f)
+			{
+				upper = Transpose(Inverse(upper));
+			}
+			return Matrix4x4f(upper, Vector3f(0, 0, 0));
+		}
+
+		inline void PackInstanceData(const Matrix4x4f* pTransforms, u32 count, InstanceData* pOut)
+		{
+			for (u32 i = 0; i < count; ++i)
+			{
+				pOut[i].worldMtx = pTransforms[i];
+				pOut[i].normalMtx = MakeNormalMatrix(pTransforms[i]);
+			}
+		}
+
+		inline u32 MeshDrawState::GetChangedBindings(const MeshDrawState& rBound, u32 validBindings) const
+		{
+			u32 changed = MeshBinding::ALL & ~validBindings;
+			if (m_material != rBound.m_material)
+			{
+				changed |= MeshBinding::RASTER | MeshBinding::MATERIAL_CONSTANTS;
+			}
+			if (m_vertexShader != rBound.m_vertexShader)
+			{
+				changed |= MeshBinding::VERTEX_SHADER;
+			}
+			if (m_pixelShader != rBound.m_pixelShader)
+			{
+				changed |= MeshBinding::PIXEL_SHADER;
+			}
+			for (u32 i = 0; i < kMaxMaterialTextureSlots; ++i)
+			{
+				if (m_texture[i] != rBound.m_texture[i])
+				{
+					changed |= MeshBinding::TEXTURES;
+				}
+				if (m_sampler[i] != rBound.m_sampler[i])
+				{
+					changed |= MeshBinding::SAMPLERS;
+				}
+			}
+			if (m_mesh != rBound.m_mesh)
+			{
+				changed |= MeshBinding::BUFFERS;
+			}
+			return changed;
+		}
+	}
+}
 
+//-----------------------------------------------------------
+// Play3dImpl\Headless_Impl.h
+#ifdef PLAY_HEADLESS
 
+// Headless stand-ins for the platform backends. They keep the same interface as the D3D11, XInput and XAudio2
+// versions so the API layers on top of them are shared; implementations are in Headless_Impl.cpp.
 
 namespace Play3d
 {
@@ -1970,48 +2481,216 @@ namespace Play3d
 			PLAY_NONCOPYABLE(Audio_Impl);
 			PLAY_SINGLETON_INTERFACE(Audio_Impl);
 
-			Audio_Impl();
-			~Audio_Impl();
+			Audio_Impl() {}
+			~Audio_Impl() {}
+		public:
+			void BeginFrame() {}
+
+			void EndFrame() {}
+
+			VoiceId PlaySound(SoundId soundId, f32 fGain, f32 fPan) { return VoiceId(); }
+
+			void StopSound(VoiceId voiceId) {}
+		};
+	}
+
+	namespace Input
+	{
+		class Input_Impl
+		{
+			PLAY_NONCOPYABLE(Input_Impl);
+			PLAY_SINGLETON_INTERFACE(Input_Impl);
+
+			Input_Impl();
+			~Input_Impl() {}
 		public:
 			void BeginFrame();
 
-			void EndFrame();
+			void EndFrame() {}
 
-			VoiceId PlaySound(SoundId soundId, f32 fGain, f32 fPan);
+			bool IsKeyDown(u32 keycode);
 
-			void StopSound(VoiceId voiceId);
+			bool IsKeyUp(u32 keycode);
 
-		private:
-			u32 AllocateVoice();
-			void ReleaseVoice(u32 slot);
+			bool IsKeyPressed(u32 keycode);
 
-			class AudioVoiceCB : public IXAudio2VoiceCallback
-			{
-			public:
-				AudioVoiceCB() : m_bFinished(false) {}
-				~AudioVoiceCB() {}
-				void OnStreamEnd() { AllowRelease(); }
-				void OnVoiceProcessingPassEnd() {}
-				void OnVoiceProcessingPassStart(UINT32 SamplesRequired) {}
-				void OnBufferEnd(void* pBufferContext) {}
-				void OnBufferStart(void* pBufferContext) {}
-				void OnLoopEnd(void* pBufferContext) {}
-				void OnVoiceError(void* pBufferContext, HRESULT Error) { AllowRelease(); }
+			bool IsPadButtonDown(u32 padId, ButtonId button) { return false; }
 
-				bool IsFinished() const { return m_bFinished; }
-				void Reset() { m_bFinished = false; }
-				void AllowRelease() { m_bFinished = true; }
-			private:
-				std::atomic<bool> m_bFinished;
-			};
+			bool IsPadButtonPressed(u32 padId, ButtonId button) { return false; }
 
-			struct InternalVoice
-			{
-				IXAudio2SourceVoice* m_pVoice;
-				AudioVoiceCB* m_pCallback;
-			};
+			f32 GetPadAxis(u32 padId, AxisId axis) { return 0.f; }
 
-		private:
+			const MouseState& GetMouseState() { return m_mouseState; }
+
+			void CaptureMouse(bool bEnable) {}
+
+			void SetKeyState(u32 keycode, bool bDown);
+		private:
+			static constexpr u32 kKeyCount = 256;
+
+			MouseState m_mouseState;
+
+			bool m_scriptKeyState[kKeyCount]; // written by SetKeyState, latched at BeginFrame
+			bool m_keyState[kKeyCount];
+			bool m_prevKeyState[kKeyCount];
+		};
+	}
+
+	namespace Graphics
+	{
+		class PrimitiveBatch;
+
+		class Graphics_Impl
+		{
+			PLAY_NONCOPYABLE(Graphics_Impl);
+		public:
+			static Graphics_Impl& Instance() { return *ms_pInstance; }
+			static void Initialise();
+			static void Destroy();
+
+			result_t PostInitialise() { return RESULT_OK; }
+			result_t BeginFrame();
+			result_t EndFrame() { return RESULT_OK; }
+
+			void Flush() {}
+
+			ID3D11Device* GetDevice() const { return nullptr; }
+			ID3D11DeviceContext* GetDeviceContext() const { return nullptr; }
+
+			PrimitiveBatch* AllocatePrimitiveBatch();
+
+			void DrawPrimitveBatch(PrimitiveBatch* pBatch);
+
+			void DrawMesh(MeshId hMesh, const Mesh* pMesh);
+
+			void DrawMeshInstanced(MeshId hMesh, const Mesh* pMesh, const Matrix4x4f* pTransforms, u32 count);
+
+			void SetViewport(const Viewport& v) {}
+
+			void SetViewMatrix(const Matrix4x4f& m) {}
+
+			void SetProjectionMatrix(const Matrix4x4f& m) {}
+
+			void SetWorldMatrix(const Matrix4x4f& m) {}
+
+			void SetMaterial(MaterialId materialId);
+
+			SurfaceSize GetDisplaySurfaceSize() const { return { kSurfaceWidth, kSurfaceHeight }; }
+
+			void SetLightPosition(u32 index, const Vector3f& vPosition) {}
+
+			void SetLightDirection(u32 index, const Vector3f& vDirection) {}
+
+			void SetLightColour(u32 index, ColourValue colour) {}
+
+			void RecordTextDraw()
+			{
+				++m_stats.m_textDrawCount;
+				m_validMeshBindings &= ~MeshBinding::TEXT;
+			}
+
+			const HeadlessStats& GetStats() const { return m_stats; }
+
+			const std::vector<InstanceData>& GetInstanceData() const { return m_mockInstanceBuffer; }
+
+			const PrimitiveVertex* GetPrimitiveVertices(u32& countOut) const;
+
+		private:
+			Graphics_Impl();
+			~Graphics_Impl();
+
+			// Same as the default window size, so view bounds match the windowed game
+			static constexpr u32 kSurfaceWidth = 1920;
+			static constexpr u32 kSurfaceHeight = 1080;
+
+			static Graphics_Impl* ms_pInstance;
+
+			MaterialId m_activeMaterial;
+
+			// What the last mesh draw bound, and which of those bindings are still in place
+			MeshDrawState m_boundMeshState;
+			u32 m_validMeshBindings;
+
+			// Stands in for the GPU instance buffer, holding the last DrawMeshInstanced() call's data
+			std::vector<InstanceData> m_mockInstanceBuffer;
+
+			std::vector<PrimitiveBatch*> m_primitiveBatchRing;
+			u32 m_nNextPrimitiveBatch;
+			PrimitiveBatch* m_pFlushedPrimitiveBatch; // the last one drawn
+
+			HeadlessStats m_stats;
+		};
+	}
+}
+
+#endif // PLAY_HEADLESS
+
+//-----------------------------------------------------------
+
+
+//-----------------------------------------------------------
+// Play3dImpl\AudioApi.cpp
+
+
+
+
+//-----------------------------------------------------------
+// Play3dImpl\Audio_Impl.h
+
+
+
+#ifndef PLAY_HEADLESS
+namespace Play3d
+{
+	namespace Audio
+	{
+		class Audio_Impl
+		{
+			PLAY_NONCOPYABLE(Audio_Impl);
+			PLAY_SINGLETON_INTERFACE(Audio_Impl);
+
+			Audio_Impl();
+			~Audio_Impl();
+		public:
+			void BeginFrame();
+
+			void EndFrame();
+
+			VoiceId PlaySound(SoundId soundId, f32 fGain, f32 fPan);
+
+			void StopSound(VoiceId voiceId);
+
+		private:
+			u32 AllocateVoice();
+			void ReleaseVoice(u32 slot);
+
+			class AudioVoiceCB : public IXAudio2VoiceCallback
+			{
+			public:
+				AudioVoiceCB() : m_bFinished(false) {}
+				~AudioVoiceCB() {}
+				void OnStreamEnd() { AllowRelease(); }
+				void OnVoiceProcessingPassEnd() {}
+				void OnVoiceProcessingPassStart(UINT32 SamplesRequired) {}
+				void OnBufferEnd(void* pBufferContext) {}
+				void OnBufferStart(void* pBufferContext) {}
+				void OnLoopEnd(void* pBufferContext) {}
+				void OnVoiceError(void* pBufferContext, HRESULT Error) { AllowRelease(); }
+
+				bool IsFinished() const { return m_bFinished; }
+				void Reset() { m_bFinished = false; }
+				void AllowRelease() { m_bFinished = true; }
+			private:
+				std::atomic<bool> m_bFinished;
+			};
+
+			struct InternalVoice
+			{
+				IXAudio2SourceVoice* m_pVoice;
+				AudioVoiceCB* m_pCallback;
+			};
+
+		private:
 
 			ComPtr<IXAudio2> m_pXAudio2;
 			IXAudio2MasteringVoice* m_pMasterVoice;
@@ -2020,6 +2699,7 @@ namespace Play3d
 		};
 	}
 }
+#endif // PLAY_HEADLESS
 
 namespace Play3d
 {
@@ -2037,6 +2717,7 @@ namespace Play3d
 				desc.m_pData = pData;
 				desc.m_sizeBytes = sizeBytes;
 				soundId = Resources::CreateAsset<Sound>(desc);
+				System::ReleaseFileData(pData); // the sound keeps its own copy of the samples
 			}
 			return soundId;
 		}
@@ -2057,6 +2738,7 @@ namespace Play3d
 
 //-----------------------------------------------------------
 // Play3dImpl\Audio_Impl.cpp
+#ifndef PLAY_HEADLESS
 
 
 
@@ -2195,6 +2877,8 @@ namespace Play3d
 
 
 
+#endif // PLAY_HEADLESS
+
 //-----------------------------------------------------------
 // Play3dImpl\DebugApi.cpp
 
@@ -2208,7 +2892,9 @@ namespace Play3d
 	{
 		void Put(const char* pStr)
 		{
+#ifndef PLAY_HEADLESS
 			OutputDebugStringA(pStr);
+#endif
 			::fputs(pStr, stdout);
 		}
 
@@ -2437,12 +3123,6 @@ namespace Play3d
 	namespace Graphics
 	{
 
-		struct PrimitiveVertex
-		{
-			Vector3f position;
-			ColourValue colour;
-		};
-
 		class PrimitiveBatch
 		{
 		public:
@@ -2450,6 +3130,7 @@ namespace Play3d
 			~PrimitiveBatch();
 
 			void AppendPoint(const Vector3f& v1, ColourValue c1);
+			PrimitiveVertex* ReservePoints(u32 count, u32& reservedOut);
 			void AppendLine(const Vector3f& v1, const Vector3f& v2, ColourValue c1, ColourValue c2);
 			void AppendTriangle(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, ColourValue c1, ColourValue c2, ColourValue c3);
 
@@ -2462,9 +3143,15 @@ namespace Play3d
 			void DrawLines(ID3D11DeviceContext* pContext);
 
 			void DrawTriangles(ID3D11DeviceContext* pContext);
+
+			u32 GetFlushedVertexCount() const { return m_pointVertexCount + m_lineVertexCount + m_triangleVertexCount; }
+#ifdef PLAY_HEADLESS
+			const PrimitiveVertex* GetMockVertexBuffer() const { return m_mockVertexBuffer.data(); }
+#endif
 		private:
 		
-			std::vector<PrimitiveVertex> m_points; // Point List
+			std::vector<PrimitiveVertex> m_points; // Point List, sized to m_maxVertexCount up front so it can be written in place
+			u32 m_pointCount;
 			std::vector<PrimitiveVertex> m_lines; // Line List
 			std::vector<PrimitiveVertex> m_triangles; // Triangle List
 			ComPtr<ID3D11Buffer> m_pVertexBuffer; // single vertex buffer, each list appended with an offset up to 3 draw calls are made.
@@ -2473,7 +3160,9 @@ namespace Play3d
 			u32 m_pointVertexCount;
 			u32 m_lineVertexCount;
 			u32 m_triangleVertexCount;
-
+#ifdef PLAY_HEADLESS
+			std::vector<PrimitiveVertex> m_mockVertexBuffer; // stands in for the mapped buffer so Flush costs the same copy
+#endif
 		};
 	}
 }
@@ -2482,6 +3171,7 @@ namespace Play3d
 
 //-----------------------------------------------------------
 // Play3dImpl\ShaderConstantBuffer_Impl.h
+#ifndef PLAY_HEADLESS
 
 
 
@@ -2561,11 +3251,12 @@ namespace Play3d
 					u32 m_useTexture0 : 1;
 					u32 m_useLighting : 1;
 					u32 m_lightCount : 2;
+					u32 m_instanced : 1; // vertex shader reads the world matrix from the instance buffer
 				} m_bits;
 				u32 m_value;
 			};
 			
-			static constexpr u32 kUsedBits = 5;
+			static constexpr u32 kUsedBits = 6;
 			static constexpr u32 kPermutations = 1 << kUsedBits;
 			static constexpr u32 kMaxLights = 4;
 		};
@@ -2596,7 +3287,9 @@ namespace Play3d
 
 			void DrawPrimitveBatch(PrimitiveBatch* pBatch);
 
-			void DrawMesh(const Mesh* pMesh);
+			void DrawMesh(MeshId hMesh, const Mesh* pMesh);
+
+			void DrawMeshInstanced(MeshId hMesh, const Mesh* pMesh, const Matrix4x4f* pTransforms, u32 count);
 
 			void SetViewport(const Viewport& v);
 
@@ -2652,6 +3345,10 @@ namespace Play3d
 
 			void UpdateConstantBuffers();
 
+			void BindMeshState(const MeshDrawState& state, const Mesh* pMesh);
+
+			result_t ReserveInstanceBuffer(u32 count);
+
 			result_t Resize(u32 width, u32 height);
 
 			static LRESULT CALLBACK MainWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
@@ -2727,6 +3424,16 @@ namespace Play3d
 
 			MaterialId m_activeMaterial;
 
+			// What the last mesh draw bound, and which of those bindings are still in place
+			MeshDrawState m_boundMeshState;
+			u32 m_validMeshBindings;
+
+			// Per instance data for DrawMeshInstanced(), grown on demand
+			static constexpr u32 kMinInstanceCapacity = 256;
+			ComPtr<ID3D11Buffer> m_pInstanceBuffer;
+			ComPtr<ID3D11ShaderResourceView> m_pInstanceSRV;
+			u32 m_instanceCapacity;
+
 			ComPtr<ID3D11RasterizerState> m_pFallbackRasterState;
 
 			ComPtr<ID3D11BlendState> m_pBlendStateOpaque;
@@ -2985,105 +3692,472 @@ namespace Play3d
 
 
 
-//-----------------------------------------------------------
-// Play3dImpl\GraphicsApi.cpp
-
-
+#endif // PLAY_HEADLESS
 
+//-----------------------------------------------------------
+// Play3dImpl\MeshCache_Impl.h
 
 namespace Play3d
 {
 	namespace Graphics
 	{
-		struct InternalState
-		{
-			PrimitiveBatch* m_pCurrentPrimitiveBatch;
+		// .p3m layout: this header, then each stream in MeshCacheStream order at a 16 byte aligned offset, holding
+		// exactly what MeshBuilder::CreateMesh() uploads.
+		enum MeshCacheStream
+		{
+			MESH_CACHE_POSITION,
+			MESH_CACHE_COLOUR,
+			MESH_CACHE_NORMAL,
+			MESH_CACHE_UV,
+			MESH_CACHE_INDEX,
+			MESH_CACHE_STREAM_COUNT
 		};
-		static InternalState s_internalState;
 
-		TextureId GetTempSurface(u32 width, u32 height, SurfaceFormat format)
+		struct MeshCacheHeader
 		{
-			return TextureId();
-		}
+			static constexpr u32 kMagic = 0x4D335050; // "PP3M"
+			static constexpr u32 kVersion = 2; // bump when the layout or the mesh building changes
 
-		TextureId GetDisplaySurface()
-		{
-			return TextureId();
-		}
+			u32 m_magic;
+			u32 m_version;
+			u64 m_sourceHash;
+			u64 m_fileSize;
+			u32 m_vertexCount;
+			u32 m_indexCount;
+			u32 m_indexStride; // 2 or 4 bytes
+			u32 m_streamOffsets[MESH_CACHE_STREAM_COUNT];
+			u32 m_streamSizes[MESH_CACHE_STREAM_COUNT];
+		};
 
-		SurfaceSize GetDisplaySurfaceSize()
+		// Identifies the inputs a cache was built from: the OBJ's size and write time, the build parameters and the format
+		inline u64 GetMeshCacheHash(u64 sourceSize, u64 sourceWriteTime, ColourValue colour, f32 fScale)
 		{
-			return { Graphics_Impl::Instance().GetDisplaySurfaceSize() };
+			u64 hash = 0xcbf29ce484222325ull; // FNV-1a
+			auto mix = [&hash](const void* pData, size_t size)
+			{
+				for (size_t i = 0; i < size; ++i)
+				{
+					hash = (hash ^ ((const u8*)pData)[i]) * 0x100000001b3ull;
+				}
+			};
+			u32 version = MeshCacheHeader::kVersion;
+			u32 colourValue = colour.as_u32();
+			mix(&version, sizeof(version));
+			mix(&sourceSize, sizeof(sourceSize));
+			mix(&sourceWriteTime, sizeof(sourceWriteTime));
+			mix(&colourValue, sizeof(colourValue));
+			mix(&fScale, sizeof(fScale));
+			return hash;
 		}
+	}
+}
 
-		void SetDepthTarget(TextureId textureId)
-		{
+//-----------------------------------------------------------
+// Play3dImpl\ShaderCache_Impl.h
 
-		}
+namespace Play3d
+{
+	namespace Graphics
+	{
+		// .p3s layout: this header, then a ShaderIncludeRecord and path for each file the compile #included, then the
+		// bytecode. Files are named after the key, so a changed shader gets a new file. Included files aren't known until
+		// the compile has run, so they can't be in the key; instead each record is checked against the file on load.
+		struct ShaderCacheHeader
+		{
+			static constexpr u32 kMagic = 0x53335050; // "PP3S"
+			static constexpr u32 kVersion = 2;
+
+			u32 m_magic;
+			u32 m_version;
+			u64 m_key;
+			u64 m_byteCodeSize;
+			u32 m_includeCount;
+			u32 m_includesSize; // bytes of records and paths
+		};
 
-		void SetRenderTarget(TextureId textureId)
+		struct ShaderIncludeRecord
 		{
+			u64 m_hash;
+			u32 m_pathSize; // the path's characters follow
+		};
 
-		}
+		static constexpr const char* kShaderCacheDirectory = "ShaderCache";
 
-		void SetViewport(const Viewport& viewport)
+		inline u64 HashShaderBytes(const void* pData, size_t size)
 		{
-			Graphics_Impl::Instance().SetViewport(viewport);
+			u64 hash = 0xcbf29ce484222325ull; // FNV-1a
+			for (size_t i = 0; i < size; ++i)
+			{
+				hash = (hash ^ ((const u8*)pData)[i]) * 0x100000001b3ull;
+			}
+			return hash;
 		}
 
-		void SetViewMatrix(const Matrix4x4f& m)
+		// A file the compiler opened for an #include, and the hash of what it read
+		struct ShaderInclude
 		{
-			Graphics_Impl::Instance().SetViewMatrix(m);
-		}
+			std::string m_path;
+			u64 m_hash;
+		};
 
-		void SetProjectionMatrix(const Matrix4x4f& m)
+		// Reads the files a compile #includes, each relative to the file including it, and keeps them until the compile is
+		// done. Every file read is recorded, so the cached result can be checked against them later.
+		class ShaderIncludeTracker
 		{
-			Graphics_Impl::Instance().SetProjectionMatrix(m);
-		}
+		public:
+			explicit ShaderIncludeTracker(std::string_view sourcePath) : m_sourceDirectory(GetDirectory(sourcePath)) {}
 
-		void BeginPrimitiveBatch()
-		{
-			if (!s_internalState.m_pCurrentPrimitiveBatch)
+			// pParentData is what an earlier Open() returned for the including file, or nullptr for the shader itself
+			bool Open(const char* pFileName, const void* pParentData, const void*& pDataOut, size_t& sizeOut)
 			{
-				s_internalState.m_pCurrentPrimitiveBatch = Graphics_Impl::Instance().AllocatePrimitiveBatch();
+				std::string directory = m_sourceDirectory;
+				for (const OpenFile& rFile : m_files)
+				{
+					if (pParentData && rFile.m_data.data() == pParentData)
+					{
+						directory = GetDirectory(rFile.m_path);
+					}
+				}
+
+				OpenFile file;
+				file.m_path = directory + pFileName;
+				if (RESULT_OK != System::LoadFileData(file.m_path.c_str(), file.m_data))
+				{
+					return false;
+				}
+				m_includes.push_back({ file.m_path, HashShaderBytes(file.m_data.data(), file.m_data.size()) });
+				m_files.push_back(std::move(file)); // moving a vector keeps its buffer, so returned data stays put
+
+				pDataOut = m_files.back().m_data.data();
+				sizeOut = m_files.back().m_data.size();
+				return true;
 			}
-		}
 
-		void DrawPoint(const Vector3f& v1, ColourValue colour)
-		{
-			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
-			s_internalState.m_pCurrentPrimitiveBatch->AppendPoint(v1, colour);
-		}
+			const std::vector<ShaderInclude>& GetIncludes() const { return m_includes; }
 
-		void DrawLine(const Vector3f& v1, const Vector3f& v2, ColourValue colour)
-		{
-			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
-			s_internalState.m_pCurrentPrimitiveBatch->AppendLine(v1, v2, colour, colour);
-		}
+		private:
+			struct OpenFile
+			{
+				std::string m_path;
+				std::vector<u8> m_data;
+			};
 
-		void DrawLine(const Vector3f& v1, const Vector3f& v2, ColourValue c1, ColourValue c2)
-		{
-			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
-			s_internalState.m_pCurrentPrimitiveBatch->AppendLine(v1, v2, c1, c2);
-		}
+			static std::string GetDirectory(std::string_view path)
+			{
+				size_t end = path.find_last_of("\\/");
+				return end == std::string_view::npos ? std::string() : std::string(path.substr(0, end + 1));
+			}
 
-		void DrawTriangle(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, ColourValue colour)
-		{
-			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
-			s_internalState.m_pCurrentPrimitiveBatch->AppendTriangle(v1, v2, v3, colour, colour, colour);
-		}
+			std::string m_sourceDirectory;
+			std::vector<OpenFile> m_files;
+			std::vector<ShaderInclude> m_includes;
+		};
 
-		void DrawTriangle(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, ColourValue c1, ColourValue c2, ColourValue c3)
+		// Identifies a compile: the source and where it was read from, defines, entry point, stage and flags, plus the
+		// compiler and the format
+		u64 GetShaderCacheKey(const ShaderCompilerDesc& rDesc)
 		{
-			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
-			s_internalState.m_pCurrentPrimitiveBatch->AppendTriangle(v1, v2, v3, c1, c2, c3);
+			u64 hash = 0xcbf29ce484222325ull; // FNV-1a
+			auto mix = [&hash](const void* pData, size_t size)
+			{
+				for (size_t i = 0; i < size; ++i)
+				{
+					hash = (hash ^ ((const u8*)pData)[i]) * 0x100000001b3ull;
+				}
+			};
+			// Strings are length prefixed, so moving text between fields changes the key
+			auto mixString = [&mix](std::string_view str)
+			{
+				u64 size = str.size();
+				mix(&size, sizeof(size));
+				mix(str.data(), str.size());
+			};
+
+			u32 version = ShaderCacheHeader::kVersion;
+#ifndef PLAY_HEADLESS
+			u32 compilerVersion = D3D_COMPILER_VERSION;
+#else
+			u32 compilerVersion = 0;
+#endif
+			u32 type = (u32)rDesc.m_type;
+			mix(&version, sizeof(version));
+			mix(&compilerVersion, sizeof(compilerVersion));
+			mix(&type, sizeof(type));
+			mix(&rDesc.m_flags, sizeof(rDesc.m_flags));
+			mixString(rDesc.m_entryPoint);
+			for (const D3D_SHADER_MACRO& rDefine : rDesc.m_defines)
+			{
+				mixString(rDefine.Name ? rDefine.Name : "");
+				mixString(rDefine.Definition ? rDefine.Definition : "");
+			}
+			mixString(rDesc.m_hlslCode);
+			mixString(rDesc.m_sourcePath); // #include paths are relative to it
+			return hash;
 		}
 
-		void DrawQuad(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, const Vector3f& v4, ColourValue colour)
+		std::string GetShaderCachePath(u64 key)
 		{
-			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
-			s_internalState.m_pCurrentPrimitiveBatch->AppendTriangle(v1, v2, v3, colour, colour, colour);
-			s_internalState.m_pCurrentPrimitiveBatch->AppendTriangle(v2, v4, v3, colour, colour, colour);
+			char fileName[32];
+			sprintf_s(fileName, 32, "%016llx.p3s", (unsigned long long)key);
+			return std::string(kShaderCacheDirectory) + "\\" + fileName;
+		}
+
+		// False if there is no entry for the key, it is damaged, or a file it included has changed since
+		bool LoadCachedShader(u64 key, std::vector<u8>& byteCodeOut)
+		{
+			std::vector<u8> file;
+			if (RESULT_OK != System::LoadFileData(GetShaderCachePath(key).c_str(), file))
+			{
+				return false;
+			}
+
+			const ShaderCacheHeader* pHeader = (const ShaderCacheHeader*)file.data();
+			if (file.size() < sizeof(ShaderCacheHeader)
+				|| pHeader->m_magic != ShaderCacheHeader::kMagic
+				|| pHeader->m_version != ShaderCacheHeader::kVersion
+				|| pHeader->m_key != key
+				|| (u64)pHeader->m_includesSize + pHeader->m_byteCodeSize != file.size() - sizeof(ShaderCacheHeader))
+			{
+				return false;
+			}
+
+			const u8* pRecord = file.data() + sizeof(ShaderCacheHeader);
+			const u8* pRecordsEnd = pRecord + pHeader->m_includesSize;
+			for (u32 i = 0; i < pHeader->m_includeCount; ++i)
+			{
+				ShaderIncludeRecord record;
+				if ((size_t)(pRecordsEnd - pRecord) < sizeof(record))
+				{
+					return false;
+				}
+				memcpy(&record, pRecord, sizeof(record));
+				pRecord += sizeof(record);
+				if ((size_t)(pRecordsEnd - pRecord) < record.m_pathSize)
+				{
+					return false;
+				}
+				std::string path((const char*)pRecord, record.m_pathSize);
+				pRecord += record.m_pathSize;
+
+				std::vector<u8> include;
+				if (RESULT_OK != System::LoadFileData(path.c_str(), include) || HashShaderBytes(include.data(), include.size()) != record.m_hash)
+				{
+					return false;
+				}
+			}
+			if (pRecord != pRecordsEnd)
+			{
+				return false;
+			}
+
+			byteCodeOut.assign(pRecordsEnd, (const u8*)file.data() + file.size());
+			return true;
+		}
+
+		result_t SaveCachedShader(u64 key, const std::vector<u8>& byteCode, const std::vector<ShaderInclude>& includes)
+		{
+			if (RESULT_OK != System::MakeDirectory(kShaderCacheDirectory))
+			{
+				return RESULT_FAIL;
+			}
+
+			std::vector<u8> file(sizeof(ShaderCacheHeader));
+			for (const ShaderInclude& rInclude : includes)
+			{
+				ShaderIncludeRecord record = {};
+				record.m_hash = rInclude.m_hash;
+				record.m_pathSize = (u32)rInclude.m_path.size();
+				const u8* pRecord = (const u8*)&record;
+				file.insert(file.end(), pRecord, pRecord + sizeof(record));
+				file.insert(file.end(), rInclude.m_path.begin(), rInclude.m_path.end());
+			}
+
+			ShaderCacheHeader header;
+			header.m_magic = ShaderCacheHeader::kMagic;
+			header.m_version = ShaderCacheHeader::kVersion;
+			header.m_key = key;
+			header.m_byteCodeSize = byteCode.size();
+			header.m_includeCount = (u32)includes.size();
+			header.m_includesSize = (u32)(file.size() - sizeof(header));
+			memcpy(file.data(), &header, sizeof(header));
+
+			file.insert(file.end(), byteCode.begin(), byteCode.end());
+			return System::SaveFileData(GetShaderCachePath(key).c_str(), file.data(), file.size());
+		}
+
+		// The platform's compiler, run on a cache miss. Reports every file it #included.
+		result_t CompileHLSL(const ShaderCompilerDesc& rDesc, std::vector<u8>& byteCodeOut, std::vector<ShaderInclude>& includesOut);
+
+		result_t CompileShaderByteCode(const ShaderCompilerDesc& rDesc, std::vector<u8>& byteCodeOut)
+		{
+			u64 key = GetShaderCacheKey(rDesc);
+			if (LoadCachedShader(key, byteCodeOut))
+			{
+				return RESULT_OK;
+			}
+
+			std::vector<ShaderInclude> includes;
+			result_t result = CompileHLSL(rDesc, byteCodeOut, includes);
+			if (RESULT_OK == result)
+			{
+				// Failing to write the cache only costs the next run a compile
+				SaveCachedShader(key, byteCodeOut, includes);
+			}
+			return result;
+		}
+	}
+}
+
+//-----------------------------------------------------------
+// Play3dImpl\AssetLoader_Impl.h
+
+namespace Play3d
+{
+	namespace Graphics
+	{
+		// Safe on the loader threads: these read and decode files but create no resources
+		result_t LoadMeshCacheData(const char* filePath, ColourValue colour, f32 fScale, std::vector<u8>& cacheOut);
+		result_t DecodeImageFile(const char* pFilePath, u32& widthOut, u32& heightOut, std::vector<u8>& pixelsOut);
+
+		// From a .p3m image LoadMeshCacheData() has already checked
+		MeshId CreateMeshFromCacheData(const void* pData);
+
+		// Shader::Compile() without creating the shader, so safe on the loader threads too. Bytecode is cached on disk
+		// (see ShaderCache_Impl.h), so each shader is only compiled once across runs.
+		result_t CompileShaderByteCode(const ShaderCompilerDesc& rDesc, std::vector<u8>& byteCodeOut);
+	}
+}
+
+//-----------------------------------------------------------
+// Play3dImpl\GraphicsApi.cpp
+
+
+
+
+namespace Play3d
+{
+	namespace Graphics
+	{
+		struct QueuedMeshDraw
+		{
+			MaterialId m_materialId;
+			MeshId m_meshId;
+			Matrix4x4f m_transform;
+		};
+
+		struct InternalState
+		{
+			PrimitiveBatch* m_pCurrentPrimitiveBatch;
+			MaterialId m_activeMaterial;
+			bool m_bMeshQueueOpen;
+			std::vector<QueuedMeshDraw> m_meshQueue;
+			std::vector<u64> m_meshQueueKeys;
+			std::vector<Matrix4x4f> m_meshQueueTransforms; // one run's transforms, for DrawMeshInstanced()
+		};
+		static InternalState s_internalState;
+
+		// Mesh queue sort key, from the top: pixel shader, vertex shader, material and mesh, each the low bits of the
+		// resource's slot index, then the draw's place in the queue
+		static constexpr u32 kMeshQueueOrderBits = 20;
+		static constexpr u32 kMeshQueueCapacity = 1u << kMeshQueueOrderBits;
+
+		static u64 GetMeshQueueMaterialKey(MaterialId materialId)
+		{
+			MeshDrawState state(materialId, MeshId());
+			return ((u64)(state.m_pixelShader.GetValue() & 0xFF) << 56)
+				| ((u64)(state.m_vertexShader.GetValue() & 0xFF) << 48)
+				| ((u64)(state.m_material.GetValue() & 0x3FFF) << 34);
+		}
+
+		TextureId GetTempSurface(u32 width, u32 height, SurfaceFormat format)
+		{
+			return TextureId();
+		}
+
+		TextureId GetDisplaySurface()
+		{
+			return TextureId();
+		}
+
+		SurfaceSize GetDisplaySurfaceSize()
+		{
+			return { Graphics_Impl::Instance().GetDisplaySurfaceSize() };
+		}
+
+		void SetDepthTarget(TextureId textureId)
+		{
+
+		}
+
+		void SetRenderTarget(TextureId textureId)
+		{
+
+		}
+
+		void SetViewport(const Viewport& viewport)
+		{
+			Graphics_Impl::Instance().SetViewport(viewport);
+		}
+
+		void SetViewMatrix(const Matrix4x4f& m)
+		{
+			Graphics_Impl::Instance().SetViewMatrix(m);
+		}
+
+		void SetProjectionMatrix(const Matrix4x4f& m)
+		{
+			Graphics_Impl::Instance().SetProjectionMatrix(m);
+		}
+
+		void BeginPrimitiveBatch()
+		{
+			if (!s_internalState.m_pCurrentPrimitiveBatch)
+			{
+				s_internalState.m_pCurrentPrimitiveBatch = Graphics_Impl::Instance().AllocatePrimitiveBatch();
+			}
+		}
+
+		void DrawPoint(const Vector3f& v1, ColourValue colour)
+		{
+			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
+			s_internalState.m_pCurrentPrimitiveBatch->AppendPoint(v1, colour);
+		}
+
+		PrimitiveVertex* ReservePoints(u32 count, u32& reservedOut)
+		{
+			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
+			return s_internalState.m_pCurrentPrimitiveBatch->ReservePoints(count, reservedOut);
+		}
+
+		void DrawLine(const Vector3f& v1, const Vector3f& v2, ColourValue colour)
+		{
+			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
+			s_internalState.m_pCurrentPrimitiveBatch->AppendLine(v1, v2, colour, colour);
+		}
+
+		void DrawLine(const Vector3f& v1, const Vector3f& v2, ColourValue c1, ColourValue c2)
+		{
+			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
+			s_internalState.m_pCurrentPrimitiveBatch->AppendLine(v1, v2, c1, c2);
+		}
+
+		void DrawTriangle(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, ColourValue colour)
+		{
+			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
+			s_internalState.m_pCurrentPrimitiveBatch->AppendTriangle(v1, v2, v3, colour, colour, colour);
+		}
+
+		void DrawTriangle(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, ColourValue c1, ColourValue c2, ColourValue c3)
+		{
+			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
+			s_internalState.m_pCurrentPrimitiveBatch->AppendTriangle(v1, v2, v3, c1, c2, c3);
+		}
+
+		void DrawQuad(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, const Vector3f& v4, ColourValue colour)
+		{
+			PLAY_ASSERT(s_internalState.m_pCurrentPrimitiveBatch);
+			s_internalState.m_pCurrentPrimitiveBatch->AppendTriangle(v1, v2, v3, colour, colour, colour);
+			s_internalState.m_pCurrentPrimitiveBatch->AppendTriangle(v2, v4, v3, colour, colour, colour);
 		}
 
 		void DrawQuad(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, const Vector3f& v4, ColourValue c1, ColourValue c2, ColourValue c3, ColourValue c4)
@@ -3102,21 +4176,133 @@ namespace Play3d
 			}
 		}
 
-		void DrawMesh(MeshId hMesh, const Matrix4x4f& transform)
+		// The backend is given the material with each draw, so materials set without drawing anything cost nothing
+		static void SubmitMeshDraw(MaterialId materialId, MeshId hMesh, const Matrix4x4f& transform)
 		{
 			Graphics_Impl::Instance().SetWorldMatrix(transform);
 
 			Mesh* pMesh = Resources::ResourceManager<Mesh>::Instance().GetPtr(hMesh);
 			if (pMesh)
 			{
-				Graphics_Impl::Instance().DrawMesh(pMesh);
+				Graphics_Impl::Instance().SetMaterial(materialId);
+				Graphics_Impl::Instance().DrawMesh(hMesh, pMesh);
+			}
+		}
+
+		static void SubmitMeshInstances(MaterialId materialId, MeshId hMesh, const Matrix4x4f* pTransforms, u32 count)
+		{
+			if (count == 1 || !MeshDrawState::HasInstancing(materialId))
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					SubmitMeshDraw(materialId, hMesh, pTransforms[i]);
+				}
+				return;
+			}
+
+			Mesh* pMesh = Resources::ResourceManager<Mesh>::Instance().GetPtr(hMesh);
+			if (pMesh)
+			{
+				Graphics_Impl::Instance().SetMaterial(materialId);
+				Graphics_Impl::Instance().DrawMeshInstanced(hMesh, pMesh, pTransforms, count);
+			}
+		}
+
+		// Sorts the queued draws and draws them
+		static void DrawMeshQueue()
+		{
+			std::vector<QueuedMeshDraw>& rQueue = s_internalState.m_meshQueue;
+			std::vector<u64>& rKeys = s_internalState.m_meshQueueKeys;
+			rKeys.clear();
+			MaterialId keyMaterial;
+			u64 materialKey = GetMeshQueueMaterialKey(keyMaterial);
+			for (u32 i = 0; i < (u32)rQueue.size(); ++i)
+			{
+				// Draws mostly come in runs with one material
+				const QueuedMeshDraw& rDraw = rQueue[i];
+				if (rDraw.m_materialId != keyMaterial)
+				{
+					keyMaterial = rDraw.m_materialId;
+					materialKey = GetMeshQueueMaterialKey(keyMaterial);
+				}
+				rKeys.push_back(materialKey | ((u64)(rDraw.m_meshId.GetValue() & 0x3FFF) << kMeshQueueOrderBits) | i);
+			}
+			std::sort(rKeys.begin(), rKeys.end());
+
+			// Each run of draws with one material and mesh is drawn instanced, in queue order
+			std::vector<Matrix4x4f>& rTransforms = s_internalState.m_meshQueueTransforms;
+			for (size_t i = 0; i < rKeys.size();)
+			{
+				const QueuedMeshDraw& rFirst = rQueue[rKeys[i] & (kMeshQueueCapacity - 1)];
+				rTransforms.clear();
+				for (; i < rKeys.size(); ++i)
+				{
+					const QueuedMeshDraw& rDraw = rQueue[rKeys[i] & (kMeshQueueCapacity - 1)];
+					if (rDraw.m_materialId != rFirst.m_materialId || rDraw.m_meshId != rFirst.m_meshId)
+					{
+						break;
+					}
+					rTransforms.push_back(rDraw.m_transform);
+				}
+				SubmitMeshInstances(rFirst.m_materialId, rFirst.m_meshId, rTransforms.data(), (u32)rTransforms.size());
+			}
+			rQueue.clear();
+		}
+
+		// The sort key only has room to order so many draws, so a queue which fills up is drawn there and then and
+		// carries on empty
+		static void QueueMeshDraw(MaterialId materialId, MeshId hMesh, const Matrix4x4f& transform)
+		{
+			s_internalState.m_meshQueue.push_back({ materialId, hMesh, transform });
+			if (s_internalState.m_meshQueue.size() == kMeshQueueCapacity)
+			{
+				DrawMeshQueue();
+			}
+		}
+
+		void DrawMeshInstanced(MeshId hMesh, const Matrix4x4f* pTransforms, u32 count)
+		{
+			if (s_internalState.m_bMeshQueueOpen)
+			{
+				for (u32 i = 0; i < count; ++i)
+				{
+					QueueMeshDraw(s_internalState.m_activeMaterial, hMesh, pTransforms[i]);
+				}
+			}
+			else
+			{
+				SubmitMeshInstances(s_internalState.m_activeMaterial, hMesh, pTransforms, count);
+			}
+		}
+
+		void DrawMesh(MeshId hMesh, const Matrix4x4f& transform)
+		{
+			if (s_internalState.m_bMeshQueueOpen)
+			{
+				QueueMeshDraw(s_internalState.m_activeMaterial, hMesh, transform);
+			}
+			else
+			{
+				SubmitMeshDraw(s_internalState.m_activeMaterial, hMesh, transform);
 			}
 		}
 
 		void SetMaterial(MaterialId materialId)
 		{
-			Graphics_Impl::Instance().SetMaterial(materialId);
+			s_internalState.m_activeMaterial = materialId;
+		}
+
+		void BeginMeshQueue()
+		{
+			PLAY_ASSERT_MSG(!s_internalState.m_bMeshQueueOpen, "Mesh queue already begun");
+			s_internalState.m_bMeshQueueOpen = true;
+		}
 
+		void EndMeshQueue()
+		{
+			PLAY_ASSERT_MSG(s_internalState.m_bMeshQueueOpen, "Mesh queue not begun");
+			s_internalState.m_bMeshQueueOpen = false;
+			DrawMeshQueue();
 		}
 
 		void SetLightPosition(u32 index, const Vector3f& vPosition)
@@ -3334,44 +4520,204 @@ namespace Play3d
 			result_t result = builder.ParseObjFormat(objString, colour, fScale);
 			if (RESULT_OK == result)
 			{
+				builder.WeldVertices();
+				builder.OptimiseVertexCache();
 				return builder.CreateMesh();
 			}
 
 			return MeshId();
 		}
 
-		MeshId CreateMeshFromObjFile(const char* filePath, ColourValue colour, f32 fScale)
+		static bool IsValidMeshCache(const u8* pData, size_t size, u64 sourceHash)
 		{
-			MeshBuilder builder;
-			result_t result = RESULT_FAIL;
+			const MeshCacheHeader* pHeader = (const MeshCacheHeader*)pData;
+			if (size < sizeof(MeshCacheHeader)
+				|| pHeader->m_magic != MeshCacheHeader::kMagic
+				|| pHeader->m_version != MeshCacheHeader::kVersion
+				|| pHeader->m_sourceHash != sourceHash
+				|| pHeader->m_fileSize != size
+				|| (pHeader->m_indexStride != sizeof(u16) && pHeader->m_indexStride != sizeof(u32)))
+			{
+				return false;
+			}
 
-			HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-			if (hFile != INVALID_HANDLE_VALUE)
+			// Each stream must be exactly what the counts say, and lie wholly inside the file after the header
+			const u64 vertexCount = pHeader->m_vertexCount;
+			const u64 expectedSizes[MESH_CACHE_STREAM_COUNT] = {
+				vertexCount * sizeof(Vector3f),
+				vertexCount * sizeof(u32),
+				vertexCount * sizeof(Vector3f),
+				vertexCount * sizeof(Vector2f),
+				(u64)pHeader->m_indexCount * pHeader->m_indexStride,
+			};
+			for (u32 i = 0; i < MESH_CACHE_STREAM_COUNT; ++i)
 			{
-				LARGE_INTEGER size;
-				if (GetFileSizeEx(hFile, &size))
+				const u64 offset = pHeader->m_streamOffsets[i];
+				if (pHeader->m_streamSizes[i] != expectedSizes[i]
+					|| offset < sizeof(MeshCacheHeader)
+					|| (offset & 15) != 0
+					|| offset + expectedSizes[i] > size)
 				{
-					constexpr u32 kPadding = 16;
-					char* pBuffer = new char[size.LowPart + kPadding];
-					pBuffer[0] = '\0';
-					memset(pBuffer + size.LowPart, 0, kPadding);
-
-					DWORD bytesRead = 0;
-					if (ReadFile(hFile, pBuffer, size.LowPart, &bytesRead, NULL))
-					{
-						result = builder.ParseObjFormat(std::string_view(pBuffer, bytesRead), colour, fScale);
-					}
+					return false;
 				}
-				CloseHandle(hFile);
 			}
 
-			if (RESULT_OK == result)
+			// An index past the vertex streams would read beyond them when drawn
+			const u8* pIndices = pData + pHeader->m_streamOffsets[MESH_CACHE_INDEX];
+			for (u32 i = 0; i < pHeader->m_indexCount; ++i)
 			{
-				return builder.CreateMesh();
+				u32 index = (pHeader->m_indexStride == sizeof(u16)) ? ((const u16*)pIndices)[i] : ((const u32*)pIndices)[i];
+				if (index >= vertexCount)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		MeshId CreateMeshFromCacheData(const void* pData)
+		{
+			const MeshCacheHeader* pHeader = (const MeshCacheHeader*)pData;
+			const StreamType indexType = pHeader->m_indexStride == sizeof(u16) ? StreamType::INDEX16 : StreamType::INDEX;
+			const StreamType kStreamTypes[MESH_CACHE_STREAM_COUNT] = { StreamType::POSITION, StreamType::COLOUR, StreamType::NORMAL, StreamType::UV, indexType };
+			StreamInfo streamInfos[MESH_CACHE_STREAM_COUNT];
+			for (u32 i = 0; i < MESH_CACHE_STREAM_COUNT; ++i)
+			{
+				streamInfos[i].m_type = kStreamTypes[i];
+				streamInfos[i].m_pData = const_cast<u8*>((const u8*)pData) + pHeader->m_streamOffsets[i]; // only read, to create the buffers
+				streamInfos[i].m_dataSize = pHeader->m_streamSizes[i];
+			}
+
+			MeshDesc desc;
+			desc.m_pStreams = streamInfos;
+			desc.m_streamCount = MESH_CACHE_STREAM_COUNT;
+			desc.m_vertexCount = pHeader->m_vertexCount;
+			desc.m_indexCount = pHeader->m_indexCount;
+			return Resources::CreateAsset<Mesh>(desc);
+		}
+
+		// Returns an invalid id if the cache is missing, stale or damaged
+		static MeshId CreateMeshFromCache(const char* cachePath, u64 sourceHash)
+		{
+			size_t size = 0;
+			const u8* pData = (const u8*)System::MapFile(cachePath, size);
+			if (!pData)
+			{
+				return MeshId();
+			}
+
+			MeshId meshId;
+			if (IsValidMeshCache(pData, size, sourceHash))
+			{
+				meshId = CreateMeshFromCacheData(pData);
+			}
+
+			System::UnmapFile(pData, size);
+			return meshId;
+		}
+
+		// Parses, welds and reorders an OBJ file into the builder
+		static result_t BuildMeshFromObjFile(const char* filePath, ColourValue colour, f32 fScale, MeshBuilder& rBuilder)
+		{
+			result_t result = RESULT_FAIL;
+
+#ifndef PLAY_HEADLESS
+			HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (hFile != INVALID_HANDLE_VALUE)
+			{
+				LARGE_INTEGER size;
+				if (GetFileSizeEx(hFile, &size))
+				{
+					constexpr u32 kPadding = 16;
+					char* pBuffer = new char[size.LowPart + kPadding];
+					pBuffer[0] = '\0';
+					memset(pBuffer + size.LowPart, 0, kPadding);
+
+					DWORD bytesRead = 0;
+					if (ReadFile(hFile, pBuffer, size.LowPart, &bytesRead, NULL))
+					{
+						result = rBuilder.ParseObjFormat(std::string_view(pBuffer, bytesRead), colour, fScale);
+					}
+					delete[] pBuffer;
+				}
+				CloseHandle(hFile);
+			}
+#else
+			size_t sizeBytes = 0;
+			char* pBuffer = (char*)System::LoadFileData(filePath, sizeBytes);
+			if (pBuffer)
+			{
+				result = rBuilder.ParseObjFormat(std::string_view(pBuffer, sizeBytes), colour, fScale);
+				System::ReleaseFileData(pBuffer);
+			}
+#endif
+
+			if (RESULT_OK == result)
+			{
+				rBuilder.WeldVertices();
+				rBuilder.OptimiseVertexCache();
+			}
+			return result;
+		}
+
+		MeshId CreateMeshFromObjFile(const char* filePath, ColourValue colour, f32 fScale)
+		{
+			std::string cachePath = std::string(filePath) + ".p3m";
+			u64 sourceSize = 0;
+			u64 sourceWriteTime = 0;
+			if (!System::GetFileStamp(filePath, sourceSize, sourceWriteTime))
+			{
+				return MeshId();
+			}
+
+			u64 sourceHash = GetMeshCacheHash(sourceSize, sourceWriteTime, colour, fScale);
+			MeshId cachedMeshId = CreateMeshFromCache(cachePath.c_str(), sourceHash);
+			if (cachedMeshId.IsValid())
+			{
+				return cachedMeshId;
+			}
+
+			MeshBuilder builder;
+			if (RESULT_OK == BuildMeshFromObjFile(filePath, colour, fScale, builder))
+			{
+				// Failing to write the cache only costs the next load a parse
+				builder.SaveMeshCache(cachePath.c_str(), sourceHash);
+				return builder.CreateMesh();
 			}
 			return MeshId();
 		}
 
+		result_t LoadMeshCacheData(const char* filePath, ColourValue colour, f32 fScale, std::vector<u8>& cacheOut)
+		{
+			std::string cachePath = std::string(filePath) + ".p3m";
+			u64 sourceSize = 0;
+			u64 sourceWriteTime = 0;
+			if (!System::GetFileStamp(filePath, sourceSize, sourceWriteTime))
+			{
+				return RESULT_FAIL;
+			}
+
+			u64 sourceHash = GetMeshCacheHash(sourceSize, sourceWriteTime, colour, fScale);
+			if (RESULT_OK == System::LoadFileData(cachePath.c_str(), cacheOut)
+				&& IsValidMeshCache(cacheOut.data(), cacheOut.size(), sourceHash))
+			{
+				return RESULT_OK;
+			}
+
+			MeshBuilder builder;
+			result_t result = BuildMeshFromObjFile(filePath, colour, fScale, builder);
+			if (RESULT_OK == result)
+			{
+				builder.BuildMeshCache(sourceHash, cacheOut);
+				System::SaveFileData(cachePath.c_str(), cacheOut.data(), cacheOut.size());
+			}
+			else
+			{
+				cacheOut.clear(); // may hold a rejected cache
+			}
+			return result;
+		}
+
 		TextureId CreateTextureCheckerboard(u32 width, u32 height, ColourValue a, ColourValue b, u32 checkSize)
 		{
 			const u32 rowPitch = width;
@@ -3399,14 +4745,33 @@ namespace Play3d
 			return id;
 		}
 
+#ifndef PLAY_HEADLESS
 		TextureId CreateTextureFromFile(const char* pFilePath)
+		{
+			u32 width = 0;
+			u32 height = 0;
+			std::vector<u8> pixels;
+			if (RESULT_OK != DecodeImageFile(pFilePath, width, height, pixels))
+			{
+				return TextureId();
+			}
+
+			TextureDesc desc;
+			desc.m_width = width;
+			desc.m_height = height;
+			desc.m_format = TextureFormat::RGBA;
+			desc.m_pImageData = pixels.data();
+			return Resources::CreateAsset<Texture>(desc);
+		}
+
+		result_t DecodeImageFile(const char* pFilePath, u32& widthOut, u32& heightOut, std::vector<u8>& pixelsOut)
 		{
 			IWICImagingFactory* pIWICFactory = nullptr;
 			IWICBitmapDecoder* pDecoder = nullptr;
 			IWICFormatConverter* pConvertedSourceBitmap = nullptr;
 			IWICBitmapFrameDecode* pFrame = nullptr;
 
-			TextureId textureId;
+			result_t result = RESULT_FAIL;
 
 			HRESULT hr = CoCreateInstance(
 				CLSID_WICImagingFactory,
@@ -3457,17 +4822,14 @@ namespace Play3d
 				pConvertedSourceBitmap->GetSize(&width, &height);
 
 				u32 sizeBytes = width * height * 4;
-				std::vector<BYTE> pImageData(sizeBytes);
+				pixelsOut.resize(sizeBytes);
 
-				hr = pConvertedSourceBitmap->CopyPixels(NULL, width * sizeof(u32), sizeBytes, pImageData.data());
+				hr = pConvertedSourceBitmap->CopyPixels(NULL, width * sizeof(u32), sizeBytes, pixelsOut.data());
 				if (SUCCEEDED(hr))
 				{
-					TextureDesc desc;
-					desc.m_width = width;
-					desc.m_height = height;
-					desc.m_format = TextureFormat::RGBA;
-					desc.m_pImageData = pImageData.data();
-					textureId = Resources::CreateAsset<Texture>(desc);
+					widthOut = width;
+					heightOut = height;
+					result = RESULT_OK;
 				}
 			}
 
@@ -3476,9 +4838,11 @@ namespace Play3d
 			PLAY_SAFE_RELEASE(pConvertedSourceBitmap);
 			PLAY_SAFE_RELEASE(pFrame);
 
-			return textureId;
+			return result;
 		}
 
+#endif
+
 		SamplerId CreateLinearSampler()
 		{
 			SamplerDesc desc;
@@ -3494,6 +4858,7 @@ namespace Play3d
 
 //-----------------------------------------------------------
 // Play3dImpl\Graphics_Impl.cpp
+#ifndef PLAY_HEADLESS
 
 
 
@@ -3581,6 +4946,8 @@ namespace Play3d
 			, m_hWnd(NULL)
 			, m_nSurfaceWidth(0)
 			, m_nSurfaceHeight(0)
+			, m_validMeshBindings(0)
+			, m_instanceCapacity(0)
 			, m_nNextPrimitiveBatch(0)
 		{
 			InitWindow();
@@ -3646,6 +5013,7 @@ namespace Play3d
 			m_uiFrameConstants.UpdateGPU(m_pDeviceContext.Get());
 
 			m_nNextPrimitiveBatch = 0;
+			m_validMeshBindings = 0;
 
 			if (bQuit)
 			{
@@ -3668,6 +5036,7 @@ namespace Play3d
 				m_pDeviceContext->ClearState();
 				m_pDeviceContext->Flush();
 			}
+			m_validMeshBindings = 0;
 		}
 
 		PrimitiveBatch* Graphics_Impl::AllocatePrimitiveBatch()
@@ -3716,6 +5085,8 @@ namespace Play3d
 			pBatch->DrawPoints(pDC);
 			pBatch->DrawLines(pDC);
 			pBatch->DrawTriangles(pDC);
+
+			m_validMeshBindings &= ~MeshBinding::PRIMITIVE_BATCH;
 		}
 
 		void Graphics_Impl::TempPrepFontDraw()
@@ -3735,6 +5106,8 @@ namespace Play3d
 
 			m_uiFrameConstants.Bind(pDC, 0);
 
+			// Font::DrawString binds the rest
+			m_validMeshBindings &= ~MeshBinding::TEXT;
 		}
 
 		ShaderId Graphics_Impl::GetMaterialShader(MaterialShaderKey key)
@@ -3771,90 +5144,204 @@ namespace Play3d
 			m_wndCallbacks.push_back(callback);
 		}
 
-		void Graphics_Impl::DrawMesh(const Mesh* pMesh)
+		void Graphics_Impl::DrawMesh(MeshId hMesh, const Mesh* pMesh)
 		{
 			PLAY_ASSERT(pMesh);
 
 			UpdateConstantBuffers();
 
+			BindMeshState(MeshDrawState(m_activeMaterial, hMesh), pMesh);
+
 			ID3D11DeviceContext* pDC = m_pDeviceContext.Get();
+			if (pMesh->m_pIndexBuffer)
+			{
+				pDC->DrawIndexed(pMesh->m_indexCount, 0, 0);
+			}
+			else
+			{
+				pDC->Draw(pMesh->m_vertexCount, 0);
+			}
+		}
 
-			pDC->OMSetBlendState(m_pBlendStateOpaque.Get(), NULL, 0xffffffff);
+		void Graphics_Impl::DrawMeshInstanced(MeshId hMesh, const Mesh* pMesh, const Matrix4x4f* pTransforms, u32 count)
+		{
+			PLAY_ASSERT(pMesh);
 
-			Material* pMaterial = Resources::ResourceManager<Material>::Instance().GetPtr(m_activeMaterial);
-			if (pMaterial)
+			ID3D11DeviceContext* pDC = m_pDeviceContext.Get();
+
+			D3D11_MAPPED_SUBRESOURCE data;
+			if (RESULT_OK != ReserveInstanceBuffer(count) || FAILED(pDC->Map(m_pInstanceBuffer.Get(), 0, D3D11_MAP::D3D11_MAP_WRITE_DISCARD, 0, &data)))
+			{
+				// Still draws, one instance at a time
+				for (u32 i = 0; i < count; ++i)
+				{
+					SetWorldMatrix(pTransforms[i]);
+					DrawMesh(hMesh, pMesh);
+				}
+				return;
+			}
+			PackInstanceData(pTransforms, count, (InstanceData*)data.pData);
+			pDC->Unmap(m_pInstanceBuffer.Get(), 0);
+
+			UpdateConstantBuffers();
+
+			BindMeshState(MeshDrawState(m_activeMaterial, hMesh, true), pMesh);
+
+			ID3D11ShaderResourceView* srvs[] = { m_pInstanceSRV.Get() };
+			pDC->VSSetShaderResources(kInstanceBufferSlot, 1, srvs);
+
+			if (pMesh->m_pIndexBuffer)
+			{
+				pDC->DrawIndexedInstanced(pMesh->m_indexCount, count, 0, 0, 0);
+			}
+			else
 			{
-				pDC->RSSetState(pMaterial->m_pRasterState.Get());
+				pDC->DrawInstanced(pMesh->m_vertexCount, count, 0, 0);
+			}
+		}
+
+		result_t Graphics_Impl::ReserveInstanceBuffer(u32 count)
+		{
+			if (count <= m_instanceCapacity)
+			{
+				return RESULT_OK;
+			}
+
+			u32 capacity = std::max(count, std::max(m_instanceCapacity * 2, kMinInstanceCapacity));
+			m_pInstanceBuffer.Reset();
+			m_pInstanceSRV.Reset();
+			m_instanceCapacity = 0;
+
+			D3D11_BUFFER_DESC desc = {};
+			desc.ByteWidth = capacity * sizeof(InstanceData);
+			desc.Usage = D3D11_USAGE::D3D11_USAGE_DYNAMIC;
+			desc.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_SHADER_RESOURCE;
+			desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+			desc.StructureByteStride = sizeof(InstanceData);
+
+			HRESULT hr = m_pDevice->CreateBuffer(&desc, NULL, &m_pInstanceBuffer);
+			PLAY_ASSERT_MSG(SUCCEEDED(hr), "Could not create the instance buffer");
+			if (FAILED(hr))
+			{
+				return RESULT_FAIL;
+			}
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+			srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+			srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+			srvDesc.Buffer.FirstElement = 0;
+			srvDesc.Buffer.NumElements = capacity;
+
+			hr = m_pDevice->CreateShaderResourceView(m_pInstanceBuffer.Get(), &srvDesc, &m_pInstanceSRV);
+			PLAY_ASSERT_MSG(SUCCEEDED(hr), "Could not create the instance buffer view");
+			if (FAILED(hr))
+			{
+				m_pInstanceBuffer.Reset();
+				return RESULT_FAIL;
+			}
+
+			m_instanceCapacity = capacity;
+			return RESULT_OK;
+		}
+
+		void Graphics_Impl::BindMeshState(const MeshDrawState& state, const Mesh* pMesh)
+		{
+			ID3D11DeviceContext* pDC = m_pDeviceContext.Get();
+
+			// Only bind what differs from the previous mesh draw
+			u32 changed = state.GetChangedBindings(m_boundMeshState, m_validMeshBindings);
+
+			if (changed & MeshBinding::BLEND)
+			{
+				pDC->OMSetBlendState(m_pBlendStateOpaque.Get(), NULL, 0xffffffff);
+			}
 
-				Shader* pVS = Resources::ResourceManager<Shader>::Instance().GetPtr(pMaterial->m_VertexShader);
+			Material* pMaterial = Resources::ResourceManager<Material>::Instance().GetPtr(state.m_material);
+			if (changed & MeshBinding::RASTER)
+			{
+				pDC->RSSetState(pMaterial ? pMaterial->m_pRasterState.Get() : m_pFallbackRasterState.Get());
+			}
+			if (changed & MeshBinding::VERTEX_SHADER)
+			{
+				Shader* pVS = Resources::ResourceManager<Shader>::Instance().GetPtr(state.m_vertexShader);
 				if (!pVS)
 				{
 					pVS = Resources::ResourceManager<Shader>::Instance().GetPtr(m_meshShaders[0]);
 				}
-
-				Shader* pPS = Resources::ResourceManager<Shader>::Instance().GetPtr(pMaterial->m_PixelShader);
+				pVS->Bind(pDC);
+			}
+			if (changed & MeshBinding::PIXEL_SHADER)
+			{
+				Shader* pPS = Resources::ResourceManager<Shader>::Instance().GetPtr(state.m_pixelShader);
 				if (!pPS)
 				{
 					pPS = Resources::ResourceManager<Shader>::Instance().GetPtr(m_meshShaders[1]);
 				}
-				pVS->Bind(pDC);
 				pPS->Bind(pDC);
-
-				ID3D11Buffer* buffers[] = { pMaterial->m_pMaterialConstants.Get() };
-				pDC->VSSetConstantBuffers(3, 1, buffers);
-				pDC->PSSetConstantBuffers(3, 1, buffers);
-
+			}
+			if (changed & MeshBinding::MATERIAL_CONSTANTS)
+			{
+				if (pMaterial)
+				{
+					ID3D11Buffer* buffers[] = { pMaterial->m_pMaterialConstants.Get() };
+					pDC->VSSetConstantBuffers(3, 1, buffers);
+					pDC->PSSetConstantBuffers(3, 1, buffers);
+				}
+				else
+				{
+					m_materialConstants.Bind(pDC, 3);
+				}
+			}
+			if (changed & MeshBinding::TEXTURES)
+			{
 				ID3D11ShaderResourceView* textureBindings[kMaxMaterialTextureSlots];
-				ID3D11SamplerState* samplerBindings[kMaxMaterialTextureSlots];
-
 				for (u32 i = 0; i < kMaxMaterialTextureSlots; ++i)
 				{
-					if (pMaterial->m_texture[i].IsValid())
-					{
-						Texture* pTexture = Resources::ResourceManager<Texture>::Instance().GetPtr(pMaterial->m_texture[i]);
-						Sampler* pSampler = Resources::ResourceManager<Sampler>::Instance().GetPtr(pMaterial->m_sampler[i]);
-
-						textureBindings[i] = pTexture ? pTexture->m_pSRV.Get() : nullptr;
-						samplerBindings[i] = pSampler ? pSampler->m_pSampler.Get() : nullptr;
-					}
-					else
-					{
-						textureBindings[i] = nullptr;
-						samplerBindings[i] = nullptr;
-					}
+					Texture* pTexture = Resources::ResourceManager<Texture>::Instance().GetPtr(state.m_texture[i]);
+					textureBindings[i] = pTexture ? pTexture->m_pSRV.Get() : nullptr;
 				}
-				pDC->PSSetShaderResources(0, 4, textureBindings);
-				pDC->PSSetSamplers(0, 4, samplerBindings);
+				pDC->PSSetShaderResources(0, kMaxMaterialTextureSlots, textureBindings);
 			}
-			else
+			if (changed & MeshBinding::SAMPLERS)
 			{
-				pDC->RSSetState(m_pFallbackRasterState.Get());
-				Shader* pVS = Resources::ResourceManager<Shader>::Instance().GetPtr(m_meshShaders[0]);
-				Shader* pPS = Resources::ResourceManager<Shader>::Instance().GetPtr(m_meshShaders[1]);
-				pVS->Bind(pDC);
-				pPS->Bind(pDC);
-
-				m_materialConstants.Bind(pDC, 3);
+				ID3D11SamplerState* samplerBindings[kMaxMaterialTextureSlots];
+				for (u32 i = 0; i < kMaxMaterialTextureSlots; ++i)
+				{
+					Sampler* pSampler = Resources::ResourceManager<Sampler>::Instance().GetPtr(state.m_sampler[i]);
+					samplerBindings[i] = pSampler ? pSampler->m_pSampler.Get() : nullptr;
+				}
+				pDC->PSSetSamplers(0, kMaxMaterialTextureSlots, samplerBindings);
 			}
 
-			pDC->IASetInputLayout(m_pMeshInputLayout.Get());
-
-			pMesh->Bind(pDC);
-
-			m_frameConstants.Bind(pDC, 0);
-			m_drawConstants.Bind(pDC, 1);
-			m_lightConstants.Bind(pDC, 2);
-
+			if (changed & MeshBinding::INPUT_LAYOUT)
+			{
+				pDC->IASetInputLayout(m_pMeshInputLayout.Get());
+			}
+			if (changed & MeshBinding::BUFFERS)
+			{
+				pMesh->Bind(pDC);
+			}
 
-			pDC->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-			if (pMesh->m_pIndexBuffer)
+			if (changed & MeshBinding::FRAME_CONSTANTS)
 			{
-				pDC->DrawIndexed(pMesh->m_indexCount, 0, 0);
+				m_frameConstants.Bind(pDC, 0);
 			}
-			else
+			if (changed & MeshBinding::DRAW_CONSTANTS)
 			{
-				pDC->Draw(pMesh->m_vertexCount, 0);
+				m_drawConstants.Bind(pDC, 1);
+			}
+			if (changed & MeshBinding::LIGHT_CONSTANTS)
+			{
+				m_lightConstants.Bind(pDC, 2);
+			}
+			if (changed & MeshBinding::TOPOLOGY)
+			{
+				pDC->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 			}
+
+			m_boundMeshState = state;
+			m_validMeshBindings = MeshBinding::ALL;
 		}
 
 		void Graphics_Impl::SetViewport(const Viewport& v)
@@ -3884,7 +5371,7 @@ namespace Play3d
 		{
 			DrawConstantData& t(m_drawConstants.Get());
 			t.worldMtx = m;
-			t.normalMtx = Matrix4x4f(m.Upper3x3(), Vector3f(0, 0, 0));
+			t.normalMtx = MakeNormalMatrix(m);
 			t.mvpMtx = m_frameConstants.Get().viewProjectionMtx * m;
 		}
 
@@ -4186,10 +5673,15 @@ namespace Play3d
 			else
 			{
 				desc.m_type = ShaderType::VERTEX_SHADER;
-				desc.m_entryPoint = "VS_Main";
+				desc.m_entryPoint = key.m_bits.m_instanced ? "VS_MainInstanced" : "VS_Main";
 				desc.m_name += "_VS";
 			}
 
+			if (key.m_bits.m_instanced)
+			{
+				desc.m_name += "_I";
+			}
+
 
 			if (key.m_bits.m_useTexture0)
 			{
@@ -4346,6 +5838,8 @@ namespace Play3d
 
 
 
+#endif // PLAY_HEADLESS
+
 //-----------------------------------------------------------
 // Play3dImpl\InputApi.cpp
 
@@ -4357,6 +5851,7 @@ namespace Play3d
 
 
 
+#ifndef PLAY_HEADLESS
 namespace Play3d
 {
 	namespace Input
@@ -4418,6 +5913,7 @@ namespace Play3d
 		};
 	}
 }
+#endif // PLAY_HEADLESS
 
 namespace Play3d
 {
@@ -4466,6 +5962,7 @@ namespace Play3d
 
 //-----------------------------------------------------------
 // Play3dImpl\Input_Impl.cpp
+#ifndef PLAY_HEADLESS
 
 
 
@@ -4839,41 +6336,200 @@ namespace Play3d
 
 
 
-//-----------------------------------------------------------
-// Play3dImpl\Material.cpp
-
+#endif // PLAY_HEADLESS
 
+//-----------------------------------------------------------
+// Play3dImpl\JobsApi.cpp
 
 namespace Play3d
 {
-	namespace Graphics
+	namespace Jobs
 	{
-		D3D11_CULL_MODE TranslateCullMode(CullMode mode)
+		struct JobRange
 		{
-			switch (mode)
-			{
-			case CullMode::BACK: return D3D11_CULL_BACK;
-			case CullMode::FRONT: return D3D11_CULL_FRONT;
-			case CullMode::NONE: return D3D11_CULL_NONE;
-			}
-			return D3D11_CULL_NONE;
-		}
+			JobGroup* m_pGroup;
+			u32 m_begin;
+			u32 m_end;
+		};
 
-		Material::Material(const SimpleMaterialDesc& rDesc)
+		// A single FIFO of ranges shared by all workers. Jobs are coarse (a range of work each) so one lock is cheap
+		// next to the work it guards.
+		struct Jobs_Impl
 		{
-			auto pDevice = Graphics_Impl::Instance().GetDevice();
-			SetupState(pDevice, rDesc.m_state);
-			SetupConstantBuffer(pDevice, &rDesc.m_constants, sizeof(MaterialConstantData));
-			SetupTextureBindings(pDevice, rDesc.m_texture, rDesc.m_sampler);
+			Jobs_Impl(u32 workerCount)
+			{
+				for (u32 i = 0; i < workerCount; ++i)
+				{
+					m_workers.emplace_back([this]() { WorkerLoop(); });
+				}
+			}
 
+			// Anything still queued is finished before returning, so no group is left busy
+			~Jobs_Impl()
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_bQuit = true;
+				m_workAvailable.notify_all();
+				while (!m_queue.empty())
+				{
+					RunFront(lock);
+				}
+				lock.unlock();
 
-			MaterialShaderKey key;
-			key.m_value = 0u;
+				for (std::thread& worker : m_workers)
+				{
+					worker.join();
+				}
+			}
 
-			if (rDesc.m_bEnableLighting)
+			void WorkerLoop()
 			{
-				key.m_bits.m_useLighting = 1;
-				PLAY_ASSERT_MSG(0 < rDesc.m_lightCount && rDesc.m_lightCount < MaterialShaderKey::kMaxLights, "Invalid light count.");
+				std::unique_lock<std::mutex> lock(m_mutex);
+				for (;;)
+				{
+					m_workAvailable.wait(lock, [this]() { return m_bQuit || !m_queue.empty(); });
+					if (m_queue.empty())
+					{
+						return;
+					}
+					RunFront(lock);
+				}
+			}
+
+			// Pops the front range and runs it with the lock released
+			void RunFront(std::unique_lock<std::mutex>& lock)
+			{
+				JobRange range = m_queue.front();
+				m_queue.pop_front();
+
+				lock.unlock();
+				range.m_pGroup->m_function(range.m_begin, range.m_end);
+				bool bGroupDone = range.m_pGroup->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1;
+				lock.lock();
+
+				if (bGroupDone)
+				{
+					m_groupDone.notify_all();
+				}
+			}
+
+			static Jobs_Impl* ms_pInstance;
+
+			std::vector<std::thread> m_workers;
+			std::deque<JobRange> m_queue;
+			std::mutex m_mutex;
+			std::condition_variable m_workAvailable;
+			std::condition_variable m_groupDone;
+			bool m_bQuit = false;
+		};
+
+		Jobs_Impl* Jobs_Impl::ms_pInstance = nullptr;
+
+		result_t Initialise(u32 workerCount)
+		{
+			if (workerCount == kDefaultWorkerCount)
+			{
+				u32 hardwareThreads = std::thread::hardware_concurrency();
+				workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+			}
+
+			Shutdown();
+			Jobs_Impl::ms_pInstance = new Jobs_Impl(workerCount);
+			return RESULT_OK;
+		}
+
+		result_t Shutdown()
+		{
+			PLAY_SAFE_DELETE(Jobs_Impl::ms_pInstance);
+			return RESULT_OK;
+		}
+
+		u32 GetWorkerCount()
+		{
+			return Jobs_Impl::ms_pInstance ? (u32)Jobs_Impl::ms_pInstance->m_workers.size() : 0;
+		}
+
+		void Dispatch(JobGroup& group, u32 count, u32 grainSize, std::function<void(u32 begin, u32 end)> function)
+		{
+			PLAY_ASSERT(Jobs_Impl::ms_pInstance);
+			PLAY_ASSERT(!group.IsBusy());
+			PLAY_ASSERT(grainSize > 0);
+			if (count == 0)
+			{
+				return;
+			}
+
+			Jobs_Impl& jobs = *Jobs_Impl::ms_pInstance;
+			group.m_function = std::move(function);
+			group.m_pending.store((count + grainSize - 1) / grainSize, std::memory_order_release);
+			{
+				std::lock_guard<std::mutex> lock(jobs.m_mutex);
+				for (u32 begin = 0; begin < count; begin += grainSize)
+				{
+					jobs.m_queue.push_back({ &group, begin, std::min(begin + grainSize, count) });
+				}
+			}
+			jobs.m_workAvailable.notify_all();
+		}
+
+		void Wait(JobGroup& group)
+		{
+			PLAY_ASSERT(Jobs_Impl::ms_pInstance);
+			Jobs_Impl& jobs = *Jobs_Impl::ms_pInstance;
+
+			// Help out rather than block, so the work still gets done with no workers
+			std::unique_lock<std::mutex> lock(jobs.m_mutex);
+			while (group.IsBusy())
+			{
+				if (!jobs.m_queue.empty())
+				{
+					jobs.RunFront(lock);
+				}
+				else
+				{
+					jobs.m_groupDone.wait(lock, [&group]() { return !group.IsBusy(); });
+				}
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------
+// Play3dImpl\Material.cpp
+#ifndef PLAY_HEADLESS
+
+
+
+namespace Play3d
+{
+	namespace Graphics
+	{
+		D3D11_CULL_MODE TranslateCullMode(CullMode mode)
+		{
+			switch (mode)
+			{
+			case CullMode::BACK: return D3D11_CULL_BACK;
+			case CullMode::FRONT: return D3D11_CULL_FRONT;
+			case CullMode::NONE: return D3D11_CULL_NONE;
+			}
+			return D3D11_CULL_NONE;
+		}
+
+		Material::Material(const SimpleMaterialDesc& rDesc)
+		{
+			auto pDevice = Graphics_Impl::Instance().GetDevice();
+			SetupState(pDevice, rDesc.m_state);
+			SetupConstantBuffer(pDevice, &rDesc.m_constants, sizeof(MaterialConstantData));
+			SetupTextureBindings(pDevice, rDesc.m_texture, rDesc.m_sampler);
+
+
+			MaterialShaderKey key;
+			key.m_value = 0u;
+
+			if (rDesc.m_bEnableLighting)
+			{
+				key.m_bits.m_useLighting = 1;
+				PLAY_ASSERT_MSG(0 < rDesc.m_lightCount && rDesc.m_lightCount < MaterialShaderKey::kMaxLights, "Invalid light count.");
 				key.m_bits.m_lightCount = rDesc.m_lightCount;
 			}
 			if (rDesc.m_texture[0].IsValid())
@@ -4882,6 +6538,11 @@ namespace Play3d
 			}
 			m_VertexShader = Graphics_Impl::Instance().GetMaterialShader(key);
 
+			key.m_bits.m_instanced = 1;
+			m_InstancedVertexShader = Graphics_Impl::Instance().GetMaterialShader(key);
+			m_bInstancing = true;
+
+			key.m_bits.m_instanced = 0;
 			key.m_bits.m_pixelShader = 1;
 			m_PixelShader = Graphics_Impl::Instance().GetMaterialShader(key);
 		}
@@ -4893,6 +6554,8 @@ namespace Play3d
 			SetupConstantBuffer(pDevice, &rDesc.m_pConstantData, rDesc.m_dataSize);
 			m_VertexShader = rDesc.m_VertexShader;
 			m_PixelShader = rDesc.m_PixelShader;
+			m_InstancedVertexShader = rDesc.m_InstancedVertexShader;
+			m_bInstancing = m_InstancedVertexShader.IsValid();
 			SetupTextureBindings(pDevice, rDesc.m_texture, rDesc.m_sampler);
 		}
 
@@ -4966,8 +6629,10 @@ namespace Play3d
 	{
 
 		Mesh::Mesh(const MeshDesc& rDesc)
-			: m_indexCount(rDesc.m_indexCount)
+			: m_pIndexBuffer(nullptr)
+			, m_indexCount(rDesc.m_indexCount)
 			, m_vertexCount(rDesc.m_vertexCount)
+			, m_indexStride(sizeof(u32))
 		{
 			for (u32 i = 0; i < rDesc.m_streamCount; ++i)
 			{
@@ -4991,7 +6656,8 @@ namespace Play3d
 			D3D11_BUFFER_DESC desc = {};
 			desc.ByteWidth = (UINT)info.m_dataSize;
 			desc.Usage = bIsDynamic ? D3D11_USAGE::D3D11_USAGE_DYNAMIC : D3D11_USAGE_IMMUTABLE;
-			desc.BindFlags = info.m_type == StreamType::INDEX ? D3D11_BIND_INDEX_BUFFER : D3D11_BIND_VERTEX_BUFFER;
+			bool bIsIndex = info.m_type == StreamType::INDEX || info.m_type == StreamType::INDEX16;
+			desc.BindFlags = bIsIndex ? D3D11_BIND_INDEX_BUFFER : D3D11_BIND_VERTEX_BUFFER;
 			desc.CPUAccessFlags = bIsDynamic ? D3D11_CPU_ACCESS_WRITE : 0;
 			desc.MiscFlags = 0;
 			desc.StructureByteStride = 0;
@@ -5008,9 +6674,10 @@ namespace Play3d
 			
 			PLAY_ASSERT_MSG(SUCCEEDED(hr), "Create Vertex Buffer Stream");
 
-			if (info.m_type == StreamType::INDEX)
+			if (bIsIndex)
 			{
 				m_pIndexBuffer = pBuffer;
+				m_indexStride = info.m_type == StreamType::INDEX16 ? sizeof(u16) : sizeof(u32);
 			}
 			else
 			{
@@ -5044,7 +6711,7 @@ namespace Play3d
 		{
 			if (m_pIndexBuffer)
 			{
-				pDC->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+				pDC->IASetIndexBuffer(m_pIndexBuffer, m_indexStride == sizeof(u16) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
 			}
 
 			for (auto it : m_streamBuffers)
@@ -5057,6 +6724,8 @@ namespace Play3d
 }
 
 
+#endif // PLAY_HEADLESS
+
 //-----------------------------------------------------------
 // Play3dImpl\MeshBuilder.cpp
 
@@ -5255,228 +6924,668 @@ namespace Play3d
 			}
 		}
 
-		result_t MeshBuilder::ParseObjFormat(std::string_view objString, ColourValue colour, f32 fScale)
+		namespace ObjParser
 		{
-			std::vector<Vector3f> positions;
-			std::vector<Vector2f> texCoords;
-			std::vector<Vector3f> normals;
+			// Indices as written in the file: 1 based, 0 when absent
+			struct Corner
+			{
+				u32 m_position;
+				u32 m_uv;
+				u32 m_normal;
+			};
+
+			// A run of whole lines, parsed on its own. Faces keep their raw indices until every chunk's vertex records
+			// are known.
+			struct Chunk
+			{
+				std::string_view m_text;
+				std::vector<Vector3f> m_positions;
+				std::vector<Vector3f> m_normals;
+				std::vector<Vector2f> m_uvs;
+				std::vector<Corner> m_corners;
+				std::vector<u32> m_faceSizes;
+				u32 m_triangleCount = 0;
+
+				// Where this chunk's records land in the combined arrays
+				u32 m_positionBase = 0;
+				u32 m_normalBase = 0;
+				u32 m_uvBase = 0;
+				u32 m_vertexBase = 0;
+				u32 m_indexBase = 0;
+			};
 
-			u32 nTotalFaceCount = 0;
+			static constexpr size_t kMinChunkBytes = 64 * 1024;
+			static constexpr u32 kChunksPerThread = 4;
 
-			static constexpr u32 kMaxFaceVerts = 4;
-			Vector3f facePositions[kMaxFaceVerts];
-			Vector3f faceNormals[kMaxFaceVerts];
-			Vector2f faceUVs[kMaxFaceVerts];
-			ColourValue faceColours[kMaxFaceVerts];
-			for (u32 i = 0; i < kMaxFaceVerts; ++i)
+			template<typename T>
+			static void ParseValue(std::string_view arg, T& valueOut)
 			{
-				faceColours[i] = colour;
+				std::from_chars(arg.data(), arg.data() + arg.size(), valueOut);
 			}
 
-			std::vector<std::string_view> args;
+			// Records are split on single spaces, so repeated spaces give empty arguments
+			static u32 SplitArgs(std::string_view line, std::vector<std::string_view>& args)
+			{
+				args.clear();
+				size_t argLen = line.find_first_of(' ', 0);
+				while (argLen != std::string_view::npos)
+				{
+					args.push_back(line.substr(0, argLen));
+					line.remove_prefix(argLen + 1);
+					argLen = line.find_first_of(' ', 0);
+				}
+				if (!line.empty())
+				{
+					args.push_back(line);
+				}
+				return (u32)args.size();
+			}
 
-			size_t end = objString.size();
-			size_t pos = 0;
-			while (pos < end)
+			// "p", "p/t", "p/t/n" or "p//n"; nothing is read when p is missing
+			static Corner ParseCorner(std::string_view arg)
 			{
-				size_t offset = objString.find_first_of('\n', pos);
-				if (std::string_view::npos == offset)
-				{	
-					pos = end;
+				Corner corner = { 0, 0, 0 };
+				if (arg.empty() || arg[0] == '/')
+				{
+					return corner;
 				}
-				else if(offset > 0)
+				size_t t0 = arg.find_first_of('/', 0);
+				if (t0 == std::string_view::npos)
+				{
+					ParseValue(arg, corner.m_position);
+					return corner;
+				}
+				ParseValue(arg.substr(0, t0), corner.m_position);
+				size_t t1 = arg.find_first_of('/', t0 + 1);
+				if (t1 == std::string_view::npos)
+				{
+					ParseValue(arg.substr(t0 + 1), corner.m_uv);
+				}
+				else
+				{
+					ParseValue(arg.substr(t0 + 1, t1 - t0 - 1), corner.m_uv);
+					ParseValue(arg.substr(t1 + 1), corner.m_normal);
+				}
+				return corner;
+			}
+
+			// Only lines ending in '\n' are read, so an unterminated last line is ignored
+			static void ParseChunk(Chunk& rChunk)
+			{
+				std::vector<std::string_view> args;
+				std::string_view text = rChunk.m_text;
+				size_t lineEnd = text.find_first_of('\n');
+				while (lineEnd != std::string_view::npos)
 				{
-					args.clear();
-					size_t lineLength = offset - pos;
-					std::string_view line = objString.substr(pos, lineLength);
-					size_t argLen = line.find_first_of(' ', 0);
-					while (argLen != std::string_view::npos)
+					std::string_view line = text.substr(0, lineEnd);
+					text.remove_prefix(lineEnd + 1);
+					lineEnd = text.find_first_of('\n');
+
+					u32 argCount = SplitArgs(line, args);
+					if (argCount > 3 && args[0] == "v")
 					{
-						args.push_back(line.substr(0, argLen));
-						line.remove_prefix(argLen + 1);
-						argLen = line.find_first_of(' ', 0) ;
+						Vector3f v(0.f, 0.f, 0.f);
+						ParseValue(args[1], v.x);
+						ParseValue(args[2], v.y);
+						ParseValue(args[3], v.z);
+						rChunk.m_positions.push_back(v);
 					}
-					if (!line.empty())
+					else if (argCount > 3 && args[0] == "vn")
 					{
-						args.push_back(line);
+						Vector3f v(0.f, 0.f, 0.f);
+						ParseValue(args[1], v.x);
+						ParseValue(args[2], v.y);
+						ParseValue(args[3], v.z);
+						rChunk.m_normals.push_back(v);
 					}
-
-					if (!args.empty())
+					else if (argCount > 2 && args[0] == "vt")
 					{
-						if ("v" == args[0] && args.size() > 3)
-						{
-							Vector3f v;
-							std::from_chars(args[1].data(), args[1].data() + args[1].size(), v.x);
-							std::from_chars(args[2].data(), args[2].data() + args[2].size(), v.y);
-							std::from_chars(args[3].data(), args[3].data() + args[3].size(), v.z);
-							positions.push_back(v);
-						}
-						else if ("vn" == args[0] && args.size() > 3)
-						{
-							Vector3f v;
-							std::from_chars(args[1].data(), args[1].data() + args[1].size(), v.x);
-							std::from_chars(args[2].data(), args[2].data() + args[2].size(), v.y);
-							std::from_chars(args[3].data(), args[3].data() + args[3].size(), v.z);
-							normals.push_back(v);
-						}
-						else if ("vt" == args[0] && args.size() > 2)
+						Vector2f v(0.f, 0.f);
+						ParseValue(args[1], v.x);
+						ParseValue(args[2], v.y);
+						rChunk.m_uvs.push_back(v);
+					}
+					else if (argCount > 3 && args[0] == "f")
+					{
+						for (u32 i = 1; i < argCount; ++i)
 						{
-							Vector2f v;
-							std::from_chars(args[1].data(), args[1].data() + args[1].size(), v.x);
-							std::from_chars(args[2].data(), args[2].data() + args[2].size(), v.y);
-							texCoords.push_back(v);
+							rChunk.m_corners.push_back(ParseCorner(args[i]));
 						}
-						else if ("f" == args[0] && args.size() > 3)
-						{
-							u32 nFaceVerts = (u32)args.size() - 1;
-							PLAY_ASSERT(nFaceVerts <= kMaxFaceVerts);
+						rChunk.m_faceSizes.push_back(argCount - 1);
+						rChunk.m_triangleCount += argCount - 3;
+					}
+				}
+			}
+		}
 
-							for (u32 i = 0; i < nFaceVerts; ++i)
-							{
-								const std::string_view& rArg(args[i+1]);
-								
-								u32 nIndexArgs = 0;
-								std::string_view indexArg[3];
-								size_t t0 = rArg.find_first_of('/', 0);
-								if (t0 != std::string_view::npos)
-								{
-									size_t t1 = rArg.find_first_of('/', t0+1);
-									++nIndexArgs;
-									if (t1 != std::string_view::npos)
-									{
-										++nIndexArgs;
-										indexArg[0] = rArg.substr(0, t0);
-										indexArg[1] = rArg.substr(t0 + 1, t1);
-										indexArg[2] = rArg.substr(t1 + 1);
-									}
-									else
-									{
-										indexArg[0] = rArg.substr(0, t0);
-										indexArg[1] = rArg.substr(t0 + 1);
-									}
-								}
-								else
-								{
-									indexArg[0] = rArg;
-								}
-
-								u32 indices[3] = { 0,0,0 };
-								for(u32 j = 0; j < 3; ++j)
-								{
-									if (!indexArg[0].empty())
-									{
-										std::from_chars(indexArg[j].data(), indexArg[j].data() + indexArg[j].size(), indices[j]);
-									}
-								}
-
-								if (indices[0])
-								{
-									facePositions[i] = positions.at(indices[0] - 1) * fScale;
-								}
-								else
-								{
-									facePositions[i] = Vector3f(0, 0, 0);
-								}
-
-								if (indices[1])
-								{
-									faceUVs[i] = texCoords.at(indices[1] - 1);
-								}
-								else
-								{
-									faceUVs[i] = Vector2f(0, 0);
-								}
-
-								if (indices[2])
-								{
-									faceNormals[i] = normals.at(indices[2] - 1);
-								}
-								else
-								{
-									faceNormals[i] = Vector3f(0, 0, 0);
-								}
-							}
-						
-							AddFace(nFaceVerts, facePositions, faceColours, faceNormals, faceUVs);
-							++nTotalFaceCount;
-						}
-						else
-						{
+		// The file is split into line aligned chunks that are parsed on the job workers. A prefix sum over the chunks'
+		// record counts then places each chunk's output, and a second parallel pass resolves the face indices. The
+		// result is identical to parsing the lines one after another.
+		result_t MeshBuilder::ParseObjFormat(std::string_view objString, ColourValue colour, f32 fScale)
+		{
+			using namespace ObjParser;
 
-						}
+			const u32 threadCount = Jobs::GetWorkerCount() + 1;
+			const size_t chunkCount = std::max<size_t>(1, std::min(objString.size() / kMinChunkBytes, (size_t)threadCount * kChunksPerThread));
+			std::vector<Chunk> chunks(chunkCount);
+			size_t chunkStart = 0;
+			for (size_t i = 0; i < chunkCount; ++i)
+			{
+				size_t chunkEnd = objString.size();
+				if (i + 1 < chunkCount)
+				{
+					chunkEnd = std::max(chunkStart, objString.size() * (i + 1) / chunkCount);
+					chunkEnd = std::min(objString.find_first_of('\n', chunkEnd), objString.size() - 1) + 1;
+				}
+				chunks[i].m_text = objString.substr(chunkStart, chunkEnd - chunkStart);
+				chunkStart = chunkEnd;
+			}
+
+			auto runChunks = [&chunks](const std::function<void(Chunk&)>& function)
+			{
+				if (chunks.size() == 1 || Jobs::GetWorkerCount() == 0)
+				{
+					for (Chunk& rChunk : chunks)
+					{
+						function(rChunk);
 					}
-					pos += lineLength + 1;
+					return;
 				}
-				else
+				Jobs::JobGroup group;
+				Jobs::Dispatch(group, (u32)chunks.size(), 1, [&chunks, &function](u32 begin, u32 end)
+				{
+					for (u32 i = begin; i < end; ++i)
+					{
+						function(chunks[i]);
+					}
+				});
+				Jobs::Wait(group);
+			};
+
+			runChunks(ParseChunk);
+
+			const u32 firstVertex = (u32)m_positions.size();
+			const u32 firstIndex = (u32)m_indices.size();
+			u32 positionCount = 0;
+			u32 normalCount = 0;
+			u32 uvCount = 0;
+			u32 vertexCount = 0;
+			u32 indexCount = 0;
+			u32 faceCount = 0;
+			for (Chunk& rChunk : chunks)
+			{
+				rChunk.m_positionBase = positionCount;
+				rChunk.m_normalBase = normalCount;
+				rChunk.m_uvBase = uvCount;
+				rChunk.m_vertexBase = firstVertex + vertexCount;
+				rChunk.m_indexBase = firstIndex + indexCount;
+				positionCount += (u32)rChunk.m_positions.size();
+				normalCount += (u32)rChunk.m_normals.size();
+				uvCount += (u32)rChunk.m_uvs.size();
+				vertexCount += (u32)rChunk.m_corners.size();
+				indexCount += rChunk.m_triangleCount * 3;
+				faceCount += (u32)rChunk.m_faceSizes.size();
+			}
+
+			std::vector<Vector3f> positions(positionCount);
+			std::vector<Vector3f> normals(normalCount);
+			std::vector<Vector2f> uvs(uvCount);
+			runChunks([&](Chunk& rChunk)
+			{
+				std::copy(rChunk.m_positions.begin(), rChunk.m_positions.end(), positions.begin() + rChunk.m_positionBase);
+				std::copy(rChunk.m_normals.begin(), rChunk.m_normals.end(), normals.begin() + rChunk.m_normalBase);
+				std::copy(rChunk.m_uvs.begin(), rChunk.m_uvs.end(), uvs.begin() + rChunk.m_uvBase);
+			});
+
+			m_positions.resize(firstVertex + vertexCount);
+			m_normals.resize(firstVertex + vertexCount);
+			m_uvs.resize(firstVertex + vertexCount);
+			m_colours.resize(firstVertex + vertexCount, colour);
+			m_indices.resize(firstIndex + indexCount);
+
+			// Faces are written as AddFace() would: corners reversed, then fanned from the first
+			std::atomic<bool> bBadIndex{ false };
+			runChunks([&](Chunk& rChunk)
+			{
+				u32 vertex = rChunk.m_vertexBase;
+				u32 index = rChunk.m_indexBase;
+				const Corner* pCorner = rChunk.m_corners.data();
+				for (u32 faceSize : rChunk.m_faceSizes)
 				{
-					++pos;
+					for (u32 i = 0; i < faceSize; ++i)
+					{
+						const Corner& rCorner = pCorner[faceSize - i - 1];
+						if (rCorner.m_position > positionCount || rCorner.m_uv > uvCount || rCorner.m_normal > normalCount)
+						{
+							bBadIndex = true;
+							return;
+						}
+						m_positions[vertex + i] = rCorner.m_position ? positions[rCorner.m_position - 1] * fScale : Vector3f(0, 0, 0);
+						m_uvs[vertex + i] = rCorner.m_uv ? uvs[rCorner.m_uv - 1] : Vector2f(0, 0);
+						m_normals[vertex + i] = rCorner.m_normal ? normals[rCorner.m_normal - 1] : Vector3f(0, 0, 0);
+					}
+					for (u32 i = 1; i < faceSize - 1; ++i)
+					{
+						m_indices[index++] = vertex;
+						m_indices[index++] = vertex + i;
+						m_indices[index++] = vertex + i + 1;
+					}
+					vertex += faceSize;
+					pCorner += faceSize;
 				}
-				
+			});
+
+			if (bBadIndex)
+			{
+				m_positions.resize(firstVertex);
+				m_normals.resize(firstVertex);
+				m_uvs.resize(firstVertex);
+				m_colours.resize(firstVertex);
+				m_indices.resize(firstIndex);
+				Debug::Printf("Parse OBJ: face refers to a missing vertex record\n");
+				return RESULT_FAIL;
 			}
 
-			Debug::Printf("Parse OBJ v=%u vt=%u vn=%u f=%u\n", (u32)positions.size(), (u32)texCoords.size(), (u32)normals.size(), nTotalFaceCount);
+			Debug::Printf("Parse OBJ v=%u vt=%u vn=%u f=%u\n", positionCount, uvCount, normalCount, faceCount);
 
 			return RESULT_OK;
 		}
 
-		MeshId MeshBuilder::CreateMesh()
+		// Bitwise, so -0 and +0 stay distinct; OBJ vertices that share their indices are always identical
+		static u64 HashVertex(const Vector3f& position, const Vector3f& normal, const Vector2f& uv, ColourValue colour)
 		{
-			MeshDesc desc;
-			StreamInfo streamInfos[5];
-			streamInfos[0].m_type = StreamType::POSITION;
-			streamInfos[0].m_pData = m_positions.data();
-			streamInfos[0].m_dataSize = m_positions.size() * sizeof(Vector3f);
+			u32 words[9];
+			memcpy(&words[0], &position, sizeof(Vector3f));
+			memcpy(&words[3], &normal, sizeof(Vector3f));
+			memcpy(&words[6], &uv, sizeof(Vector2f));
+			words[8] = colour.as_u32();
 
-			streamInfos[1].m_type = StreamType::COLOUR;
-			streamInfos[1].m_pData = m_colours.data();
-			streamInfos[1].m_dataSize = m_colours.size() * sizeof(u32);
+			u64 hash = 0xcbf29ce484222325ull;
+			for (u32 word : words)
+			{
+				hash = (hash ^ word) * 0x100000001b3ull;
+			}
+			return hash ^ (hash >> 29);
+		}
 
-			streamInfos[2].m_type = StreamType::NORMAL;
-			streamInfos[2].m_pData = m_normals.data();
-			streamInfos[2].m_dataSize = m_normals.size() * sizeof(Vector3f);
+		void MeshBuilder::WeldVertices()
+		{
+			const u32 vertexCount = (u32)m_positions.size();
+			if (vertexCount == 0)
+			{
+				return;
+			}
 
-			streamInfos[3].m_type = StreamType::UV;
-			streamInfos[3].m_pData = m_uvs.data();
-			streamInfos[3].m_dataSize = m_uvs.size() * sizeof(Vector2f);
+			// Open addressing table of indices into the welded streams, at most half full
+			u32 tableSize = 1;
+			while (tableSize < vertexCount * 2)
+			{
+				tableSize <<= 1;
+			}
+			static constexpr u32 kEmpty = ~0u;
+			std::vector<u32> table(tableSize, kEmpty);
 
-			streamInfos[4].m_type = StreamType::INDEX;
-			streamInfos[4].m_pData = m_indices.data();
-			streamInfos[4].m_dataSize = m_indices.size() * sizeof(u32);
+			std::vector<u32> remap(vertexCount);
+			u32 weldedCount = 0;
+			for (u32 i = 0; i < vertexCount; ++i)
+			{
+				u32 slot = (u32)HashVertex(m_positions[i], m_normals[i], m_uvs[i], m_colours[i]) & (tableSize - 1);
+				while (table[slot] != kEmpty)
+				{
+					u32 j = table[slot];
+					if (memcmp(&m_positions[i], &m_positions[j], sizeof(Vector3f)) == 0
+						&& memcmp(&m_normals[i], &m_normals[j], sizeof(Vector3f)) == 0
+						&& memcmp(&m_uvs[i], &m_uvs[j], sizeof(Vector2f)) == 0
+						&& m_colours[i].as_u32() == m_colours[j].as_u32())
+					{
+						break;
+					}
+					slot = (slot + 1) & (tableSize - 1);
+				}
 
-			desc.m_pStreams = streamInfos;
-			desc.m_streamCount = 5;
-			desc.m_vertexCount = (u32)m_positions.size();
-			desc.m_indexCount = (u32)m_indices.size();
+				if (table[slot] == kEmpty)
+				{
+					// Compacts in place: the new index never passes the one being read
+					table[slot] = weldedCount;
+					m_positions[weldedCount] = m_positions[i];
+					m_normals[weldedCount] = m_normals[i];
+					m_uvs[weldedCount] = m_uvs[i];
+					m_colours[weldedCount] = m_colours[i];
+					++weldedCount;
+				}
+				remap[i] = table[slot];
+			}
 
-			return Resources::CreateAsset<Mesh>(desc);
+			m_positions.resize(weldedCount);
+			m_normals.resize(weldedCount);
+			m_uvs.resize(weldedCount);
+			m_colours.resize(weldedCount);
+			for (u32& index : m_indices)
+			{
+				index = remap[index];
+			}
 		}
 
-		void MeshBuilder::Reset()
+		// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation": greedily emits the best scoring triangle, where a
+		// vertex scores for being recently used and for having few triangles left to draw.
+		namespace VertexCacheScore
 		{
-			m_positions.clear();
-			m_colours.clear();
-			m_normals.clear();
-			m_uvs.clear();
-			m_indices.clear();
-		}
-
-	}
-}
+			static constexpr u32 kCacheSize = 32;
+			static constexpr u32 kMaxValence = 32;
+			static constexpr f32 kLastTriScore = 0.75f;
+			static constexpr f32 kCacheDecayPower = 1.5f;
+			static constexpr f32 kValenceBoostScale = 2.0f;
+			static constexpr f32 kValenceBoostPower = 0.5f;
 
+			struct Tables
+			{
+				f32 m_cache[kCacheSize];
+				f32 m_valence[kMaxValence];
 
+				Tables()
+				{
+					for (u32 i = 0; i < kCacheSize; ++i)
+					{
+						// The last triangle's three vertices score the same, whichever order they were added in
+						m_cache[i] = i < 3 ? kLastTriScore : powf(1.0f - (f32)(i - 3) / (kCacheSize - 3), kCacheDecayPower);
+					}
+					m_valence[0] = 0.0f;
+					for (u32 i = 1; i < kMaxValence; ++i)
+					{
+						m_valence[i] = kValenceBoostScale * powf((f32)i, -kValenceBoostPower);
+					}
+				}
+			};
 
-//-----------------------------------------------------------
-// Play3dImpl\Play3dApi.cpp
+			static f32 Get(const Tables& rTables, s32 cachePosition, u32 remainingTriangles)
+			{
+				if (remainingTriangles == 0)
+				{
+					return -1.0f;
+				}
+				f32 score = cachePosition < 0 ? 0.0f : rTables.m_cache[cachePosition];
+				return score + rTables.m_valence[std::min(remainingTriangles, kMaxValence - 1)];
+			}
+		}
 
+		void MeshBuilder::OptimiseVertexCache()
+		{
+			using namespace VertexCacheScore;
+			static const Tables s_tables;
 
+			const u32 vertexCount = (u32)m_positions.size();
+			const u32 triangleCount = (u32)m_indices.size() / 3;
+			if (triangleCount == 0)
+			{
+				return;
+			}
 
+			// Triangles using each vertex, as offsets into one adjacency list
+			std::vector<u32> remaining(vertexCount, 0);
+			for (u32 index : m_indices)
+			{
+				++remaining[index];
+			}
+			std::vector<u32> adjacencyStart(vertexCount + 1, 0);
+			for (u32 v = 0; v < vertexCount; ++v)
+			{
+				adjacencyStart[v + 1] = adjacencyStart[v] + remaining[v];
+			}
+			std::vector<u32> adjacency(m_indices.size());
+			std::vector<u32> adjacencyFill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+			for (u32 t = 0; t < triangleCount; ++t)
+			{
+				for (u32 k = 0; k < 3; ++k)
+				{
+					adjacency[adjacencyFill[m_indices[t * 3 + k]]++] = t;
+				}
+			}
 
+			std::vector<s32> cachePosition(vertexCount, -1);
+			std::vector<f32> vertexScore(vertexCount);
+			for (u32 v = 0; v < vertexCount; ++v)
+			{
+				vertexScore[v] = Get(s_tables, -1, remaining[v]);
+			}
+			std::vector<f32> triangleScore(triangleCount);
+			std::vector<bool> emitted(triangleCount, false);
+			for (u32 t = 0; t < triangleCount; ++t)
+			{
+				triangleScore[t] = vertexScore[m_indices[t * 3]] + vertexScore[m_indices[t * 3 + 1]] + vertexScore[m_indices[t * 3 + 2]];
+			}
 
+			// One spare set of three for the triangle being pushed in front of the cache
+			u32 cache[kCacheSize + 3];
+			u32 cacheCount = 0;
 
+			std::vector<u32> newIndices;
+			newIndices.reserve(m_indices.size());
+			u32 bestTriangle = (u32)(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+			u32 scanStart = 0;
+			while (bestTriangle != ~0u)
+			{
+				emitted[bestTriangle] = true;
+				const u32* pTri = &m_indices[bestTriangle * 3];
 
+				// Take the triangle out of its vertices' adjacency, then move its vertices to the front of the cache
+				u32 newCache[kCacheSize + 3];
+				u32 newCacheCount = 0;
+				for (u32 k = 0; k < 3; ++k)
+				{
+					u32 v = pTri[k];
+					newIndices.push_back(v);
+					u32* pBegin = &adjacency[adjacencyStart[v]];
+					u32* pEnd = pBegin + remaining[v];
+					*std::find(pBegin, pEnd, bestTriangle) = pEnd[-1];
+					--remaining[v];
+					if (std::find(newCache, newCache + newCacheCount, v) == newCache + newCacheCount)
+					{
+						newCache[newCacheCount++] = v; // degenerate triangles repeat a vertex
+					}
+				}
+				for (u32 i = 0; i < cacheCount; ++i)
+				{
+					u32 v = cache[i];
+					if (v != pTri[0] && v != pTri[1] && v != pTri[2])
+					{
+						newCache[newCacheCount++] = v;
+					}
+				}
 
-//-----------------------------------------------------------
-// Play3dImpl\PrimitiveBatch_Impl.cpp
+				// Everything still in or just pushed out of the cache changes score, and so do its triangles
+				bestTriangle = ~0u;
+				f32 bestScore = -1.0f;
+				for (u32 i = 0; i < newCacheCount; ++i)
+				{
+					u32 v = newCache[i];
+					cachePosition[v] = i < kCacheSize ? (s32)i : -1;
+					vertexScore[v] = Get(s_tables, cachePosition[v], remaining[v]);
+				}
+				for (u32 i = 0; i < newCacheCount; ++i)
+				{
+					u32 v = newCache[i];
+					for (u32 a = adjacencyStart[v]; a < adjacencyStart[v] + remaining[v]; ++a)
+					{
+						u32 t = adjacency[a];
+						const u32* pOther = &m_indices[t * 3];
+						triangleScore[t] = vertexScore[pOther[0]] + vertexScore[pOther[1]] + vertexScore[pOther[2]];
+						if (triangleScore[t] > bestScore)
+						{
+							bestScore = triangleScore[t];
+							bestTriangle = t;
+						}
+					}
+				}
+				cacheCount = std::min(newCacheCount, kCacheSize);
+				std::copy(newCache, newCache + cacheCount, cache);
+
+				// Nothing in the cache has triangles left: carry on from the next triangle not yet emitted
+				if (bestTriangle == ~0u)
+				{
+					while (scanStart < triangleCount && emitted[scanStart])
+					{
+						++scanStart;
+					}
+					if (scanStart < triangleCount)
+					{
+						bestTriangle = scanStart;
+					}
+				}
+			}
+			m_indices.swap(newIndices);
+
+			// Vertices in the order the triangles first use them, so the vertex fetches walk forward through memory
+			std::vector<u32> remap(vertexCount, ~0u);
+			u32 nextVertex = 0;
+			for (u32& index : m_indices)
+			{
+				if (remap[index] == ~0u)
+				{
+					remap[index] = nextVertex++;
+				}
+				index = remap[index];
+			}
+
+			std::vector<Vector3f> positions(nextVertex);
+			std::vector<Vector3f> normals(nextVertex);
+			std::vector<Vector2f> uvs(nextVertex);
+			std::vector<ColourValue> colours(nextVertex);
+			for (u32 v = 0; v < vertexCount; ++v)
+			{
+				// Vertices no triangle uses are dropped
+				if (remap[v] != ~0u)
+				{
+					positions[remap[v]] = m_positions[v];
+					normals[remap[v]] = m_normals[v];
+					uvs[remap[v]] = m_uvs[v];
+					colours[remap[v]] = m_colours[v];
+				}
+			}
+			m_positions.swap(positions);
+			m_normals.swap(normals);
+			m_uvs.swap(uvs);
+			m_colours.swap(colours);
+		}
+
+		MeshId MeshBuilder::CreateMesh()
+		{
+			MeshDesc desc;
+			StreamInfo streamInfos[5];
+			streamInfos[0].m_type = StreamType::POSITION;
+			streamInfos[0].m_pData = m_positions.data();
+			streamInfos[0].m_dataSize = m_positions.size() * sizeof(Vector3f);
+
+			streamInfos[1].m_type = StreamType::COLOUR;
+			streamInfos[1].m_pData = m_colours.data();
+			streamInfos[1].m_dataSize = m_colours.size() * sizeof(u32);
+
+			streamInfos[2].m_type = StreamType::NORMAL;
+			streamInfos[2].m_pData = m_normals.data();
+			streamInfos[2].m_dataSize = m_normals.size() * sizeof(Vector3f);
+
+			streamInfos[3].m_type = StreamType::UV;
+			streamInfos[3].m_pData = m_uvs.data();
+			streamInfos[3].m_dataSize = m_uvs.size() * sizeof(Vector2f);
+
+			std::vector<u16> shortIndices;
+			if (GetIndexStride() == sizeof(u16))
+			{
+				shortIndices.assign(m_indices.begin(), m_indices.end());
+				streamInfos[4].m_type = StreamType::INDEX16;
+				streamInfos[4].m_pData = shortIndices.data();
+				streamInfos[4].m_dataSize = shortIndices.size() * sizeof(u16);
+			}
+			else
+			{
+				streamInfos[4].m_type = StreamType::INDEX;
+				streamInfos[4].m_pData = m_indices.data();
+				streamInfos[4].m_dataSize = m_indices.size() * sizeof(u32);
+			}
+
+			desc.m_pStreams = streamInfos;
+			desc.m_streamCount = 5;
+			desc.m_vertexCount = (u32)m_positions.size();
+			desc.m_indexCount = (u32)m_indices.size();
+
+			return Resources::CreateAsset<Mesh>(desc);
+		}
+
+		result_t MeshBuilder::SaveMeshCache(const char* filePath, u64 sourceHash) const
+		{
+			std::vector<u8> file;
+			BuildMeshCache(sourceHash, file);
+			return System::SaveFileData(filePath, file.data(), file.size());
+		}
+
+		void MeshBuilder::BuildMeshCache(u64 sourceHash, std::vector<u8>& fileOut) const
+		{
+			std::vector<u16> shortIndices;
+			const void* pIndexData = m_indices.data();
+			if (GetIndexStride() == sizeof(u16))
+			{
+				shortIndices.assign(m_indices.begin(), m_indices.end());
+				pIndexData = shortIndices.data();
+			}
+			const void* pStreams[MESH_CACHE_STREAM_COUNT] = { m_positions.data(), m_colours.data(), m_normals.data(), m_uvs.data(), pIndexData };
+
+			MeshCacheHeader header = {};
+			header.m_magic = MeshCacheHeader::kMagic;
+			header.m_version = MeshCacheHeader::kVersion;
+			header.m_sourceHash = sourceHash;
+			header.m_vertexCount = (u32)m_positions.size();
+			header.m_indexCount = (u32)m_indices.size();
+			header.m_indexStride = GetIndexStride();
+			header.m_streamSizes[MESH_CACHE_POSITION] = (u32)(m_positions.size() * sizeof(Vector3f));
+			header.m_streamSizes[MESH_CACHE_COLOUR] = (u32)(m_colours.size() * sizeof(u32));
+			header.m_streamSizes[MESH_CACHE_NORMAL] = (u32)(m_normals.size() * sizeof(Vector3f));
+			header.m_streamSizes[MESH_CACHE_UV] = (u32)(m_uvs.size() * sizeof(Vector2f));
+			header.m_streamSizes[MESH_CACHE_INDEX] = (u32)(m_indices.size() * header.m_indexStride);
+
+			u64 offset = (sizeof(MeshCacheHeader) + 15) & ~15ull;
+			for (u32 i = 0; i < MESH_CACHE_STREAM_COUNT; ++i)
+			{
+				header.m_streamOffsets[i] = (u32)offset;
+				offset = (offset + header.m_streamSizes[i] + 15) & ~15ull;
+			}
+			header.m_fileSize = offset;
+
+			fileOut.assign((size_t)header.m_fileSize, 0);
+			memcpy(fileOut.data(), &header, sizeof(header));
+			for (u32 i = 0; i < MESH_CACHE_STREAM_COUNT; ++i)
+			{
+				if (header.m_streamSizes[i] > 0)
+				{
+					memcpy(fileOut.data() + header.m_streamOffsets[i], pStreams[i], header.m_streamSizes[i]);
+				}
+			}
+		}
+
+		void MeshBuilder::Reset()
+		{
+			m_positions.clear();
+			m_colours.clear();
+			m_normals.clear();
+			m_uvs.clear();
+			m_indices.clear();
+		}
+
+	}
+}
+
+
+
+//-----------------------------------------------------------
+// Play3dImpl\Play3dApi.cpp
+
+
+
+
+
+
+
+
+//-----------------------------------------------------------
+// Play3dImpl\PrimitiveBatch_Impl.cpp
 
 
 namespace Play3d
@@ -5485,12 +7594,17 @@ namespace Play3d
 	{
 
 		PrimitiveBatch::PrimitiveBatch(ID3D11Device* pDevice, u32 kMaxVertexCount)
-		 : m_totalVertexCount(0)
+		 : m_points(kMaxVertexCount)
+		 , m_pointCount(0)
+		 , m_totalVertexCount(0)
 		 , m_maxVertexCount(kMaxVertexCount)
 		 , m_pointVertexCount(0)
 		 , m_lineVertexCount(0)
 		 , m_triangleVertexCount(0)
 		{
+#ifdef PLAY_HEADLESS
+			m_mockVertexBuffer.resize(kMaxVertexCount);
+#else
 			D3D11_BUFFER_DESC desc = {};
 			desc.ByteWidth = sizeof(PrimitiveVertex) * kMaxVertexCount;
 			desc.Usage = D3D11_USAGE::D3D11_USAGE_DYNAMIC;
@@ -5500,6 +7614,7 @@ namespace Play3d
 			desc.StructureByteStride = 0;
 			HRESULT hr = pDevice->CreateBuffer(&desc, NULL, &m_pVertexBuffer);
 			PLAY_ASSERT_MSG(SUCCEEDED(hr), "CreateBuffer");
+#endif
 		}
 
 		PrimitiveBatch::~PrimitiveBatch()
@@ -5511,31 +7626,52 @@ namespace Play3d
 		{
 			if((m_totalVertexCount + 1) < m_maxVertexCount)
 			{
-				m_points.push_back({ v1, c1 });
+				m_points[m_pointCount++] = { v1, c1 };
 				m_totalVertexCount += 1;
 			}
 		}
 
+		PrimitiveVertex* PrimitiveBatch::ReservePoints(u32 count, u32& reservedOut)
+		{
+			u32 available = (m_totalVertexCount + 1 < m_maxVertexCount) ? m_maxVertexCount - 1 - m_totalVertexCount : 0;
+			reservedOut = std::min(count, available);
+
+			PrimitiveVertex* pVertices = m_points.data() + m_pointCount;
+			m_pointCount += reservedOut;
+			m_totalVertexCount += reservedOut;
+			return pVertices;
+		}
+
+		// Lines and triangles share the vertex buffer with the points, so are bounded by the same total
 		void PrimitiveBatch::AppendLine(const Vector3f& v1, const Vector3f& v2, ColourValue c1, ColourValue c2)
 		{
-			m_lines.push_back({ v1, c1 });
-			m_lines.push_back({ v2, c2 });
+			if((m_totalVertexCount + 2) < m_maxVertexCount)
+			{
+				m_lines.push_back({ v1, c1 });
+				m_lines.push_back({ v2, c2 });
+				m_totalVertexCount += 2;
+			}
 		}
 
 		void PrimitiveBatch::AppendTriangle(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3, ColourValue c1, ColourValue c2, ColourValue c3)
 		{
-			m_triangles.push_back({ v1, c1 });
-			m_triangles.push_back({ v2, c2 });
-			m_triangles.push_back({ v3, c3 });
+			if((m_totalVertexCount + 3) < m_maxVertexCount)
+			{
+				m_triangles.push_back({ v1, c1 });
+				m_triangles.push_back({ v2, c2 });
+				m_triangles.push_back({ v3, c3 });
+				m_totalVertexCount += 3;
+			}
 		}
 
+#ifndef PLAY_HEADLESS
 		void PrimitiveBatch::Flush(ID3D11DeviceContext* pContext)
 		{
 			D3D11_MAPPED_SUBRESOURCE data;
 			HRESULT hr = pContext->Map(m_pVertexBuffer.Get(), 0, D3D11_MAP::D3D11_MAP_WRITE_DISCARD, 0, &data);
 			if (SUCCEEDED(hr))
 			{
-				m_pointVertexCount = (u32)m_points.size();
+				m_pointVertexCount = m_pointCount;
 				m_lineVertexCount = (u32)m_lines.size();
 				m_triangleVertexCount = (u32)m_triangles.size();
 
@@ -5552,7 +7688,7 @@ namespace Play3d
 
 
 				m_totalVertexCount = 0;
-				m_points.clear();
+				m_pointCount = 0;
 				m_lines.clear();
 				m_triangles.clear();
 			}
@@ -5595,6 +7731,27 @@ namespace Play3d
 			}
 		}
 
+#else
+		void PrimitiveBatch::Flush(ID3D11DeviceContext* pContext)
+		{
+			m_pointVertexCount = m_pointCount;
+			m_lineVertexCount = (u32)m_lines.size();
+			m_triangleVertexCount = (u32)m_triangles.size();
+
+			PrimitiveVertex* pVertexOut = m_mockVertexBuffer.data();
+			memcpy(pVertexOut, m_points.data(), m_pointVertexCount * sizeof(PrimitiveVertex));
+			pVertexOut += m_pointVertexCount;
+			memcpy(pVertexOut, m_lines.data(), m_lineVertexCount * sizeof(PrimitiveVertex));
+			pVertexOut += m_lineVertexCount;
+			memcpy(pVertexOut, m_triangles.data(), m_triangleVertexCount * sizeof(PrimitiveVertex));
+
+			m_totalVertexCount = 0;
+			m_pointCount = 0;
+			m_lines.clear();
+			m_triangles.clear();
+		}
+#endif
+
 	}
 }
 
@@ -5608,112 +7765,580 @@ namespace Play3d
 	namespace Resources
 	{
 
-		IdKey<AsyncLoadingTask> AsyncLoadAssets(std::string_view pathToAssetPack)
+		enum class AssetType
 		{
-			return IdKey<AsyncLoadingTask>();
-		}
+			MESH,
+			TEXTURE,
+			SOUND,
+			SHADER,
+		};
 
-		bool AssetsLoaded(IdKey<AsyncLoadingTask> hAsyncLoad)
+		using LoadClock = std::chrono::steady_clock;
+
+		static f32 MillisecondsSince(LoadClock::time_point start)
 		{
-			return true;
+			return std::chrono::duration<f32, std::milli>(LoadClock::now() - start).count();
 		}
 
-		Play3d::result_t LoadAssets(std::string_view pathToAssetPack)
+		// One asset of a pack. The loader thread fills in the decoded data, then the main thread creates the resource.
+		struct AssetRequest
 		{
-			return 0;
-		}
+			AssetType m_type;
+			std::string m_path;
+			f32 m_fScale = 1.0f;
 
-	}
-}
+			result_t m_result = RESULT_FAIL;
+			std::vector<u8> m_data; // .p3m image, RGBA pixels or vertex shader bytecode
+			std::vector<u8> m_pixelShader;
+			std::vector<u8> m_instancedVertexShader; // only if the file has a VS_MainInstanced
+			u32 m_width = 0;
+			u32 m_height = 0;
+			void* m_pFileData = nullptr; // sounds
+			size_t m_fileSize = 0;
+			f32 m_loadMs = 0.0f;
+
+			std::atomic<bool> m_bDecoded{ false };
+			bool m_bCreated = false;
+		};
 
+		class AsyncLoadingTask
+		{
+		public:
+			AsyncLoadingTask(std::string_view packPath) : m_packPath(packPath), m_startTime(LoadClock::now()) {}
+			~AsyncLoadingTask()
+			{
+				for (AssetRequest* pRequest : m_requests)
+				{
+					System::ReleaseFileData(pRequest->m_pFileData);
+					delete pRequest;
+				}
+			}
+			PLAY_NONCOPYABLE(AsyncLoadingTask);
 
+			std::string m_packPath;
+			std::vector<AssetRequest*> m_requests;
+			LoadClock::time_point m_startTime;
+			u32 m_createdCount = 0;
+			bool m_bFailed = false;
+		};
 
-//-----------------------------------------------------------
-// Play3dImpl\Sampler.cpp
+		// File I/O and decoding for AsyncLoadAssets(), on threads of its own so a slow read never holds up the job
+		// workers the frame depends on.
+		class AssetLoader_Impl
+		{
+			PLAY_SINGLETON_INTERFACE(AssetLoader_Impl);
+		public:
+			static constexpr u32 kThreadCount = 2;
 
+			AssetLoader_Impl()
+			{
+				for (u32 i = 0; i < kThreadCount; ++i)
+				{
+					m_threads.emplace_back([this]() { ThreadLoop(); });
+				}
+			}
 
+			// Anything still queued is decoded before returning
+			~AssetLoader_Impl()
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_bQuit = true;
+				}
+				m_workAvailable.notify_all();
+				for (std::thread& thread : m_threads)
+				{
+					thread.join();
+				}
+			}
 
-namespace Play3d
-{
-	namespace Graphics
-	{
-		D3D11_FILTER TranslateFilterMode(FilterMode mode)
-		{
-			switch (mode)
+			void Queue(AssetRequest* pRequest)
 			{
-			case FilterMode::BILINEAR:
-				return D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-			case FilterMode::POINT:
-				return D3D11_FILTER_MIN_MAG_MIP_POINT;
-			default:
-				return D3D11_FILTER_MIN_MAG_MIP_POINT;
-			};
-		}
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_queue.push_back(pRequest);
+				}
+				m_workAvailable.notify_one();
+			}
 
-		D3D11_TEXTURE_ADDRESS_MODE TranslateAddressMode(AddressMode mode)
-		{
-			switch (mode)
+			// Blocks until another request has been decoded
+			void WaitForDecode(u32 decodedCount)
 			{
-			case AddressMode::CLAMP:
-				return D3D11_TEXTURE_ADDRESS_CLAMP;
-			case AddressMode::WRAP:
-				return D3D11_TEXTURE_ADDRESS_WRAP;
-			default:
-				return D3D11_TEXTURE_ADDRESS_CLAMP;
-			};
-		}
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_decoded.wait(lock, [this, decodedCount]() { return m_decodedCount != decodedCount; });
+			}
 
-		Sampler::Sampler(const SamplerDesc& rDesc)
-		{
-			ID3D11Device* pDevice = Graphics::Graphics_Impl::Instance().GetDevice();
+			u32 GetDecodedCount()
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				return m_decodedCount;
+			}
 
-			D3D11_SAMPLER_DESC desc = {};
-			desc.Filter = TranslateFilterMode(rDesc.m_filter);
-			D3D11_TEXTURE_ADDRESS_MODE mode = TranslateAddressMode(rDesc.m_addressMode);
-			desc.AddressU = mode;
-			desc.AddressV = mode;
-			desc.AddressW = mode;
+		private:
+			void ThreadLoop()
+			{
+#ifndef PLAY_HEADLESS
+				CoInitializeEx(nullptr, COINIT_MULTITHREADED); // for WIC
+#endif
+				std::unique_lock<std::mutex> lock(m_mutex);
+				for (;;)
+				{
+					m_workAvailable.wait(lock, [this]() { return m_bQuit || !m_queue.empty(); });
+					if (m_queue.empty())
+					{
+						break;
+					}
+					AssetRequest* pRequest = m_queue.front();
+					m_queue.pop_front();
+
+					lock.unlock();
+					LoadClock::time_point start = LoadClock::now();
+					Decode(*pRequest);
+					pRequest->m_loadMs = MillisecondsSince(start);
+					pRequest->m_bDecoded.store(true, std::memory_order_release);
+					lock.lock();
+
+					++m_decodedCount;
+					m_decoded.notify_all();
+				}
+				lock.unlock();
+#ifndef PLAY_HEADLESS
+				CoUninitialize();
+#endif
+			}
 
-			HRESULT hr = pDevice->CreateSamplerState(&desc, &m_pSampler);
-			PLAY_ASSERT(SUCCEEDED(hr));
+			static void Decode(AssetRequest& rRequest)
+			{
+				switch (rRequest.m_type)
+				{
+				case AssetType::MESH:
+					rRequest.m_result = Graphics::LoadMeshCacheData(rRequest.m_path.c_str(), Colour::White, rRequest.m_fScale, rRequest.m_data);
+					break;
+				case AssetType::TEXTURE:
+					rRequest.m_result = Graphics::DecodeImageFile(rRequest.m_path.c_str(), rRequest.m_width, rRequest.m_height, rRequest.m_data);
+					break;
+				case AssetType::SOUND:
+					rRequest.m_pFileData = System::LoadFileData(rRequest.m_path.c_str(), rRequest.m_fileSize);
+					rRequest.m_result = rRequest.m_pFileData ? RESULT_OK : RESULT_FAIL;
+					break;
+				case AssetType::SHADER:
+					rRequest.m_result = CompileShaderFile(rRequest);
+					break;
+				}
+			}
 
-		}
-	}
-}
+			static result_t CompileShaderFile(AssetRequest& rRequest)
+			{
+				size_t hlslSize = 0;
+				const char* pHlsl = (const char*)System::LoadFileData(rRequest.m_path.c_str(), hlslSize);
+				if (!pHlsl)
+				{
+					return RESULT_FAIL;
+				}
 
+				Graphics::ShaderCompilerDesc desc;
+				desc.m_flags = (u32)Graphics::ShaderCompilationFlags::DEBUG;
+				desc.m_hlslCode = std::string(pHlsl, hlslSize);
+				desc.m_sourcePath = rRequest.m_path;
+				desc.m_defines.push_back({ "MAX_LIGHTS", "4" }); // the size of the framework's light arrays
+				System::ReleaseFileData(const_cast<char*>(pHlsl));
 
-//-----------------------------------------------------------
-// Play3dImpl\Shader.cpp
+				desc.m_type = Graphics::ShaderType::VERTEX_SHADER;
+				desc.m_name = rRequest.m_path + "_VS";
+				desc.m_entryPoint = "VS_Main";
+				result_t result = Graphics::CompileShaderByteCode(desc, rRequest.m_data);
+				if (RESULT_OK != result)
+				{
+					return result;
+				}
 
+				if (desc.m_hlslCode.find("VS_MainInstanced") != std::string::npos)
+				{
+					desc.m_name = rRequest.m_path + "_VSI";
+					desc.m_entryPoint = "VS_MainInstanced";
+					result = Graphics::CompileShaderByteCode(desc, rRequest.m_instancedVertexShader);
+					if (RESULT_OK != result)
+					{
+						return result;
+					}
+				}
 
+				desc.m_type = Graphics::ShaderType::PIXEL_SHADER;
+				desc.m_name = rRequest.m_path + "_PS";
+				desc.m_entryPoint = "PS_Main";
+				return Graphics::CompileShaderByteCode(desc, rRequest.m_pixelShader);
+			}
 
-#pragma comment(lib,"d3dcompiler.lib")
+			std::vector<std::thread> m_threads;
+			std::deque<AssetRequest*> m_queue;
+			std::mutex m_mutex;
+			std::condition_variable m_workAvailable;
+			std::condition_variable m_decoded;
+			u32 m_decodedCount = 0;
+			bool m_bQuit = false;
+		};
 
-namespace Play3d
-{
-	namespace Graphics
-	{
+		PLAY_SINGLETON_IMPL(AssetLoader_Impl);
 
-		Shader::Shader(const ShaderDesc& rDesc)
-			: m_shaderType(rDesc.m_type)
-			, m_pByteCode(nullptr)
-			, m_sizeBytes(0)
+		static bool IsAssetLoaded(AssetType type, std::string_view path)
 		{
-			auto pDevice(Graphics_Impl::Instance().GetDevice());
-			
-			HRESULT hr;
+			switch (type)
+			{
+			case AssetType::MESH:
+				return FindAsset<Graphics::Mesh>(path).IsValid();
+			case AssetType::TEXTURE:
+				return FindAsset<Graphics::Texture>(path).IsValid();
+			case AssetType::SOUND:
+				return FindAsset<Audio::Sound>(path).IsValid();
+			case AssetType::SHADER:
+				return FindAsset<Graphics::Shader>(std::string(path) + "_VS").IsValid()
+					&& FindAsset<Graphics::Shader>(std::string(path) + "_PS").IsValid();
+			}
+			return false;
+		}
 
-			std::string name(rDesc.m_name);
+		static void CreateShader(Graphics::ShaderType type, const std::string& name, std::vector<u8>& rByteCode)
+		{
+			Graphics::ShaderDesc desc;
+			desc.m_type = type;
+			desc.m_name = name;
+			desc.m_pByteCode = rByteCode.data();
+			desc.m_sizeBytes = rByteCode.size();
+			Graphics::ShaderId shaderId = CreateAsset<Graphics::Shader>(desc);
+			ResourceManager<Graphics::Shader>::Instance().AddAlias(name, shaderId);
+		}
 
-			switch (rDesc.m_type)
-			{
-			case ShaderType::VERTEX_SHADER:
+		// The final step, on the main thread
+		static result_t CreateRequestedAsset(AssetRequest& rRequest)
+		{
+			// Another task may have loaded it in the meantime
+			if (RESULT_OK != rRequest.m_result || IsAssetLoaded(rRequest.m_type, rRequest.m_path))
 			{
-				ComPtr<ID3D11VertexShader> pVertexShader;
-				hr = pDevice->CreateVertexShader(rDesc.m_pByteCode, rDesc.m_sizeBytes, NULL, &pVertexShader);
-				PLAY_ASSERT_MSG(SUCCEEDED(hr), "Failed to create vertex shader.");
+				return rRequest.m_result;
+			}
 
-				hr = pVertexShader.As(&m_pShader);
+			switch (rRequest.m_type)
+			{
+			case AssetType::MESH:
+			{
+				Graphics::MeshId meshId = Graphics::CreateMeshFromCacheData(rRequest.m_data.data());
+				ResourceManager<Graphics::Mesh>::Instance().AddAlias(rRequest.m_path, meshId);
+				break;
+			}
+			case AssetType::TEXTURE:
+			{
+				Graphics::TextureDesc desc;
+				desc.m_width = rRequest.m_width;
+				desc.m_height = rRequest.m_height;
+				desc.m_format = Graphics::TextureFormat::RGBA;
+				desc.m_pImageData = rRequest.m_data.data();
+				Graphics::TextureId textureId = CreateAsset<Graphics::Texture>(desc);
+				ResourceManager<Graphics::Texture>::Instance().AddAlias(rRequest.m_path, textureId);
+				break;
+			}
+			case AssetType::SOUND:
+			{
+				Audio::SoundDesc desc;
+				desc.m_pData = rRequest.m_pFileData;
+				desc.m_sizeBytes = rRequest.m_fileSize;
+				Audio::SoundId soundId = CreateAsset<Audio::Sound>(desc);
+				ResourceManager<Audio::Sound>::Instance().AddAlias(rRequest.m_path, soundId);
+				break;
+			}
+			case AssetType::SHADER:
+				CreateShader(Graphics::ShaderType::VERTEX_SHADER, rRequest.m_path + "_VS", rRequest.m_data);
+				CreateShader(Graphics::ShaderType::PIXEL_SHADER, rRequest.m_path + "_PS", rRequest.m_pixelShader);
+				if (!rRequest.m_instancedVertexShader.empty())
+				{
+					CreateShader(Graphics::ShaderType::VERTEX_SHADER, rRequest.m_path + "_VSI", rRequest.m_instancedVertexShader);
+				}
+				break;
+			}
+
+			// Done with the decoded copy
+			std::vector<u8>().swap(rRequest.m_data);
+			std::vector<u8>().swap(rRequest.m_pixelShader);
+			std::vector<u8>().swap(rRequest.m_instancedVertexShader);
+			System::ReleaseFileData(rRequest.m_pFileData);
+			rRequest.m_pFileData = nullptr;
+			return RESULT_OK;
+		}
+
+		static result_t ParseAssetPack(std::string_view pack, AsyncLoadingTask& rTask)
+		{
+			while (!pack.empty())
+			{
+				size_t lineEnd = std::min(pack.find_first_of('\n'), pack.size());
+				std::string_view line = pack.substr(0, lineEnd);
+				pack.remove_prefix(std::min(lineEnd + 1, pack.size()));
+
+				std::string_view args[3];
+				u32 argCount = 0;
+				while (argCount < 3)
+				{
+					size_t argStart = line.find_first_not_of(" \t\r");
+					if (argStart == std::string_view::npos || line[argStart] == '#')
+					{
+						break;
+					}
+					line.remove_prefix(argStart);
+					size_t argEnd = std::min(line.find_first_of(" \t\r"), line.size());
+					args[argCount++] = line.substr(0, argEnd);
+					line.remove_prefix(argEnd);
+				}
+				if (argCount == 0)
+				{
+					continue;
+				}
+
+				AssetRequest request;
+				if (args[0] == "mesh" && argCount >= 2)
+				{
+					request.m_type = AssetType::MESH;
+					if (argCount == 3)
+					{
+						std::from_chars(args[2].data(), args[2].data() + args[2].size(), request.m_fScale);
+					}
+				}
+				else if (args[0] == "texture" && argCount == 2)
+				{
+					request.m_type = AssetType::TEXTURE;
+				}
+				else if (args[0] == "sound" && argCount == 2)
+				{
+					request.m_type = AssetType::SOUND;
+				}
+				else if (args[0] == "shader" && argCount == 2)
+				{
+					request.m_type = AssetType::SHADER;
+				}
+				else
+				{
+					Debug::Printf("Asset pack %s: can't read \"%.*s\"\n", rTask.m_packPath.c_str(), (int)args[0].size(), args[0].data());
+					return RESULT_FAIL;
+				}
+
+				if (!IsAssetLoaded(request.m_type, args[1]))
+				{
+					AssetRequest* pRequest = new AssetRequest;
+					pRequest->m_type = request.m_type;
+					pRequest->m_path = std::string(args[1]);
+					pRequest->m_fScale = request.m_fScale;
+					rTask.m_requests.push_back(pRequest);
+				}
+			}
+			return RESULT_OK;
+		}
+
+		IdKey<AsyncLoadingTask> AsyncLoadAssets(std::string_view pathToAssetPack)
+		{
+			// The pack itself is a small text file, read here
+			std::string packPath(pathToAssetPack);
+			size_t packSize = 0;
+			const char* pPack = (const char*)System::LoadFileData(packPath.c_str(), packSize);
+			if (!pPack)
+			{
+				Debug::Printf("Asset pack %s not found\n", packPath.c_str());
+				return IdKey<AsyncLoadingTask>();
+			}
+
+			ResourceManager<AsyncLoadingTask>& rTasks = ResourceManager<AsyncLoadingTask>::Instance();
+			IdKey<AsyncLoadingTask> taskId = rTasks.Create(pathToAssetPack);
+			AsyncLoadingTask* pTask = rTasks.GetPtr(taskId);
+			result_t result = ParseAssetPack(std::string_view(pPack, packSize), *pTask);
+			System::ReleaseFileData(const_cast<char*>(pPack));
+			if (RESULT_OK != result)
+			{
+				rTasks.Release(taskId);
+				return IdKey<AsyncLoadingTask>();
+			}
+
+			// Named so LoadAssets() can find it
+			rTasks.AddAlias(pathToAssetPack, taskId);
+
+			for (AssetRequest* pRequest : pTask->m_requests)
+			{
+				AssetLoader_Impl::Instance().Queue(pRequest);
+			}
+			return taskId;
+		}
+
+		static std::vector<AssetLoadTime> s_assetLoadTimes;
+
+		const std::vector<AssetLoadTime>& GetAssetLoadTimes()
+		{
+			return s_assetLoadTimes;
+		}
+
+		// Returns true once every asset of the task has been created
+		static bool CreateDecodedAssets(AsyncLoadingTask& rTask)
+		{
+			for (AssetRequest* pRequest : rTask.m_requests)
+			{
+				if (!pRequest->m_bCreated && pRequest->m_bDecoded.load(std::memory_order_acquire))
+				{
+					pRequest->m_bCreated = true;
+					++rTask.m_createdCount;
+					LoadClock::time_point start = LoadClock::now();
+					if (RESULT_OK != CreateRequestedAsset(*pRequest))
+					{
+						Debug::Printf("Asset pack %s: failed to load %s\n", rTask.m_packPath.c_str(), pRequest->m_path.c_str());
+						rTask.m_bFailed = true;
+						continue;
+					}
+					s_assetLoadTimes.push_back({ pRequest->m_path, pRequest->m_loadMs, MillisecondsSince(start) });
+				}
+			}
+			if (rTask.m_createdCount != rTask.m_requests.size())
+			{
+				return false;
+			}
+
+			if (!rTask.m_requests.empty())
+			{
+				Debug::Printf("Asset pack %s: %zu assets in %.2f ms\n", rTask.m_packPath.c_str(), rTask.m_requests.size(), MillisecondsSince(rTask.m_startTime));
+			}
+			return true;
+		}
+
+		bool AssetsLoaded(IdKey<AsyncLoadingTask> hAsyncLoad)
+		{
+			ResourceManager<AsyncLoadingTask>& rTasks = ResourceManager<AsyncLoadingTask>::Instance();
+			if (!rTasks.IsAlive(hAsyncLoad))
+			{
+				return true;
+			}
+			if (!CreateDecodedAssets(*rTasks.GetPtr(hAsyncLoad)))
+			{
+				return false;
+			}
+			rTasks.Release(hAsyncLoad);
+			return true;
+		}
+
+		result_t LoadAssets(std::string_view pathToAssetPack)
+		{
+			ResourceManager<AsyncLoadingTask>& rTasks = ResourceManager<AsyncLoadingTask>::Instance();
+			IdKey<AsyncLoadingTask> taskId = rTasks.Find(pathToAssetPack);
+			if (!taskId.IsValid())
+			{
+				taskId = AsyncLoadAssets(pathToAssetPack);
+				if (!taskId.IsValid())
+				{
+					return RESULT_FAIL;
+				}
+			}
+
+			AssetLoader_Impl& rLoader = AssetLoader_Impl::Instance();
+			AsyncLoadingTask* pTask = rTasks.GetPtr(taskId);
+			for (;;)
+			{
+				// Read before creating, so a request decoded in between still ends the wait
+				u32 decodedCount = rLoader.GetDecodedCount();
+				if (CreateDecodedAssets(*pTask))
+				{
+					break;
+				}
+				rLoader.WaitForDecode(decodedCount);
+			}
+
+			bool bFailed = pTask->m_bFailed;
+			rTasks.Release(taskId);
+			return bFailed ? RESULT_FAIL : RESULT_OK;
+		}
+
+	}
+}
+
+
+
+//-----------------------------------------------------------
+// Play3dImpl\Sampler.cpp
+#ifndef PLAY_HEADLESS
+
+
+
+namespace Play3d
+{
+	namespace Graphics
+	{
+		D3D11_FILTER TranslateFilterMode(FilterMode mode)
+		{
+			switch (mode)
+			{
+			case FilterMode::BILINEAR:
+				return D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+			case FilterMode::POINT:
+				return D3D11_FILTER_MIN_MAG_MIP_POINT;
+			default:
+				return D3D11_FILTER_MIN_MAG_MIP_POINT;
+			};
+		}
+
+		D3D11_TEXTURE_ADDRESS_MODE TranslateAddressMode(AddressMode mode)
+		{
+			switch (mode)
+			{
+			case AddressMode::CLAMP:
+				return D3D11_TEXTURE_ADDRESS_CLAMP;
+			case AddressMode::WRAP:
+				return D3D11_TEXTURE_ADDRESS_WRAP;
+			default:
+				return D3D11_TEXTURE_ADDRESS_CLAMP;
+			};
+		}
+
+		Sampler::Sampler(const SamplerDesc& rDesc)
+		{
+			ID3D11Device* pDevice = Graphics::Graphics_Impl::Instance().GetDevice();
+
+			D3D11_SAMPLER_DESC desc = {};
+			desc.Filter = TranslateFilterMode(rDesc.m_filter);
+			D3D11_TEXTURE_ADDRESS_MODE mode = TranslateAddressMode(rDesc.m_addressMode);
+			desc.AddressU = mode;
+			desc.AddressV = mode;
+			desc.AddressW = mode;
+
+			HRESULT hr = pDevice->CreateSamplerState(&desc, &m_pSampler);
+			PLAY_ASSERT(SUCCEEDED(hr));
+
+		}
+	}
+}
+
+
+//-----------------------------------------------------------
+// Play3dImpl\Shader.cpp
+
+
+
+#pragma comment(lib,"d3dcompiler.lib")
+
+namespace Play3d
+{
+	namespace Graphics
+	{
+
+		Shader::Shader(const ShaderDesc& rDesc)
+			: m_shaderType(rDesc.m_type)
+			, m_pByteCode(nullptr)
+			, m_sizeBytes(0)
+		{
+			auto pDevice(Graphics_Impl::Instance().GetDevice());
+			
+			HRESULT hr;
+
+			std::string name(rDesc.m_name);
+
+			switch (rDesc.m_type)
+			{
+			case ShaderType::VERTEX_SHADER:
+			{
+				ComPtr<ID3D11VertexShader> pVertexShader;
+				hr = pDevice->CreateVertexShader(rDesc.m_pByteCode, rDesc.m_sizeBytes, NULL, &pVertexShader);
+				PLAY_ASSERT_MSG(SUCCEEDED(hr), "Failed to create vertex shader.");
+
+				hr = pVertexShader.As(&m_pShader);
 				PLAY_ASSERT(SUCCEEDED(hr));
 
 				name += "_VS";
@@ -5782,7 +8407,35 @@ namespace Play3d
 			};
 		}
 
-		ShaderId Shader::Compile(const ShaderCompilerDesc& rDesc)
+		// Gives D3DCompile the files a shader #includes, read through the tracker so the cache learns of them
+		class ShaderIncludeHandler : public ID3DInclude
+		{
+		public:
+			explicit ShaderIncludeHandler(ShaderIncludeTracker& rTracker) : m_rTracker(rTracker) {}
+
+			HRESULT __stdcall Open(D3D_INCLUDE_TYPE includeType, LPCSTR pFileName, LPCVOID pParentData, LPCVOID* ppData, UINT* pBytes) override
+			{
+				const void* pData = nullptr;
+				size_t size = 0;
+				if (!m_rTracker.Open(pFileName, pParentData, pData, size))
+				{
+					return E_FAIL;
+				}
+				*ppData = pData;
+				*pBytes = (UINT)size;
+				return S_OK;
+			}
+
+			HRESULT __stdcall Close(LPCVOID pData) override
+			{
+				return S_OK; // the tracker keeps the files until the compile is done
+			}
+
+		private:
+			ShaderIncludeTracker& m_rTracker;
+		};
+
+		result_t CompileHLSL(const ShaderCompilerDesc& rDesc, std::vector<u8>& byteCodeOut, std::vector<ShaderInclude>& includesOut)
 		{
 			Debug::Printf("Compiling %s : %s\n", rDesc.m_name.c_str(), rDesc.m_entryPoint.c_str());
 
@@ -5812,13 +8465,15 @@ namespace Play3d
 
 			ComPtr<ID3DBlob> pShaderBlob;
 			ComPtr<ID3DBlob> pErrorBlob;
+			ShaderIncludeTracker includeTracker(rDesc.m_sourcePath);
+			ShaderIncludeHandler includeHandler(includeTracker);
 
 			HRESULT hr = D3DCompile(
 				rDesc.m_hlslCode.c_str(),
 				rDesc.m_hlslCode.size(),
-				NULL,
+				rDesc.m_sourcePath.empty() ? NULL : rDesc.m_sourcePath.c_str(),
 				defines.data(),
-				NULL,
+				&includeHandler,
 				rDesc.m_entryPoint.c_str(),
 				pTarget,
 				flags,
@@ -5833,12 +8488,26 @@ namespace Play3d
 				{
 					Debug::Printf("!! Shader Compilation Failed !! : \n--------------------------------\n\n%s\n\n--------------------------------", (const char*)pErrorBlob->GetBufferPointer());
 				}
+				return RESULT_FAIL;
+			}
+
+			const u8* pByteCode = (const u8*)pShaderBlob->GetBufferPointer();
+			byteCodeOut.assign(pByteCode, pByteCode + pShaderBlob->GetBufferSize());
+			includesOut = includeTracker.GetIncludes();
+			return RESULT_OK;
+		}
+
+		ShaderId Shader::Compile(const ShaderCompilerDesc& rDesc)
+		{
+			std::vector<u8> byteCode;
+			if (RESULT_OK != CompileShaderByteCode(rDesc, byteCode))
+			{
 				return ShaderId();
 			}
 
 			ShaderDesc desc;
-			desc.m_pByteCode = pShaderBlob->GetBufferPointer();
-			desc.m_sizeBytes = pShaderBlob->GetBufferSize();
+			desc.m_pByteCode = byteCode.data();
+			desc.m_sizeBytes = byteCode.size();
 			desc.m_type = rDesc.m_type;
 			desc.m_name = rDesc.m_name;
 
@@ -5942,6 +8611,22 @@ PSInput VS_Main(VSInput input)
 	output.uv = input.uv;
 	return output;
 }
+struct InstanceData
+{
+	float4x4 worldMtx;
+	float4x4 normalMtx;
+};
+StructuredBuffer<InstanceData> g_instances : register(t4);
+PSInput VS_MainInstanced(VSInput input, uint instanceId : SV_InstanceID)
+{
+	InstanceData instance = g_instances[instanceId];
+	PSInput output;
+	output.position = mul(viewProjectionMtx, mul(instance.worldMtx, float4(input.position.xyz, 1.0f)));
+	output.colour = pow(input.colour, 2.2); // Gamma correct from sRGB.
+	output.normal = mul(instance.normalMtx, float4(input.normal.xyz, 0.0f));
+	output.uv = input.uv;
+	return output;
+}
 #if USE_TEXTURE_0
 Texture2D g_texture0 : register(t0);
 SamplerState g_sampler0 : register(s0);
@@ -6117,6 +8802,8 @@ namespace Play3d
 }
 
 
+#endif // PLAY_HEADLESS
+
 //-----------------------------------------------------------
 // Play3dImpl\SpriteApi.cpp
 
@@ -6149,6 +8836,7 @@ namespace Play3d
 {
 	namespace System
 	{
+#ifndef PLAY_HEADLESS
 		struct SystemImpl
 		{
 			SystemImpl()
@@ -6190,6 +8878,29 @@ namespace Play3d
 			f64 m_fElapsedTime;
 			f32 m_fDeltaTime;
 		};
+#else
+		// Headless frames take no real time: every frame advances the clock by a fixed step so runs are deterministic
+		// and go as fast as the CPU allows.
+		struct SystemImpl
+		{
+			static constexpr f32 kFrameTime = 1.0f / 60.0f;
+
+			void BeginFrame()
+			{
+				m_fDeltaTime = kFrameTime;
+				m_fElapsedTime += (f64)m_fDeltaTime;
+			}
+
+			void EndFrame()
+			{
+			}
+
+			static SystemImpl* ms_pInstance;
+
+			f64 m_fElapsedTime = 0.0;
+			f32 m_fDeltaTime = 0.f;
+		};
+#endif
 		SystemImpl* SystemImpl::ms_pInstance = nullptr;
 
 		bool IsInitialised()
@@ -6206,6 +8917,8 @@ namespace Play3d
 				Graphics::Graphics_Impl::Initialise();
 				Input::Input_Impl::Initialise();
 				Audio::Audio_Impl::Initialise();
+				Jobs::Initialise();
+				Resources::AssetLoader_Impl::Initialise();
 
 				Graphics::Graphics_Impl::Instance().PostInitialise();
 			}
@@ -6256,6 +8969,10 @@ namespace Play3d
 				Resources::ResourceManager<Graphics::Mesh>::Instance().ReleaseAll();
 				Resources::ResourceManager<UI::Font>::Instance().ReleaseAll();
 
+				// Finishes the queued decodes, so no task is released while a loader thread is using it
+				Resources::AssetLoader_Impl::Destroy();
+				Resources::ResourceManager<Resources::AsyncLoadingTask>::Instance().ReleaseAll();
+				Jobs::Shutdown();
 				Audio::Audio_Impl::Destroy();
 				Input::Input_Impl::Destroy();
 				Graphics::Graphics_Impl::Destroy();
@@ -6277,6 +8994,7 @@ namespace Play3d
 			return SystemImpl::ms_pInstance->m_fDeltaTime;
 		}
 
+#ifndef PLAY_HEADLESS
 		void* LoadFileData(const char* filePath, size_t& sizeOut)
 		{
 			sizeOut = 0;
@@ -6319,20 +9037,295 @@ namespace Play3d
 				_aligned_free(pMemory);
 			}
 		}
-	}
-}
 
-#ifndef PLAY_USE_CLIENT_MAIN
-extern int PlayMain();
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR pCmdLine, int nCmdShow)
+		result_t LoadFileData(const char* filePath, std::vector<u8>& dataOut)
+		{
+			dataOut.clear();
+			result_t result = RESULT_FAIL;
+
+			HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (hFile != INVALID_HANDLE_VALUE)
+			{
+				LARGE_INTEGER size;
+				if (GetFileSizeEx(hFile, &size))
+				{
+					dataOut.resize(size.LowPart);
+					DWORD bytesRead = 0;
+					if (ReadFile(hFile, dataOut.data(), size.LowPart, &bytesRead, NULL) && bytesRead == size.LowPart)
+					{
+						result = RESULT_OK;
+					}
+					else
+					{
+						dataOut.clear();
+					}
+				}
+				CloseHandle(hFile);
+			}
+			return result;
+		}
+
+		result_t SaveFileData(const char* filePath, const void* pData, size_t size)
+		{
+			std::string tempPath = std::string(filePath) + ".tmp";
+			HANDLE hFile = CreateFileA(tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (hFile == INVALID_HANDLE_VALUE)
+			{
+				return RESULT_FAIL;
+			}
+
+			DWORD bytesWritten = 0;
+			bool bOk = WriteFile(hFile, pData, (DWORD)size, &bytesWritten, NULL) && bytesWritten == size;
+			CloseHandle(hFile);
+
+			if (!bOk || !MoveFileExA(tempPath.c_str(), filePath, MOVEFILE_REPLACE_EXISTING))
+			{
+				DeleteFileA(tempPath.c_str());
+				return RESULT_FAIL;
+			}
+			return RESULT_OK;
+		}
+
+		const void* MapFile(const char* filePath, size_t& sizeOut)
+		{
+			sizeOut = 0;
+			const void* pMemoryRet = nullptr;
+
+			HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (hFile != INVALID_HANDLE_VALUE)
+			{
+				LARGE_INTEGER size;
+				if (GetFileSizeEx(hFile, &size) && size.QuadPart > 0)
+				{
+					// The view keeps the mapping alive once both handles are closed
+					HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+					if (hMapping)
+					{
+						pMemoryRet = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+						if (pMemoryRet)
+						{
+							sizeOut = (size_t)size.QuadPart;
+						}
+						CloseHandle(hMapping);
+					}
+				}
+				CloseHandle(hFile);
+			}
+			return pMemoryRet;
+		}
+
+		void UnmapFile(const void* pMemory, size_t size)
+		{
+			if (pMemory)
+			{
+				UnmapViewOfFile(pMemory);
+			}
+		}
+
+		result_t MakeDirectory(const char* path)
+		{
+			if (CreateDirectoryA(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS)
+			{
+				return RESULT_OK;
+			}
+			return RESULT_FAIL;
+		}
+
+		bool GetFileStamp(const char* filePath, u64& sizeOut, u64& writeTimeOut)
+		{
+			WIN32_FILE_ATTRIBUTE_DATA data;
+			if (!GetFileAttributesExA(filePath, GetFileExInfoStandard, &data))
+			{
+				return false;
+			}
+			sizeOut = ((u64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+			writeTimeOut = ((u64)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+			return true;
+		}
+#else
+		void* LoadFileData(const char* filePath, size_t& sizeOut)
+		{
+			sizeOut = 0;
+			void* pMemoryRet = nullptr;
+
+			// Client paths use Windows separators
+			std::string path(filePath);
+			std::replace(path.begin(), path.end(), '\\', '/');
+
+			FILE* pFile = fopen(path.c_str(), "rb");
+			if (pFile)
+			{
+				fseek(pFile, 0, SEEK_END);
+				long size = ftell(pFile);
+				fseek(pFile, 0, SEEK_SET);
+				if (size >= 0)
+				{
+					constexpr u32 kPadding = 16;
+					size_t allocSize = (((size_t)size + kPadding) + 15) & ~(size_t)15;
+					u8* pBuffer = (u8*)aligned_alloc(16, allocSize);
+					PLAY_ASSERT(pBuffer);
+
+					pBuffer[0] = '\0';
+					memset(pBuffer + size, 0, allocSize - (size_t)size);
+
+					if (fread(pBuffer, 1, (size_t)size, pFile) == (size_t)size)
+					{
+						sizeOut = (size_t)size;
+						pMemoryRet = pBuffer;
+					}
+					else
+					{
+						ReleaseFileData(pBuffer);
+					}
+				}
+				fclose(pFile);
+			}
+			return pMemoryRet;
+		}
+
+		void ReleaseFileData(void* pMemory)
+		{
+			free(pMemory);
+		}
+
+		result_t LoadFileData(const char* filePath, std::vector<u8>& dataOut)
+		{
+			dataOut.clear();
+			result_t result = RESULT_FAIL;
+
+			std::string path(filePath);
+			std::replace(path.begin(), path.end(), '\\', '/');
+
+			FILE* pFile = fopen(path.c_str(), "rb");
+			if (pFile)
+			{
+				fseek(pFile, 0, SEEK_END);
+				long size = ftell(pFile);
+				fseek(pFile, 0, SEEK_SET);
+				if (size >= 0)
+				{
+					dataOut.resize((size_t)size);
+					if (fread(dataOut.data(), 1, (size_t)size, pFile) == (size_t)size)
+					{
+						result = RESULT_OK;
+					}
+					else
+					{
+						dataOut.clear();
+					}
+				}
+				fclose(pFile);
+			}
+			return result;
+		}
+
+		result_t SaveFileData(const char* filePath, const void* pData, size_t size)
+		{
+			std::string path(filePath);
+			std::replace(path.begin(), path.end(), '\\', '/');
+			std::string tempPath = path + ".tmp";
+
+			FILE* pFile = fopen(tempPath.c_str(), "wb");
+			if (!pFile)
+			{
+				return RESULT_FAIL;
+			}
+			bool bOk = fwrite(pData, 1, size, pFile) == size;
+			bOk = (fclose(pFile) == 0) && bOk;
+
+			if (!bOk || rename(tempPath.c_str(), path.c_str()) != 0)
+			{
+				remove(tempPath.c_str());
+				return RESULT_FAIL;
+			}
+			return RESULT_OK;
+		}
+
+		const void* MapFile(const char* filePath, size_t& sizeOut)
+		{
+			sizeOut = 0;
+			void* pMemoryRet = nullptr;
+
+			std::string path(filePath);
+			std::replace(path.begin(), path.end(), '\\', '/');
+
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd >= 0)
+			{
+				struct stat info;
+				if (fstat(fd, &info) == 0 && info.st_size > 0)
+				{
+					pMemoryRet = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (pMemoryRet == MAP_FAILED)
+					{
+						pMemoryRet = nullptr;
+					}
+					else
+					{
+						sizeOut = (size_t)info.st_size;
+					}
+				}
+				close(fd);
+			}
+			return pMemoryRet;
+		}
+
+		void UnmapFile(const void* pMemory, size_t size)
+		{
+			if (pMemory)
+			{
+				munmap(const_cast<void*>(pMemory), size);
+			}
+		}
+
+		result_t MakeDirectory(const char* path)
+		{
+			std::string dirPath(path);
+			std::replace(dirPath.begin(), dirPath.end(), '\\', '/');
+			if (mkdir(dirPath.c_str(), 0755) == 0 || errno == EEXIST)
+			{
+				return RESULT_OK;
+			}
+			return RESULT_FAIL;
+		}
+
+		bool GetFileStamp(const char* filePath, u64& sizeOut, u64& writeTimeOut)
+		{
+			std::string path(filePath);
+			std::replace(path.begin(), path.end(), '\\', '/');
+
+			struct stat info;
+			if (stat(path.c_str(), &info) != 0)
+			{
+				return false;
+			}
+			sizeOut = (u64)info.st_size;
+			writeTimeOut = (u64)info.st_mtim.tv_sec * 1000000000ull + (u64)info.st_mtim.tv_nsec;
+			return true;
+		}
+#endif
+	}
+}
+
+#ifndef PLAY_USE_CLIENT_MAIN
+extern int PlayMain();
+#ifndef PLAY_HEADLESS
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR pCmdLine, int nCmdShow)
 {
 	return PlayMain();
 }
+#else
+int main()
+{
+	return PlayMain();
+}
+#endif
 #endif
 
 
 //-----------------------------------------------------------
 // Play3dImpl\Texture.cpp
+#ifndef PLAY_HEADLESS
 
 
 
@@ -6417,6 +9410,8 @@ namespace Play3d
 
 
 
+#endif // PLAY_HEADLESS
+
 //-----------------------------------------------------------
 // Play3dImpl\TypesApi.cpp
 
@@ -6485,5 +9480,401 @@ namespace Play3d
 
 	}
 }
+
+//-----------------------------------------------------------
+// Play3dImpl\Headless_Impl.cpp
+#ifdef PLAY_HEADLESS
+
+namespace Play3d
+{
+	namespace Audio
+	{
+		PLAY_SINGLETON_IMPL(Audio_Impl);
+
+		Sound::Sound(const SoundDesc& rDesc)
+			: m_format{}
+			, m_buffer{}
+			, m_pData(nullptr)
+			, m_sizeBytes(0)
+		{
+		}
+
+		Sound::~Sound()
+		{
+		}
+	}
+
+	namespace Input
+	{
+		PLAY_SINGLETON_IMPL(Input_Impl);
+
+		Input_Impl::Input_Impl()
+			: m_mouseState{}
+		{
+			memset(m_scriptKeyState, 0, sizeof(m_scriptKeyState));
+			memset(m_keyState, 0, sizeof(m_keyState));
+			memset(m_prevKeyState, 0, sizeof(m_prevKeyState));
+		}
+
+		void Input_Impl::BeginFrame()
+		{
+			memcpy(m_prevKeyState, m_keyState, sizeof(m_keyState));
+			memcpy(m_keyState, m_scriptKeyState, sizeof(m_keyState));
+		}
+
+		bool Input_Impl::IsKeyDown(u32 keycode)
+		{
+			return keycode < kKeyCount && m_keyState[keycode];
+		}
+
+		bool Input_Impl::IsKeyUp(u32 keycode)
+		{
+			return !IsKeyDown(keycode);
+		}
+
+		bool Input_Impl::IsKeyPressed(u32 keycode)
+		{
+			return keycode < kKeyCount && m_keyState[keycode] && !m_prevKeyState[keycode];
+		}
+
+		void Input_Impl::SetKeyState(u32 keycode, bool bDown)
+		{
+			PLAY_ASSERT(keycode < kKeyCount);
+			m_scriptKeyState[keycode] = bDown;
+		}
+
+		void SetKeyState(u32 keycode, bool bDown)
+		{
+			Input_Impl::Instance().SetKeyState(keycode, bDown);
+		}
+	}
+
+	namespace Graphics
+	{
+		Graphics_Impl* Graphics_Impl::ms_pInstance = nullptr;
+
+		void Graphics_Impl::Initialise()
+		{
+			if (!ms_pInstance)
+			{
+				ms_pInstance = new Graphics_Impl;
+			}
+		}
+
+		void Graphics_Impl::Destroy()
+		{
+			delete ms_pInstance;
+			ms_pInstance = nullptr;
+		}
+
+		Graphics_Impl::Graphics_Impl()
+			: m_validMeshBindings(0)
+			, m_nNextPrimitiveBatch(0)
+			, m_pFlushedPrimitiveBatch(nullptr)
+			, m_stats{}
+		{
+		}
+
+		Graphics_Impl::~Graphics_Impl()
+		{
+			for (auto& it : m_primitiveBatchRing)
+			{
+				PLAY_SAFE_DELETE(it);
+			}
+		}
+
+		result_t Graphics_Impl::BeginFrame()
+		{
+			++m_stats.m_frameCount;
+			m_nNextPrimitiveBatch = 0;
+			m_validMeshBindings = 0;
+			return RESULT_OK;
+		}
+
+		PrimitiveBatch* Graphics_Impl::AllocatePrimitiveBatch()
+		{
+			PrimitiveBatch* pBatch = nullptr;
+			if (m_nNextPrimitiveBatch < m_primitiveBatchRing.size())
+			{
+				pBatch = m_primitiveBatchRing[m_nNextPrimitiveBatch];
+			}
+			else
+			{
+				pBatch = new PrimitiveBatch(nullptr, 0x10000);
+				m_primitiveBatchRing.push_back(pBatch);
+			}
+			++m_nNextPrimitiveBatch;
+			return pBatch;
+		}
+
+		void Graphics_Impl::DrawPrimitveBatch(PrimitiveBatch* pBatch)
+		{
+			PLAY_ASSERT(pBatch);
+			pBatch->Flush(nullptr);
+			m_pFlushedPrimitiveBatch = pBatch;
+
+			++m_stats.m_primitiveBatchCount;
+			m_stats.m_primitiveVertexCount += pBatch->GetFlushedVertexCount();
+			m_validMeshBindings &= ~MeshBinding::PRIMITIVE_BATCH;
+		}
+
+		// Records the bindings the D3D11 backend would make for this draw
+		void Graphics_Impl::DrawMesh(MeshId hMesh, const Mesh* pMesh)
+		{
+			PLAY_ASSERT(pMesh);
+			++m_stats.m_meshDrawCount;
+
+			MeshDrawState state(m_activeMaterial, hMesh);
+			u32 bindCount = MeshBinding::Count(state.GetChangedBindings(m_boundMeshState, m_validMeshBindings));
+			m_stats.m_meshBindCount += bindCount;
+			m_stats.m_redundantMeshBindCount += MeshBinding::kCount - bindCount;
+
+			m_boundMeshState = state;
+			m_validMeshBindings = MeshBinding::ALL;
+		}
+
+		// Packs the instance data as the D3D11 backend would, and records the bindings it would make
+		void Graphics_Impl::DrawMeshInstanced(MeshId hMesh, const Mesh* pMesh, const Matrix4x4f* pTransforms, u32 count)
+		{
+			PLAY_ASSERT(pMesh);
+			m_mockInstanceBuffer.resize(count);
+			PackInstanceData(pTransforms, count, m_mockInstanceBuffer.data());
+
+			++m_stats.m_meshDrawCount;
+			++m_stats.m_instancedDrawCount;
+			m_stats.m_instanceCount += count;
+
+			// Plus one for the instance buffer, which is bound on every instanced draw
+			MeshDrawState state(m_activeMaterial, hMesh, true);
+			u32 bindCount = MeshBinding::Count(state.GetChangedBindings(m_boundMeshState, m_validMeshBindings));
+			m_stats.m_meshBindCount += bindCount + 1;
+			m_stats.m_redundantMeshBindCount += MeshBinding::kCount - bindCount;
+
+			m_boundMeshState = state;
+			m_validMeshBindings = MeshBinding::ALL;
+		}
+
+		void Graphics_Impl::SetMaterial(MaterialId materialId)
+		{
+			if (materialId != m_activeMaterial)
+			{
+				++m_stats.m_materialChangeCount;
+				m_activeMaterial = materialId;
+			}
+		}
+
+		const HeadlessStats& GetHeadlessStats()
+		{
+			return Graphics_Impl::Instance().GetStats();
+		}
+
+		const std::vector<InstanceData>& GetHeadlessInstanceData()
+		{
+			return Graphics_Impl::Instance().GetInstanceData();
+		}
+
+		const PrimitiveVertex* Graphics_Impl::GetPrimitiveVertices(u32& countOut) const
+		{
+			countOut = m_pFlushedPrimitiveBatch ? m_pFlushedPrimitiveBatch->GetFlushedVertexCount() : 0;
+			return m_pFlushedPrimitiveBatch ? m_pFlushedPrimitiveBatch->GetMockVertexBuffer() : nullptr;
+		}
+
+		const PrimitiveVertex* GetHeadlessPrimitiveVertices(u32& countOut)
+		{
+			return Graphics_Impl::Instance().GetPrimitiveVertices(countOut);
+		}
+
+		TextureId CreateTextureFromFile(const char* pFilePath)
+		{
+			u32 width = 0;
+			u32 height = 0;
+			std::vector<u8> pixels;
+			if (RESULT_OK != DecodeImageFile(pFilePath, width, height, pixels))
+			{
+				return TextureId();
+			}
+			return Resources::CreateAsset<Texture>(TextureDesc());
+		}
+
+		// No image decoder here: the file is read, so loads cost their I/O, and the image is left empty
+		result_t DecodeImageFile(const char* pFilePath, u32& widthOut, u32& heightOut, std::vector<u8>& pixelsOut)
+		{
+			size_t sizeBytes = 0;
+			void* pData = System::LoadFileData(pFilePath, sizeBytes);
+			if (!pData)
+			{
+				return RESULT_FAIL;
+			}
+			System::ReleaseFileData(pData);
+			widthOut = 0;
+			heightOut = 0;
+			pixelsOut.clear();
+			return RESULT_OK;
+		}
+
+		Mesh::Mesh(const MeshDesc& rDesc)
+			: m_pIndexBuffer(nullptr)
+			, m_indexCount(rDesc.m_indexCount)
+			, m_vertexCount(rDesc.m_vertexCount)
+			, m_indexStride(sizeof(u32))
+		{
+			for (u32 i = 0; i < rDesc.m_streamCount; ++i)
+			{
+				AddStream(rDesc.m_pStreams[i]);
+			}
+		}
+
+		Mesh::~Mesh()
+		{
+		}
+
+		void Mesh::AddStream(const StreamInfo& info)
+		{
+			if (info.m_type == StreamType::INDEX || info.m_type == StreamType::INDEX16)
+			{
+				m_indexStride = info.m_type == StreamType::INDEX16 ? sizeof(u16) : sizeof(u32);
+			}
+			else
+			{
+				m_streamInfos.push_back(info);
+			}
+		}
+
+		void Mesh::Bind(ID3D11DeviceContext* pDC) const
+		{
+		}
+
+		Material::Material(const SimpleMaterialDesc& rDesc)
+		{
+			SetupTextureBindings(nullptr, rDesc.m_texture, rDesc.m_sampler);
+			m_bInstancing = true;
+		}
+
+		Material::Material(const ComplexMaterialDesc& rDesc)
+		{
+			m_VertexShader = rDesc.m_VertexShader;
+			m_PixelShader = rDesc.m_PixelShader;
+			m_InstancedVertexShader = rDesc.m_InstancedVertexShader;
+			m_bInstancing = m_InstancedVertexShader.IsValid();
+			SetupTextureBindings(nullptr, rDesc.m_texture, rDesc.m_sampler);
+		}
+
+		Material::~Material()
+		{
+		}
+
+		void Material::SetupTextureBindings(ID3D11Device* pDevice, const TextureId* pTextureId, const SamplerId* pSamplerId)
+		{
+			for (u32 i = 0; i < kMaxMaterialTextureSlots; ++i)
+			{
+				m_texture[i] = pTextureId[i];
+				m_sampler[i] = pSamplerId[i];
+			}
+		}
+
+		Texture::Texture(const TextureDesc& rDesc)
+		{
+		}
+
+		Sampler::Sampler(const SamplerDesc& rDesc)
+		{
+		}
+
+		Shader::Shader(const ShaderDesc& rDesc)
+			: m_shaderType(rDesc.m_type)
+			, m_pByteCode(nullptr)
+			, m_sizeBytes(0)
+		{
+		}
+
+		Shader::~Shader()
+		{
+		}
+
+		void Shader::Bind(ID3D11DeviceContext* pContext)
+		{
+		}
+
+		// Appends the source and, after it, every file its #include "file" lines name, as a compile would read them
+		static result_t AppendShaderSource(std::string_view source, const void* pSourceData, u32 depth, ShaderIncludeTracker& rTracker, std::vector<u8>& byteCodeOut)
+		{
+			static constexpr u32 kMaxIncludeDepth = 32;
+			static constexpr std::string_view kInclude = "#include \"";
+			if (depth > kMaxIncludeDepth)
+			{
+				return RESULT_FAIL;
+			}
+
+			byteCodeOut.insert(byteCodeOut.end(), source.begin(), source.end());
+			for (size_t pos = source.find(kInclude); pos != std::string_view::npos; pos = source.find(kInclude, pos + 1))
+			{
+				size_t nameStart = pos + kInclude.size();
+				size_t nameEnd = source.find('"', nameStart);
+				if (nameEnd == std::string_view::npos)
+				{
+					return RESULT_FAIL;
+				}
+
+				std::string fileName(source.substr(nameStart, nameEnd - nameStart));
+				const void* pData = nullptr;
+				size_t size = 0;
+				if (!rTracker.Open(fileName.c_str(), pSourceData, pData, size)
+					|| RESULT_OK != AppendShaderSource(std::string_view((const char*)pData, size), pData, depth + 1, rTracker, byteCodeOut))
+				{
+					return RESULT_FAIL;
+				}
+			}
+			return RESULT_OK;
+		}
+
+		// There is no HLSL compiler. The source and the files it includes stand in for the bytecode, so the shader cache
+		// still round trips real data and sees edits to included files.
+		result_t CompileHLSL(const ShaderCompilerDesc& rDesc, std::vector<u8>& byteCodeOut, std::vector<ShaderInclude>& includesOut)
+		{
+			ShaderIncludeTracker includeTracker(rDesc.m_sourcePath);
+			byteCodeOut.clear();
+			result_t result = AppendShaderSource(rDesc.m_hlslCode, nullptr, 0, includeTracker, byteCodeOut);
+			includesOut = includeTracker.GetIncludes();
+			return result;
+		}
+
+		ShaderId Shader::Compile(const ShaderCompilerDesc& rDesc)
+		{
+			std::vector<u8> byteCode;
+			if (RESULT_OK != CompileShaderByteCode(rDesc, byteCode))
+			{
+				return ShaderId();
+			}
+
+			ShaderDesc desc;
+			desc.m_pByteCode = byteCode.data();
+			desc.m_sizeBytes = byteCode.size();
+			desc.m_type = rDesc.m_type;
+			desc.m_name = rDesc.m_name;
+
+			return Resources::CreateAsset<Shader>(desc);
+		}
+	}
+
+	namespace UI
+	{
+		Font::Font(const FontDesc& rDesc)
+			: m_defaultAdvance(0)
+		{
+			memset(m_glyphMap, 0xff, 256);
+		}
+
+		Font::~Font()
+		{
+		}
+
+		void Font::DrawString(ID3D11DeviceContext* pDC, const Vector2f& position, ColourValue colour, std::string_view text)
+		{
+			Graphics::Graphics_Impl::Instance().RecordTextDraw();
+		}
+	}
+}
+
+#endif // PLAY_HEADLESS
 ////////////////// END IMPLEMENTATION SECTION ////////////////////////////
-#endif PLAY_IMPLEMENTATION
+#endif // PLAY_IMPLEMENTATION
@@ -0,0 +1,172 @@
+#include "Profiler.h"
+#include <cstdio>
+
+using namespace Play3d;
+
+static Profiler* s_pProfiler{nullptr};
+
+static const char* s_phaseNames[PROFILE_TOTAL] =
+{
+	"Frame",
+	"State Update",
+	"Sim Tick",
+	"Update Objects",
+	"Update Projectiles",
+	"Collide",
+	"Clean Up",
+	"Particles Wait",
+	"State Draw",
+	"Draw Objects",
+	"End Primitive Batch",
+	"Present",
+};
+
+Profiler* Profiler::Get()
+{
+	if (!s_pProfiler)
+	{
+		s_pProfiler = new Profiler();
+	}
+	return s_pProfiler;
+}
+
+void Profiler::Destroy()
+{
+	delete s_pProfiler;
+	s_pProfiler = nullptr;
+}
+
+const char* Profiler::GetPhaseName(ProfilePhase phase)
+{
+	PLAY_ASSERT(phase >= 0 && phase < PROFILE_TOTAL);
+	return s_phaseNames[phase];
+}
+
+Profiler::Profiler()
+	: m_epoch(Clock::now())
+	, m_frames(FRAME_HISTORY)
+{
+}
+
+void Profiler::BeginFrame()
+{
+	FrameRecord& frame = m_frames[m_frameIndex];
+	std::fill(frame.phaseNs, frame.phaseNs + PROFILE_TOTAL, 0);
+	frame.eventCount = 0;
+
+	m_inFrame = true;
+	m_frameStart = Clock::now();
+}
+
+void Profiler::EndFrame()
+{
+	if (!m_inFrame)
+		return;
+
+	Record(PROFILE_FRAME, m_frameStart, Clock::now());
+	m_inFrame = false;
+
+	m_frameIndex = (m_frameIndex + 1) % FRAME_HISTORY;
+	m_framesRecorded = std::min(m_framesRecorded + 1, FRAME_HISTORY);
+}
+
+void Profiler::Record(ProfilePhase phase, Clock::time_point start, Clock::time_point end)
+{
+	// Scopes outside BeginFrame/EndFrame (e.g. loading) aren't part of any frame
+	if (!m_inFrame)
+		return;
+
+	FrameRecord& frame = m_frames[m_frameIndex];
+	s64 startNs = ToNs(start);
+	s64 durationNs = ToNs(end) - startNs;
+	frame.phaseNs[phase] += durationNs;
+
+	if (frame.eventCount < MAX_EVENTS_PER_FRAME)
+	{
+		frame.events[frame.eventCount++] = { phase, startNs, durationNs };
+	}
+}
+
+Profiler::PhaseStats Profiler::GetPhaseStats(ProfilePhase phase) const
+{
+	PLAY_ASSERT(m_framesRecorded > 0);
+
+	// The slot at m_frameIndex is the frame in progress, the ones before it are complete
+	s64 total = 0;
+	m_samples.resize(m_framesRecorded);
+	for (int i = 0; i < m_framesRecorded; i++)
+	{
+		int slot = (m_frameIndex - 1 - i + FRAME_HISTORY) % FRAME_HISTORY;
+		m_samples[i] = m_frames[slot].phaseNs[phase];
+		total += m_samples[i];
+	}
+
+	size_t p99 = ((size_t)m_framesRecorded * 99) / 100;
+	std::nth_element(m_samples.begin(), m_samples.begin() + p99, m_samples.end());
+	s64 minNs = *std::min_element(m_samples.begin(), m_samples.begin() + p99 + 1);
+
+	PhaseStats stats;
+	stats.minMs = (float)(minNs * 1e-6);
+	stats.avgMs = (float)((total / m_framesRecorded) * 1e-6);
+	stats.p99Ms = (float)(m_samples[p99] * 1e-6);
+	return stats;
+}
+
+void Profiler::DrawOverlay(Vector2f position) const
+{
+	UI::FontId font = UI::GetDebugFont();
+	UI::DrawPrintf(font, position, Colour::Lightblue, "[profile: last %d frames, ms]", m_framesRecorded);
+	if (m_framesRecorded == 0)
+		return;
+
+	for (int phase = 0; phase < PROFILE_TOTAL; phase++)
+	{
+		PhaseStats stats = GetPhaseStats((ProfilePhase)phase);
+		position.y += 25.f;
+		UI::DrawPrintf(font, position, Colour::Lightblue, "%s: min %.3f avg %.3f p99 %.3f", GetPhaseName((ProfilePhase)phase),
+			stats.minMs, stats.avgMs, stats.p99Ms);
+	}
+}
+
+void Profiler::PrintSummary() const
+{
+	Debug::Printf("Profile of the last %d frames (ms):\n", m_framesRecorded);
+	if (m_framesRecorded == 0)
+		return;
+
+	for (int phase = 0; phase < PROFILE_TOTAL; phase++)
+	{
+		PhaseStats stats = GetPhaseStats((ProfilePhase)phase);
+		Debug::Printf("  %-20s min %8.4f  avg %8.4f  p99 %8.4f\n", GetPhaseName((ProfilePhase)phase), stats.minMs, stats.avgMs, stats.p99Ms);
+	}
+}
+
+bool Profiler::WriteChromeTrace(const char* filePath) const
+{
+	FILE* pFile = nullptr;
+	if (fopen_s(&pFile, filePath, "w") != 0)
+	{
+		Debug::Printf("Profiler: could not open %s for writing\n", filePath);
+		return false;
+	}
+
+	// Trace event format, "X" (complete) events with microsecond timestamps
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", pFile);
+	bool bFirst = true;
+	for (int i = m_framesRecorded; i > 0; i--)
+	{
+		const FrameRecord& frame = m_frames[(m_frameIndex - i + FRAME_HISTORY) % FRAME_HISTORY];
+		for (int e = 0; e < frame.eventCount; e++)
+		{
+			const Event& event = frame.events[e];
+			fprintf(pFile, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}", bFirst ? "" : ",\n",
+				GetPhaseName(event.phase), event.startNs * 1e-3, event.durationNs * 1e-3);
+			bFirst = false;
+		}
+	}
+	fputs("\n]}\n", pFile);
+	fclose(pFile);
+
+	Debug::Printf("Profiler: wrote %d frames to %s\n", m_framesRecorded, filePath);
+	return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "Play3d.h"
+#include <chrono>
+
+// Phases of the main loop which are timed. Phases nest (e.g. PROFILE_COLLIDE runs inside PROFILE_SIM_TICK) and can run
+// several times a frame, in which case the frame records their total.
+enum ProfilePhase
+{
+	PROFILE_FRAME,
+	PROFILE_STATE_UPDATE,
+	PROFILE_SIM_TICK,
+	PROFILE_UPDATE_OBJECTS,
+	PROFILE_UPDATE_PROJECTILES,
+	PROFILE_COLLIDE,
+	PROFILE_CLEANUP,
+	PROFILE_PARTICLES, // main thread waiting on the emitter jobs
+	PROFILE_STATE_DRAW,
+	PROFILE_DRAW_OBJECTS,
+	PROFILE_END_PRIMITIVE_BATCH,
+	PROFILE_PRESENT,
+
+	PROFILE_TOTAL
+};
+
+// Instrumentation macros; define PROFILER_DISABLED to compile them out entirely
+#ifndef PROFILER_DISABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(phase)
+#define PROFILE_BEGIN_FRAME() Profiler::Get()->BeginFrame()
+#define PROFILE_END_FRAME() Profiler::Get()->EndFrame()
+#else
+#define PROFILE_SCOPE(phase)
+#define PROFILE_BEGIN_FRAME()
+#define PROFILE_END_FRAME()
+#endif
+
+// Keeps per-phase timings for the last FRAME_HISTORY frames in a ring buffer, along with the individual timed
+// scopes so they can be written out as a Chrome trace (load in chrome://tracing or ui.perfetto.dev).
+class Profiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static Profiler* Get();
+	static void Destroy();
+
+	void BeginFrame();
+	void EndFrame();
+	void Record(ProfilePhase phase, Clock::time_point start, Clock::time_point end);
+
+	// Min, average and 99th percentile of each phase's per-frame time over the recorded history
+	void DrawOverlay(Play3d::Vector2f position) const;
+	void PrintSummary() const;
+	bool WriteChromeTrace(const char* filePath) const;
+
+	static const char* GetPhaseName(ProfilePhase phase);
+
+private:
+	Profiler();
+
+	static constexpr int FRAME_HISTORY{ 240 };
+	static constexpr int MAX_EVENTS_PER_FRAME{ 128 }; // further scopes still count towards the totals
+
+	struct Event
+	{
+		ProfilePhase phase;
+		Play3d::s64 startNs; // relative to m_epoch
+		Play3d::s64 durationNs;
+	};
+
+	struct FrameRecord
+	{
+		Play3d::s64 phaseNs[PROFILE_TOTAL];
+		Event events[MAX_EVENTS_PER_FRAME];
+		int eventCount;
+	};
+
+	struct PhaseStats
+	{
+		float minMs;
+		float avgMs;
+		float p99Ms;
+	};
+
+	PhaseStats GetPhaseStats(ProfilePhase phase) const;
+	Play3d::s64 ToNs(Clock::time_point t) const { return std::chrono::duration_cast<std::chrono::nanoseconds>(t - m_epoch).count(); }
+
+	Clock::time_point m_epoch;
+	Clock::time_point m_frameStart;
+	std::vector<FrameRecord> m_frames;
+	mutable std::vector<Play3d::s64> m_samples; // scratch for the percentile
+	int m_frameIndex{ 0 };	// slot being recorded
+	int m_framesRecorded{ 0 }; // completed frames, up to FRAME_HISTORY
+	bool m_inFrame{ false };
+};
+
+class ProfileScope
+{
+public:
+	explicit ProfileScope(ProfilePhase phase) : m_phase(phase), m_start(Profiler::Clock::now()) {}
+	~ProfileScope() { Profiler::Get()->Record(m_phase, m_start, Profiler::Clock::now()); }
+
+private:
+	ProfilePhase m_phase;
+	Profiler::Clock::time_point m_start;
+};
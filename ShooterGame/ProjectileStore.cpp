@@ -0,0 +1,191 @@
+#include "ProjectileStore.h"
+#include "ObjectManager.h"
+#include "CollisionKernels.h"
+using namespace Play3d;
+
+// Initial bank sizes, sized for the densest attack patterns; banks grow beyond this if needed
+static constexpr size_t RESERVE_PLAYER_PROJECTILES{128};
+static constexpr size_t RESERVE_BOSS_PROJECTILES{2048};
+
+static constexpr AssetPath PLAYER_MESH_PATH{ "..\\Assets\\Models\\pellet.obj" };
+static constexpr AssetPath PLAYER_SHADER_PATH{ "..\\Assets\\Shaders\\PlayerPellet.hlsl" };
+static constexpr AssetPath BOSS_MESH_PATH{ "..\\Assets\\Models\\pelletEnemy.obj" };
+static constexpr AssetPath BOSS_SHADER_PATH{ "..\\Assets\\Shaders\\BossPellet.hlsl" };
+
+ProjectileStore::ProjectileStore()
+{
+	Bank& player = m_banks[OWNER_PLAYER];
+	player.type = TYPE_PLAYER_PELLET;
+	player.targetLayer = LAYER_ENEMY;
+	player.radius = 0.1f;
+	player.scale = 1.f;
+	player.meshPath = PLAYER_MESH_PATH;
+	player.shaderPath = PLAYER_SHADER_PATH;
+
+	Bank& boss = m_banks[OWNER_BOSS];
+	boss.type = TYPE_BOSS_PELLET;
+	boss.targetLayer = LAYER_PLAYER;
+	boss.radius = 0.15f;
+	boss.scale = 1.2f;
+	boss.meshPath = BOSS_MESH_PATH;
+	boss.shaderPath = BOSS_SHADER_PATH;
+
+	Reserve(player, RESERVE_PLAYER_PROJECTILES);
+	Reserve(boss, RESERVE_BOSS_PROJECTILES);
+}
+
+void ProjectileStore::Reserve(Bank& bank, size_t capacity)
+{
+	bank.posX.reserve(capacity);
+	bank.posY.reserve(capacity);
+	bank.velX.reserve(capacity);
+	bank.velY.reserve(capacity);
+}
+
+void ProjectileStore::Spawn(ProjectileOwner owner, Vector2f position, Vector2f velocity)
+{
+	Bank& bank = m_banks[owner];
+
+	// Assets are loaded on first use (the manager also exists in the menu, where no shaders should be compiled)
+	if (!bank.meshId.IsValid())
+	{
+		bank.meshId = GetObjectManager()->GetMesh(bank.meshPath);
+		bank.materialId = GetObjectManager()->GetMaterialHLSL(bank.shaderPath);
+	}
+
+	bank.posX.push_back(position.x);
+	bank.posY.push_back(position.y);
+	bank.velX.push_back(velocity.x);
+	bank.velY.push_back(velocity.y);
+}
+
+void ProjectileStore::DestroyAll(ProjectileOwner owner)
+{
+	Bank& bank = m_banks[owner];
+	bank.posX.clear();
+	bank.posY.clear();
+	bank.velX.clear();
+	bank.velY.clear();
+}
+
+void ProjectileStore::Remove(Bank& bank, size_t index)
+{
+	bank.posX[index] = bank.posX.back();
+	bank.posY[index] = bank.posY.back();
+	bank.velX[index] = bank.velX.back();
+	bank.velY[index] = bank.velY.back();
+	bank.posX.pop_back();
+	bank.posY.pop_back();
+	bank.velX.pop_back();
+	bank.velY.pop_back();
+}
+
+void ProjectileStore::UpdateAll()
+{
+	const float halfWidth = GetGameHalfWidth();
+	const float halfHeight = GetGameHalfHeight();
+
+	for (Bank& bank : m_banks)
+	{
+		size_t count = bank.posX.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			bank.posX[i] += bank.velX[i];
+			bank.posY[i] += bank.velY[i];
+		}
+
+		// Same bounds as GameObject::IsOutsideOrthoView(); walk backwards so swap-and-pop only moves tested entries
+		for (size_t i = count; i > 0; i--)
+		{
+			float x = bank.posX[i - 1];
+			float y = bank.posY[i - 1];
+			if (x < -halfWidth || x > halfWidth || y < -halfHeight || y > halfHeight)
+			{
+				Remove(bank, i - 1);
+			}
+		}
+	}
+}
+
+void ProjectileStore::Collide(ProjectileOwner owner, GameObject* pTarget, CollisionStats& stats)
+{
+	Bank& bank = m_banks[owner];
+	const float projectileRadius = bank.radius * bank.scale;
+	const Vector3f targetPos = pTarget->GetPosition();
+
+	// Each target collider is tested against the whole bank in one batch, then hits are resolved highest index first
+	// so swap-and-pop only ever moves entries which have already been resolved as misses
+	for (const CollisionData& coll : pTarget->GetColliders())
+	{
+		if (!pTarget->CanCollide() || bank.posX.empty())
+			return;
+
+		size_t count = bank.posX.size();
+		m_hitMask.resize(CollisionKernels::GetHitMaskWords(count));
+		if (coll.type == CollisionMode::COLL_RADIAL)
+		{
+			CollisionKernels::CircleVsCircles(targetPos.x + coll.offset.x, targetPos.y + coll.offset.y, coll.radius * pTarget->GetScale(),
+				bank.posX.data(), bank.posY.data(), projectileRadius, count, m_hitMask.data());
+		}
+		else if (coll.type == CollisionMode::COLL_RECT)
+		{
+			CollisionKernels::RectVsCircles(targetPos.x + coll.offset.x, targetPos.y + coll.offset.y, targetPos.z, coll.extents.x, coll.extents.y,
+				bank.posX.data(), bank.posY.data(), projectileRadius, count, m_hitMask.data());
+		}
+		stats.pairsTested += (int)count;
+
+		for (size_t word = m_hitMask.size(); word > 0; word--)
+		{
+			u64 bits = m_hitMask[word - 1];
+			for (int bit = 63; bits != 0; bit--)
+			{
+				if ((bits & (1ull << bit)) == 0)
+					continue;
+				bits &= ~(1ull << bit);
+
+				stats.pairsColliding++;
+				Remove(bank, ((word - 1) * 64) + bit);
+				pTarget->OnProjectileHit(bank.type);
+
+				// e.g. the player dying stops any further hits this frame
+				if (!pTarget->CanCollide())
+					return;
+			}
+		}
+	}
+}
+
+void ProjectileStore::DrawAll() const
+{
+	for (const Bank& bank : m_banks)
+	{
+		if (bank.posX.empty())
+			continue;
+
+		// Projectiles move by exactly their velocity each tick, so the previous position doesn't need storing
+		const float rewind = 1.f - GetSimInterpolation();
+
+		Graphics::SetMaterial(bank.materialId);
+		for (size_t i = 0; i < bank.posX.size(); i++)
+		{
+			float x = bank.posX[i] - (bank.velX[i] * rewind);
+			float y = bank.posY[i] - (bank.velY[i] * rewind);
+			Graphics::DrawMesh(bank.meshId, MatrixTranslate<f32>(x, y, 0.f) * MatrixScale<f32>(bank.scale, bank.scale, bank.scale));
+		}
+	}
+}
+
+void ProjectileStore::DrawCollisionAll() const
+{
+	static Graphics::MeshId collMesh = Graphics::CreateSphere(1.f, 6, 6, Colour::Blue);
+	static Graphics::MaterialId collMat = GetObjectManager()->GetMaterial();
+
+	Graphics::SetMaterial(collMat);
+	for (const Bank& bank : m_banks)
+	{
+		for (size_t i = 0; i < bank.posX.size(); i++)
+		{
+			Graphics::DrawMesh(collMesh, MatrixTranslate<f32>(bank.posX[i], bank.posY[i], 0.f) * MatrixScale<f32>(bank.radius, bank.radius, bank.radius));
+		}
+	}
+}
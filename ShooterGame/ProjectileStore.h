@@ -0,0 +1,61 @@
+#pragma once
+#include "GameObject.h"
+#include "AssetKey.h"
+
+struct CollisionStats;
+
+enum ProjectileOwner
+{
+	OWNER_PLAYER,
+	OWNER_BOSS,
+
+	OWNER_TOTAL
+};
+
+// Pellets only ever fly in a straight line and die off-screen or on their first hit, so rather than full GameObjects
+// they live here as structure-of-arrays banks (one per owner) which are integrated, culled and collided in tight loops.
+// Removal is swap-and-pop, so order within a bank is not preserved.
+class ProjectileStore
+{
+public:
+	ProjectileStore();
+
+	void Spawn(ProjectileOwner owner, Play3d::Vector2f position, Play3d::Vector2f velocity);
+	void DestroyAll(ProjectileOwner owner);
+
+	// Moves every projectile by its velocity then removes any which have left the orthographic play area
+	void UpdateAll();
+	// Tests one owner's bank against a target object, calling OnProjectileHit() and removing the projectile on each hit
+	void Collide(ProjectileOwner owner, GameObject* pTarget, CollisionStats& stats);
+	void DrawAll() const;
+	void DrawCollisionAll() const;
+
+	size_t GetCount(ProjectileOwner owner) const { return m_banks[owner].posX.size(); }
+	// The collision layer each owner's projectiles hit
+	CollisionLayer GetTargetLayer(ProjectileOwner owner) const { return m_banks[owner].targetLayer; }
+
+private:
+	struct Bank
+	{
+		std::vector<float> posX;
+		std::vector<float> posY;
+		std::vector<float> velX;
+		std::vector<float> velY;
+
+		// Shared by every projectile in the bank
+		GameObjectType type{TYPE_NULL};
+		CollisionLayer targetLayer{LAYER_NONE};
+		float radius{0.f};
+		float scale{1.f};
+		AssetPath meshPath{""};
+		AssetPath shaderPath{""};
+		Play3d::Graphics::MeshId meshId{};
+		Play3d::Graphics::MaterialId materialId{};
+	};
+
+	void Reserve(Bank& bank, size_t capacity);
+	void Remove(Bank& bank, size_t index);
+
+	Bank m_banks[OWNER_TOTAL];
+	std::vector<Play3d::u64> m_hitMask; // scratch for the batched narrowphase
+};
@@ -0,0 +1,94 @@
+#include "Random.h"
+#include <immintrin.h>
+
+using namespace Play3d;
+
+static inline u32 RotateLeft(u32 x, int k)
+{
+	return (x << k) | (x >> (32 - k));
+}
+
+// splitmix64, to spread a small seed over all the state words; it never produces an all-zero state
+static u64 NextSeedWord(u64& rSeed)
+{
+	u64 z = (rSeed += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+void Random::Seed(u32 seed)
+{
+	u64 seedWord = seed;
+	for (u32& word : m_state)
+	{
+		word = (u32)NextSeedWord(seedWord);
+	}
+	for (int lane = 0; lane < LANES; lane++)
+	{
+		for (int word = 0; word < 4; word++)
+		{
+			m_laneState[word][lane] = (u32)NextSeedWord(seedWord);
+		}
+	}
+}
+
+u32 Random::NextU32()
+{
+	u32* s = m_state;
+	const u32 result = s[0] + s[3];
+	const u32 t = s[1] << 9;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = RotateLeft(s[3], 11);
+
+	return result;
+}
+
+void Random::FillInRange(float* pOut, size_t count, float min, float max)
+{
+	__m128i s0 = _mm_loadu_si128((const __m128i*)m_laneState[0]);
+	__m128i s1 = _mm_loadu_si128((const __m128i*)m_laneState[1]);
+	__m128i s2 = _mm_loadu_si128((const __m128i*)m_laneState[2]);
+	__m128i s3 = _mm_loadu_si128((const __m128i*)m_laneState[3]);
+
+	// Same float maths as NextInRange(): the top 24 bits scaled to [0, 1), then a multiply and an add
+	const __m128 scale = _mm_set1_ps(1.f / 16777216.f);
+	const __m128 base = _mm_set1_ps(min);
+	const __m128 range = _mm_set1_ps(max - min);
+
+	for (size_t i = 0; i < count; i += LANES)
+	{
+		__m128i result = _mm_add_epi32(s0, s3);
+		__m128i t = _mm_slli_epi32(s1, 9);
+		s2 = _mm_xor_si128(s2, s0);
+		s3 = _mm_xor_si128(s3, s1);
+		s1 = _mm_xor_si128(s1, s2);
+		s0 = _mm_xor_si128(s0, s3);
+		s2 = _mm_xor_si128(s2, t);
+		s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+		__m128 unit = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(result, 8)), scale);
+		__m128 values = _mm_add_ps(base, _mm_mul_ps(range, unit));
+		if (i + LANES <= count)
+		{
+			_mm_storeu_ps(pOut + i, values);
+		}
+		else
+		{
+			// The unused lanes of the last block are dropped
+			alignas(16) float tail[LANES];
+			_mm_store_ps(tail, values);
+			std::copy(tail, tail + (count - i), pOut + i);
+		}
+	}
+
+	_mm_storeu_si128((__m128i*)m_laneState[0], s0);
+	_mm_storeu_si128((__m128i*)m_laneState[1], s1);
+	_mm_storeu_si128((__m128i*)m_laneState[2], s2);
+	_mm_storeu_si128((__m128i*)m_laneState[3], s3);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Play3d.h"
+
+// Seedable xoshiro128+ generator. Instances are independent, so each owner (an emitter, the simulation) gets a
+// repeatable sequence and can draw from it on any thread.
+//
+// FillInRange() draws from four further generators stepped side by side in SSE registers, so bulk fills are a
+// separate sequence from Next*(). Every platform produces the same values for the same seed.
+class Random
+{
+public:
+	explicit Random(Play3d::u32 seed = 1) { Seed(seed); }
+
+	void Seed(Play3d::u32 seed);
+
+	Play3d::u32 NextU32();
+	float NextFloat() { return (NextU32() >> 8) * (1.f / 16777216.f); } // [0, 1)
+	float NextInRange(float min, float max) { return min + ((max - min) * NextFloat()); }
+
+	// Writes count values in [min, max) to pOut
+	void FillInRange(float* pOut, size_t count, float min, float max);
+
+private:
+	static constexpr int LANES{ 4 };
+
+	Play3d::u32 m_state[4];
+	Play3d::u32 m_laneState[4][LANES]; // state word, then lane, to load straight into SSE registers
+};
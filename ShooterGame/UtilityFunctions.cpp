@@ -1,12 +1,29 @@
 #include "UtilityFunctions.h"
+#include "Random.h"
+#include <bitset>
 
 using namespace Play3d;
 using namespace Graphics;
 
+static constexpr u32 DEFAULT_SIM_SEED{ 0x51D5EED };
+static u32 s_simSeed{ DEFAULT_SIM_SEED };
+static Random s_simRandom{ DEFAULT_SIM_SEED };
+
 float RandValueInRange(const float min, const float max)
 {
 	PLAY_ASSERT(min <= max);
-	return min + ((max - min) * (static_cast<float>(rand()) / RAND_MAX));
+	return s_simRandom.NextInRange(min, max);
+}
+
+void SetSimSeed(u32 seed)
+{
+	s_simSeed = seed;
+	s_simRandom.Seed(seed);
+}
+
+u32 GetSimSeed()
+{
+	return s_simSeed;
 }
 
 static const float s_viewBoundsHalf{ 15.f / 2 };
@@ -20,4 +37,76 @@ float GetGameHalfWidth()
 float GetGameHalfHeight()
 {
 	return s_viewBoundsHalf;
+}
+
+static Play3d::u32 s_simTicks{ 0 };
+static float s_simInterpolation{ 1.f };
+
+float GetSimDeltaTime()
+{
+	return SIM_TIMESTEP;
+}
+
+float GetSimElapsedTime()
+{
+	// Derived from the tick count rather than accumulated, so it never drifts
+	return (float)((double)s_simTicks * SIM_TIMESTEP);
+}
+
+u32 GetSimTickCount()
+{
+	return s_simTicks;
+}
+
+float GetSimInterpolation()
+{
+	return s_simInterpolation;
+}
+
+void ResetSimClock()
+{
+	s_simTicks = 0;
+	s_simInterpolation = 1.f;
+	s_simRandom.Seed(s_simSeed);
+}
+
+void AdvanceSimClock()
+{
+	s_simTicks++;
+}
+
+void SetSimInterpolation(float alpha)
+{
+	s_simInterpolation = alpha;
+}
+
+static constexpr u32 SIM_KEY_TOTAL{ 256 };
+static std::bitset<SIM_KEY_TOTAL> s_simKeysDown;
+static std::bitset<SIM_KEY_TOTAL> s_simKeysPressed;
+
+void LatchSimInput()
+{
+	for (u32 key = 0; key < SIM_KEY_TOTAL; key++)
+	{
+		s_simKeysDown[key] = Input::IsKeyDown(key);
+		if (Input::IsKeyPressed(key))
+		{
+			s_simKeysPressed[key] = true;
+		}
+	}
+}
+
+void ConsumeSimInput()
+{
+	s_simKeysPressed.reset();
+}
+
+bool IsSimKeyDown(u32 keycode)
+{
+	return keycode < SIM_KEY_TOTAL && s_simKeysDown[keycode];
+}
+
+bool IsSimKeyPressed(u32 keycode)
+{
+	return keycode < SIM_KEY_TOTAL && s_simKeysPressed[keycode];
 }
\ No newline at end of file
@@ -1,8 +1,30 @@
 #pragma once
 #include "Play3d.h"
 
+// Draws from the simulation's generator, which ResetSimClock() reseeds so every game plays out the same for a seed
 float RandValueInRange(const float min, const float max);
+void SetSimSeed(Play3d::u32 seed);
+Play3d::u32 GetSimSeed();
 
 // Assuming 0 is middle of screen, returns distance to horiz/vertical edge (when using ortho projection)
 float GetGameHalfWidth();
 float GetGameHalfHeight();
+
+
+// Fixed-step simulation clock. Gameplay code must use these rather than System::GetDeltaTime/GetElapsedTime,
+// so the simulation runs identically whatever the render rate (and can be run faster than real time).
+static constexpr float SIM_TIMESTEP{ 1.f / 60.f };
+float GetSimDeltaTime();
+float GetSimElapsedTime();
+Play3d::u32 GetSimTickCount();
+float GetSimInterpolation(); // 0..1 progress from the previous tick to the current one, used to blend draw transforms
+void ResetSimClock();
+void AdvanceSimClock();
+void SetSimInterpolation(float alpha);
+
+// Keyboard state as seen by the simulation. Presses are latched once per rendered frame and consumed by the first
+// tick which runs, so they are never lost on frames with no ticks or repeated on frames with several.
+void LatchSimInput();
+void ConsumeSimInput();
+bool IsSimKeyDown(Play3d::u32 keycode);
+bool IsSimKeyPressed(Play3d::u32 keycode);
\ No newline at end of file